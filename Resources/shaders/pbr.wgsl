@@ -1,15 +1,17 @@
 struct VertexInput {
-	@location(0) a_position: vec3f,
-	@location(1) a_normal: vec3f,
+	@location(0) a_position: vec4f, // unorm16 in submesh bounds, w is the bitangent sign
+	@location(1) a_normal: vec2f,   // octahedral
 	@location(2) a_uv: vec2f,
-	@location(3) a_tangent: vec3f,
-	@location(4) a_bitangent: vec3f
+	@location(3) a_tangent: vec2f   // octahedral
 };
 
 struct InstanceInput {
 	@location(5) a_MRow0: vec4<f32>,
 	@location(6) a_MRow1: vec4<f32>,
 	@location(7) a_MRow2: vec4<f32>,
+	@location(8) a_PositionOffset: vec4<f32>,
+	@location(9) a_PositionScale: vec3<f32>,
+	@location(10) a_MaterialIndex: u32,
 }
 
 struct VertexOutput {
@@ -26,6 +28,7 @@ struct VertexOutput {
   @location(11) ShadowCoord2: vec3f,
   @location(12) ShadowCoord3: vec3f,
 	@location(13) Barycentric: vec3f,
+	@location(14) @interpolate(flat) MaterialIndex: u32,
 };
 
 struct SceneData {
@@ -40,17 +43,19 @@ struct ShadowData {
 	CascadeDistances: vec4<f32>
 };
 
+// One 64 byte slot of MaterialConstants, indexed by the instance material index
 struct MaterialUniform {
     Metallic: f32,
     Roughness: f32,
     Ao: f32,
-		UseNormalMap: i32
+		UseNormalMap: i32,
+		_Padding: array<vec4<f32>, 3>
 };
 
 @group(0) @binding(0) var<uniform> u_Scene: SceneData;
 
 
-@group(1) @binding(0) var<uniform> uMaterial: MaterialUniform;
+@group(1) @binding(0) var<storage, read> uMaterials: array<MaterialUniform>;
 @group(1) @binding(1) var u_TextureSampler: sampler;
 @group(1) @binding(2) var u_AlbedoTex: texture_2d<f32>;
 @group(1) @binding(3) var u_MetallicTex: texture_2d<f32>;
@@ -67,6 +72,13 @@ struct MaterialUniform {
 @group(3) @binding(4) var u_irradianceMapSampler: sampler;
 @group(3) @binding(5) var u_BRDFSampler: sampler;
 
+// Packed vertex decode, see PackedVertex
+fn OctDecode(e: vec2f) -> vec3f {
+	let n = vec3f(e, 1.0 - abs(e.x) - abs(e.y));
+	let t = max(-n.z, 0.0);
+	return normalize(vec3f(n.xy + select(vec2f(t), vec2f(-t), n.xy >= vec2f(0.0)), n.z));
+}
+
 @vertex
 fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
     var out: VertexOutput;
@@ -78,15 +90,21 @@ fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
         vec4<f32>(instance.a_MRow0.w, instance.a_MRow1.w, instance.a_MRow2.w, 1.0)
     );
 
-    let worldPos = transform * vec4f(in.a_position, 1.0);
+    let position = instance.a_PositionOffset.xyz + in.a_position.xyz * instance.a_PositionScale.xyz;
+    let normal = OctDecode(in.a_normal);
+    let tangent = OctDecode(in.a_tangent);
+    let bitangent = cross(normal, tangent) * (in.a_position.w * 2.0 - 1.0);
 
-    out.Normal = normalize((transform * vec4<f32>(in.a_normal, 0.0)).xyz);
-    out.WorldNormal = normalize((transform * vec4<f32>(in.a_normal, 0.0)).xyz);
-    out.WorldTangent = normalize((transform * vec4<f32>(in.a_tangent, 0.0)).xyz);
-    out.WorldBitangent = normalize((transform * vec4<f32>(in.a_bitangent, 0.0)).xyz);
+    let worldPos = transform * vec4f(position, 1.0);
+
+    out.Normal = normalize((transform * vec4<f32>(normal, 0.0)).xyz);
+    out.WorldNormal = out.Normal;
+    out.WorldTangent = normalize((transform * vec4<f32>(tangent, 0.0)).xyz);
+    out.WorldBitangent = normalize((transform * vec4<f32>(bitangent, 0.0)).xyz);
 
     out.WorldPosition = worldPos.xyz;
     out.Uv = in.a_uv;
+    out.MaterialIndex = instance.a_MaterialIndex;
 
     out.pos = u_Scene.viewProjection * worldPos;
 
@@ -280,6 +298,8 @@ struct FragmentOutput {
 @fragment
 fn fs_main(in: VertexOutput) -> FragmentOutput  {
 
+	let uMaterial = uMaterials[in.MaterialIndex];
+
 	// Sample PBR Resources
 	let Albedo = textureSample(u_AlbedoTex, u_TextureSampler, in.Uv).rgb * uMaterial.Ao;
 	let Metalness = textureSample(u_MetallicTex, u_TextureSampler, in.Uv).b * uMaterial.Metallic;
@@ -294,7 +314,9 @@ fn fs_main(in: VertexOutput) -> FragmentOutput  {
 
 	if(uMaterial.UseNormalMap == 1)
 	{
-		let sampled_normal = normalize(textureSample(u_NormalTex, u_TextureSampler, in.Uv).rgb * 2.0 - 1.0);
+		// Z is rebuilt from XY so two-channel (BC5) normal maps work too
+		let normal_xy = textureSample(u_NormalTex, u_TextureSampler, in.Uv).rg * 2.0 - 1.0;
+		let sampled_normal = vec3f(normal_xy, sqrt(max(0.0, 1.0 - dot(normal_xy, normal_xy))));
 		Normal = normalize(
 				sampled_normal.x * in.WorldTangent +
 				sampled_normal.y * in.WorldBitangent +
@@ -1,13 +1,13 @@
 struct VertexInput {
-	@location(0) position: vec3f,
-	@location(1) normal: vec3f,
-	@location(2) uv: vec2f,
+	@location(0) position: vec4f, // unorm16 in submesh bounds
 };
 
 struct InstanceInput {
 	@location(5) a_MRow0: vec4<f32>,
 	@location(6) a_MRow1: vec4<f32>,
 	@location(7) a_MRow2: vec4<f32>,
+	@location(8) a_PositionOffset: vec4<f32>,
+	@location(9) a_PositionScale: vec3<f32>,
 }
 
 struct VertexOutput {
@@ -32,7 +32,8 @@ fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
 			vec4<f32>(instance.a_MRow0.w, instance.a_MRow1.w, instance.a_MRow2.w, 1.0)
 	);
 
-	out.position = u_ShadowData.ShadowViewProjection[co] * transform * vec4f(in.position, 1.0);
+	let position = instance.a_PositionOffset.xyz + in.position.xyz * instance.a_PositionScale.xyz;
+	out.position = u_ShadowData.ShadowViewProjection[co] * transform * vec4f(position, 1.0);
 	return out;
 }
 
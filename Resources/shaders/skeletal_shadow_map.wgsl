@@ -1,9 +1,5 @@
 struct VertexInput {
-    @location(0) position: vec3f,
-    @location(1) normal: vec3f,
-    @location(2) uv: vec2f,
-    @location(3) tangent: vec3f,
-    @location(4) bitangent: vec3f,
+    @location(0) position: vec4f, // unorm16 in submesh bounds
     @location(5) boneIndices: vec4<u32>,
     @location(6) boneWeights: vec4f,
 };
@@ -12,6 +8,9 @@ struct InstanceInput {
     @location(7) a_MRow0: vec4<f32>,
     @location(8) a_MRow1: vec4<f32>,
     @location(9) a_MRow2: vec4<f32>,
+    @location(10) a_BoneOffset: u32,
+    @location(11) a_PositionOffset: vec4<f32>,
+    @location(12) a_PositionScale: vec4<f32>,
 }
 
 struct VertexOutput {
@@ -24,7 +23,7 @@ struct ShadowData {
 };
 
 @group(0) @binding(0) var<uniform> u_ShadowData: ShadowData;
-@group(0) @binding(1) var<storage, read> u_BoneMatrices: array<mat4x4<f32>, 128>;
+@group(0) @binding(1) var<storage, read> u_BoneMatrices: array<mat4x4<f32>>;
 
 override co: u32 = 0;
 
@@ -39,14 +38,16 @@ fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
         vec4<f32>(instance.a_MRow0.w, instance.a_MRow1.w, instance.a_MRow2.w, 1.0)
     );
 
-    // Compute skin matrix from bone transforms
-    let skinMatrix = u_BoneMatrices[in.boneIndices.x] * in.boneWeights.x
-                   + u_BoneMatrices[in.boneIndices.y] * in.boneWeights.y
-                   + u_BoneMatrices[in.boneIndices.z] * in.boneWeights.z
-                   + u_BoneMatrices[in.boneIndices.w] * in.boneWeights.w;
+    // Compute skin matrix from this instance's slice of the frame bone palette
+    let bones = in.boneIndices + vec4<u32>(instance.a_BoneOffset);
+    let skinMatrix = u_BoneMatrices[bones.x] * in.boneWeights.x
+                   + u_BoneMatrices[bones.y] * in.boneWeights.y
+                   + u_BoneMatrices[bones.z] * in.boneWeights.z
+                   + u_BoneMatrices[bones.w] * in.boneWeights.w;
 
     // Apply skinning then model transform
-    let skinnedPos = skinMatrix * vec4f(in.position, 1.0);
+    let position = instance.a_PositionOffset.xyz + in.position.xyz * instance.a_PositionScale.xyz;
+    let skinnedPos = skinMatrix * vec4f(position, 1.0);
     let worldPos = modelMatrix * skinnedPos;
 
     out.position = u_ShadowData.ShadowViewProjection[co] * worldPos;
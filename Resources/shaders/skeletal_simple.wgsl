@@ -1,9 +1,8 @@
 struct VertexInput {
-    @location(0) position: vec3f,
-    @location(1) normal: vec3f,
+    @location(0) position: vec4f, // unorm16 in submesh bounds, w is the bitangent sign
+    @location(1) normal: vec2f,   // octahedral
     @location(2) uv: vec2f,
-    @location(3) tangent: vec3f,
-    @location(4) bitangent: vec3f,
+    @location(3) tangent: vec2f,  // octahedral
     @location(5) boneIndices: vec4<u32>,
     @location(6) boneWeights: vec4f,
 };
@@ -12,6 +11,10 @@ struct InstanceInput {
     @location(7) a_MRow0: vec4<f32>,
     @location(8) a_MRow1: vec4<f32>,
     @location(9) a_MRow2: vec4<f32>,
+    @location(10) a_BoneOffset: u32,
+    @location(11) a_PositionOffset: vec4<f32>,
+    @location(12) a_PositionScale: vec4<f32>,
+    @location(13) a_MaterialIndex: u32,
 }
 
 struct VertexOutput {
@@ -27,6 +30,7 @@ struct VertexOutput {
     @location(8) ShadowCoord1: vec3f,
     @location(9) ShadowCoord2: vec3f,
     @location(10) ShadowCoord3: vec3f,
+    @location(11) @interpolate(flat) MaterialIndex: u32,
 };
 
 struct SceneData {
@@ -41,17 +45,19 @@ struct ShadowData {
     CascadeDistances: vec4<f32>
 };
 
+// One 64 byte slot of MaterialConstants, indexed by the instance material index
 struct MaterialUniform {
     Metallic: f32,
     Roughness: f32,
     Ao: f32,
-    UseNormalMap: i32
+    UseNormalMap: i32,
+    _Padding: array<vec4<f32>, 3>
 };
 
 @group(0) @binding(0) var<uniform> u_Scene: SceneData;
-@group(0) @binding(1) var<storage, read> u_BoneMatrices: array<mat4x4<f32>, 128>;
+@group(0) @binding(1) var<storage, read> u_BoneMatrices: array<mat4x4<f32>>;
 
-@group(1) @binding(0) var<uniform> uMaterial: MaterialUniform;
+@group(1) @binding(0) var<storage, read> uMaterials: array<MaterialUniform>;
 @group(1) @binding(1) var u_TextureSampler: sampler;
 @group(1) @binding(2) var u_AlbedoTex: texture_2d<f32>;
 @group(1) @binding(3) var u_MetallicTex: texture_2d<f32>;
@@ -67,6 +73,13 @@ struct MaterialUniform {
 @group(3) @binding(3) var u_irradianceMap: texture_cube<f32>;
 @group(3) @binding(4) var u_irradianceMapSampler: sampler;
 
+// Packed vertex decode, see PackedVertex
+fn OctDecode(e: vec2f) -> vec3f {
+    let n = vec3f(e, 1.0 - abs(e.x) - abs(e.y));
+    let t = max(-n.z, 0.0);
+    return normalize(vec3f(n.xy + select(vec2f(t), vec2f(-t), n.xy >= vec2f(0.0)), n.z));
+}
+
 @vertex
 fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
     var out: VertexOutput;
@@ -79,27 +92,34 @@ fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
         vec4<f32>(instance.a_MRow0.w, instance.a_MRow1.w, instance.a_MRow2.w, 1.0)
     );
 
-    // Compute skin matrix from bone transforms
-    let skinMatrix = u_BoneMatrices[in.boneIndices.x] * in.boneWeights.x
-                   + u_BoneMatrices[in.boneIndices.y] * in.boneWeights.y
-                   + u_BoneMatrices[in.boneIndices.z] * in.boneWeights.z
-                   + u_BoneMatrices[in.boneIndices.w] * in.boneWeights.w;
+    // Compute skin matrix from this instance's slice of the frame bone palette
+    let bones = in.boneIndices + vec4<u32>(instance.a_BoneOffset);
+    let skinMatrix = u_BoneMatrices[bones.x] * in.boneWeights.x
+                   + u_BoneMatrices[bones.y] * in.boneWeights.y
+                   + u_BoneMatrices[bones.z] * in.boneWeights.z
+                   + u_BoneMatrices[bones.w] * in.boneWeights.w;
 
     // Combined transform: model * skin
     let combinedMatrix = modelMatrix * skinMatrix;
 
+    let position = instance.a_PositionOffset.xyz + in.position.xyz * instance.a_PositionScale.xyz;
+    let normal = OctDecode(in.normal);
+    let tangent = OctDecode(in.tangent);
+    let bitangent = cross(normal, tangent) * (in.position.w * 2.0 - 1.0);
+
     // Apply skinning then model transform
-    let skinnedPos = skinMatrix * vec4f(in.position, 1.0);
+    let skinnedPos = skinMatrix * vec4f(position, 1.0);
     let worldPos = modelMatrix * skinnedPos;
 
     // Transform normals, tangents, bitangents
-    out.Normal = normalize((combinedMatrix * vec4f(in.normal, 0.0)).xyz);
-    out.WorldNormal = normalize((combinedMatrix * vec4f(in.normal, 0.0)).xyz);
-    out.WorldTangent = normalize((combinedMatrix * vec4f(in.tangent, 0.0)).xyz);
-    out.WorldBitangent = normalize((combinedMatrix * vec4f(in.bitangent, 0.0)).xyz);
+    out.Normal = normalize((combinedMatrix * vec4f(normal, 0.0)).xyz);
+    out.WorldNormal = out.Normal;
+    out.WorldTangent = normalize((combinedMatrix * vec4f(tangent, 0.0)).xyz);
+    out.WorldBitangent = normalize((combinedMatrix * vec4f(bitangent, 0.0)).xyz);
 
     out.WorldPosition = worldPos.xyz;
     out.Uv = in.uv;
+    out.MaterialIndex = instance.a_MaterialIndex;
 
     out.pos = u_Scene.viewProjection * worldPos;
 
@@ -289,6 +309,8 @@ fn acesFilm(x: vec3<f32>) -> vec3<f32> {
 
 @fragment
 fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+    let uMaterial = uMaterials[in.MaterialIndex];
+
     // Sample PBR Resources
     let Albedo = textureSample(u_AlbedoTex, u_TextureSampler, in.Uv).rgb * uMaterial.Ao;
     let Metalness = textureSample(u_MetallicTex, u_TextureSampler, in.Uv).b * uMaterial.Metallic;
@@ -301,7 +323,9 @@ fn fs_main(in: VertexOutput) -> @location(0) vec4f {
     var Normal = normalize(in.WorldNormal);
 
     if (uMaterial.UseNormalMap == 1) {
-        let sampled_normal = normalize(textureSample(u_NormalTex, u_TextureSampler, in.Uv).rgb * 2.0 - 1.0);
+        // Z is rebuilt from XY so two-channel (BC5) normal maps work too
+        let normal_xy = textureSample(u_NormalTex, u_TextureSampler, in.Uv).rg * 2.0 - 1.0;
+        let sampled_normal = vec3f(normal_xy, sqrt(max(0.0, 1.0 - dot(normal_xy, normal_xy))));
         Normal = normalize(
             sampled_normal.x * in.WorldTangent +
             sampled_normal.y * in.WorldBitangent +
@@ -12,6 +12,8 @@
 #include <glm/glm.hpp>
 #include "Application.h"
 
+#include "core/DerivedDataCache.h"
+#include "core/JobSystem.h"
 #include "core/Log.h"
 #include "core/SysInfo.h"
 #include "core/Thread.h"
@@ -19,8 +21,12 @@
 #include "io/keyboard.h"
 #include "EditorLayer.h"
 #include "engine/ImGuiLayer.h"
+#include "render/GeometryArena.h"
+#include "render/MaterialConstants.h"
 #include "render/Render.h"
 #include "render/ResourceManager.h"
+#include "render/TextureStreamer.h"
+#include "render/UploadRing.h"
 
 #include "imgui.h"
 
@@ -46,6 +52,10 @@ namespace Rain
     RN_LOG("Total Cores: {}", SysInfo::CoreCount());
     RN_LOG("Total Memory (RAM): {}", SysInfo::TotalMemory());
 
+    JobSystem::Init();
+    DerivedDataCache::Init();
+    TextureStreamer::Init();
+
     m_Render = std::make_unique<RenderWGPU>();
 
     const auto InitializeScene = [this]()
@@ -116,6 +126,13 @@ namespace Rain
     {
       layer->OnDeattach();
     }
+
+    TextureStreamer::Shutdown();
+    GeometryArena::Shutdown();
+    MaterialConstants::Shutdown();
+    UploadRing::Shutdown();
+    JobSystem::Shutdown();
+    DerivedDataCache::LogStats();
 #endif
   }
 
@@ -125,7 +142,13 @@ namespace Rain
     FrameMark;
 #endif
 
+    UploadRing::BeginFrame();
     glfwPollEvents();
+    JobSystem::ProcessMainThreadJobs();
+    ResourceManager::ProcessUploads();
+    TextureStreamer::Update();
+    // Loads and mip upgrades of this frame go up in one submit
+    UploadRing::Flush();
 
     float currentTime = static_cast<float>(glfwGetTime());
     m_DeltaTime = currentTime - m_LastFrameTime;
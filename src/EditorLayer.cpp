@@ -2,10 +2,15 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
-#include <unordered_set>
 #include "imgui.h"
 #include "ImGuizmo.h"
 #include "Application.h"
+#include "core/DerivedDataCache.h"
+#include "render/GeometryArena.h"
+#include "render/MaterialConstants.h"
+#include "render/ResourceManager.h"
+#include "render/TextureStreamer.h"
+#include "render/UploadRing.h"
 #include <glm/gtc/type_ptr.hpp>
 
 namespace Rain
@@ -211,33 +216,86 @@ namespace Rain
     RenderEntityList();
     RenderPropertyPanel();
     RenderLogViewer();
+    RenderRendererStats();
+  }
+
+  void EditorLayer::RenderRendererStats()
+  {
+    if (!ImGui::Begin("Renderer Stats"))
+    {
+      ImGui::End();
+      return;
+    }
+
+    const auto& stats = m_ViewportRenderer->GetStats();
+    ImGui::Text("Submitted instances: %u", stats.SubmittedInstances);
+    ImGui::Text("Culled instances: %u", stats.CulledInstances);
+    for (int i = 0; i < 4; i++)
+    {
+      ImGui::Text("Cascade %d casters: %u", i, stats.ShadowCasters[i]);
+    }
+    ImGui::Text("Skinned instances: %u (%u batches)", stats.SkinnedInstances, stats.SkinnedBatches);
+    ImGui::Text("Triangles: %llu", (unsigned long long)stats.Triangles);
+    ImGui::Text("State calls: %u issued, %u skipped", stats.StateCallsIssued, stats.StateCallsSkipped);
+    for (uint32_t i = 0; i < SubMesh::MaxLodCount; i++)
+    {
+      ImGui::Text("LOD %u instances: %u", i, stats.LodInstances[i]);
+    }
+
+    ImGui::Separator();
+    ImGui::Text("GPU buffers: %d (peak %d)", GPUAllocator::allocatedBufferCount, GPUAllocator::peakBufferCount);
+    ImGui::Text("GPU buffer memory: %.2f MB (peak %.2f MB)", GPUAllocator::allocatedBufferTotalSize / (1024.0f * 1024.0f), GPUAllocator::peakBufferTotalSize / (1024.0f * 1024.0f));
+
+    ImGui::Text("Pending asset loads: %u", ResourceManager::GetPendingLoadCount());
+
+    ImGui::Separator();
+    const DerivedDataCacheStats cacheStats = DerivedDataCache::GetStats();
+    ImGui::Text("DDC hits: %llu, misses: %llu, evictions: %llu", (unsigned long long)cacheStats.Hits, (unsigned long long)cacheStats.Misses, (unsigned long long)cacheStats.Evictions);
+    ImGui::Text("DDC saved: %.2f MB, on disk: %.2f MB", cacheStats.BytesRead / (1024.0f * 1024.0f), cacheStats.TotalSize / (1024.0f * 1024.0f));
+
+    ImGui::Separator();
+    const TextureStreamingStats& streamingStats = TextureStreamer::GetStats();
+    ImGui::Text("Streamed textures: %u, pending upgrades: %u", streamingStats.StreamedTextures, streamingStats.PendingUpgrades);
+    ImGui::Text("Texture memory: %.2f / %.2f MB resident, %.2f MB requested", streamingStats.ResidentBytes / (1024.0f * 1024.0f), streamingStats.BudgetBytes / (1024.0f * 1024.0f), streamingStats.RequestedBytes / (1024.0f * 1024.0f));
+    ImGui::Text("Mip upgrades: %u, evictions: %u", streamingStats.Upgrades, streamingStats.Evictions);
+
+    ImGui::Separator();
+    const GeometryArenaStats arenaStats = GeometryArena::GetStats();
+    ImGui::Text("Geometry arena: %.2f / %.2f MB in %u pages", arenaStats.UsedBytes / (1024.0f * 1024.0f), arenaStats.CapacityBytes / (1024.0f * 1024.0f), arenaStats.Pages);
+    ImGui::Text("Geometry allocations: %u, free ranges: %u", arenaStats.Allocations, arenaStats.FreeRanges);
+
+    ImGui::Separator();
+    const MaterialConstantsStats& constantsStats = MaterialConstants::GetStats();
+    ImGui::Text("Material constants: %u / %u slots", constantsStats.Materials, constantsStats.Capacity);
+    ImGui::Text("Constants flushed: %u ranges, %llu bytes", constantsStats.FlushedRanges, (unsigned long long)constantsStats.FlushedBytes);
+
+    ImGui::Separator();
+    const UploadRingStats& uploadStats = UploadRing::GetStats();
+    ImGui::Text("Uploaded: %.2f MB in %u copies, %u submits", uploadStats.BytesUploaded / (1024.0f * 1024.0f), uploadStats.Copies, uploadStats.Submits);
+    ImGui::Text("Staging: %u buffers, %.2f MB", uploadStats.StagingBuffers, uploadStats.StagingBytes / (1024.0f * 1024.0f));
+
+    ImGui::End();
   }
 
   void EditorLayer::RenderEntityList()
   {
     ImGui::Begin("Entity List");
 
-    auto entities = m_Scene->GetAllEntitiesWithComponent<TransformComponent>();
+    m_Scene->EachRootEntity([this](Entity entity)
+                            { RenderEntityNode(entity); });
 
-    std::unordered_set<UUID> childEntities;
-    for (auto& entity : entities)
+    if (m_EntityToDestroy != 0)
     {
-      for (UUID childId : entity.Children())
+      // Children go with their parent, so the selection may have been anywhere in the subtree
+      if (Entity entity = m_Scene->TryGetEntityWithUUID(m_EntityToDestroy))
       {
-        childEntities.insert(childId);
+        m_Scene->DestroyEntity(entity);
       }
-    }
-
-    for (auto& entity : entities)
-    {
-      UUID parentId = entity.GetParentUUID();
-      if (parentId == 0 || childEntities.find(entity.GetUUID()) == childEntities.end())
+      if (!m_Scene->TryGetEntityWithUUID(m_SelectedEntityId))
       {
-        if (parentId == 0)
-        {
-          RenderEntityNode(entity);
-        }
+        m_SelectedEntityId = 0;
       }
+      m_EntityToDestroy = 0;
     }
 
     if (ImGui::IsMouseClicked(0) && ImGui::IsWindowHovered() && !ImGui::IsAnyItemHovered())
@@ -251,8 +309,7 @@ namespace Rain
   void EditorLayer::RenderEntityNode(Entity entity)
   {
     std::string name = entity.Name();
-    auto& children = entity.Children();
-    bool hasChildren = !children.empty();
+    bool hasChildren = entity.HasChildren();
 
     ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
 
@@ -273,16 +330,19 @@ namespace Rain
       m_SelectedEntityId = entity.GetUUID();
     }
 
-    if (hasChildren && opened)
+    if (ImGui::BeginPopupContextItem())
     {
-      for (UUID childId : children)
+      if (ImGui::MenuItem("Delete Entity"))
       {
-        Entity childEntity = m_Scene->TryGetEntityWithUUID(childId);
-        if (childEntity)
-        {
-          RenderEntityNode(childEntity);
-        }
+        m_EntityToDestroy = entity.GetUUID();
       }
+      ImGui::EndPopup();
+    }
+
+    if (hasChildren && opened)
+    {
+      entity.EachChild([this](Entity child)
+                       { RenderEntityNode(child); });
       ImGui::TreePop();
     }
   }
@@ -386,26 +446,21 @@ namespace Rain
       }
     }
 
-    // RelationshipComponent
-    if (selectedEntity.HasComponent<RelationshipComponent>())
+    // Hierarchy
+    if (ImGui::CollapsingHeader("Relationship"))
     {
-      if (ImGui::CollapsingHeader("Relationship"))
+      if (ImGui::BeginTable("##RelationshipTable", 2, tableFlags))
       {
-        if (ImGui::BeginTable("##RelationshipTable", 2, tableFlags))
-        {
-          ImGui::TableSetupColumn("Label", ImGuiTableColumnFlags_WidthFixed, 100.0f);
-          ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Label", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+        ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
 
-          auto& relationship = selectedEntity.GetComponent<RelationshipComponent>();
+        PropertyLabel("Parent UUID");
+        ImGui::Text("%llu", (unsigned long long)selectedEntity.GetParentUUID());
 
-          PropertyLabel("Parent UUID");
-          ImGui::Text("%llu", (unsigned long long)relationship.ParentHandle);
+        PropertyLabel("Children");
+        ImGui::Text("%u", selectedEntity.GetChildCount());
 
-          PropertyLabel("Children");
-          ImGui::Text("%zu", relationship.Children.size());
-
-          ImGui::EndTable();
-        }
+        ImGui::EndTable();
       }
     }
 
@@ -763,12 +818,9 @@ namespace Rain
     }
 
     glm::mat4 localTransform = worldTransform;
-    if (UUID parentId = selectedEntity.GetParentUUID(); parentId != 0)
+    if (Entity parent = selectedEntity.GetParent())
     {
-      if (Entity parent = m_Scene->TryGetEntityWithUUID(parentId))
-      {
-        localTransform = glm::inverse(m_Scene->GetWorldSpaceTransformMatrix(parent)) * worldTransform;
-      }
+      localTransform = glm::inverse(m_Scene->GetWorldSpaceTransformMatrix(parent)) * worldTransform;
     }
 
     selectedEntity.Transform().SetTransform(localTransform);
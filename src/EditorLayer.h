@@ -48,12 +48,14 @@ namespace Rain
     void RenderEntityNode(Entity entity);
     void RenderPropertyPanel();
     void RenderGizmo();
+    void RenderRendererStats();
 
     Ref<Scene> m_Scene;
     Ref<SceneRenderer> m_ViewportRenderer;
 
     // Entity list state
     UUID m_SelectedEntityId = 0;
+    UUID m_EntityToDestroy = 0;  // Destroyed after the list is drawn, not while flecs iterates it
 
     char m_SearchBuffer[256] = {0};
     std::vector<LogEntry> m_FilteredLogs;
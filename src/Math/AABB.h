@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace Rain
+{
+  struct AABB
+  {
+    glm::vec3 Min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 Max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    AABB() = default;
+    AABB(const glm::vec3& min, const glm::vec3& max)
+        : Min(min), Max(max) {}
+
+    void Expand(const glm::vec3& point)
+    {
+      Min = glm::min(Min, point);
+      Max = glm::max(Max, point);
+    }
+
+    bool IsValid() const { return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z; }
+
+    glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+    glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+  };
+}  // namespace Rain
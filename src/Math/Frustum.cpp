@@ -0,0 +1,155 @@
+#include "Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RN_FRUSTUM_SIMD 1
+#else
+#define RN_FRUSTUM_SIMD 0
+#endif
+
+namespace Rain
+{
+  Frustum Frustum::FromViewProjection(const glm::mat4& m)
+  {
+    // Gribb-Hartmann extraction. glm is column major so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+    const glm::vec4 row0 = {m[0][0], m[1][0], m[2][0], m[3][0]};
+    const glm::vec4 row1 = {m[0][1], m[1][1], m[2][1], m[3][1]};
+    const glm::vec4 row2 = {m[0][2], m[1][2], m[2][2], m[3][2]};
+    const glm::vec4 row3 = {m[0][3], m[1][3], m[2][3], m[3][3]};
+
+    Frustum frustum;
+    frustum.Planes[0] = row3 + row0;
+    frustum.Planes[1] = row3 - row0;
+    frustum.Planes[2] = row3 + row1;
+    frustum.Planes[3] = row3 - row1;
+    frustum.Planes[4] = row3 + row2;
+    frustum.Planes[5] = row3 - row2;
+
+    for (auto& plane : frustum.Planes)
+    {
+      plane /= glm::length(glm::vec3(plane));
+    }
+
+    return frustum;
+  }
+
+  void BoundingBoxStream::Push(const glm::vec3& center, const glm::vec3& extents)
+  {
+    CenterX.push_back(center.x);
+    CenterY.push_back(center.y);
+    CenterZ.push_back(center.z);
+    ExtentX.push_back(extents.x);
+    ExtentY.push_back(extents.y);
+    ExtentZ.push_back(extents.z);
+  }
+
+  void BoundingBoxStream::Clear()
+  {
+    // clear() keeps the capacity, after the first few frames this never allocates
+    CenterX.clear();
+    CenterY.clear();
+    CenterZ.clear();
+    ExtentX.clear();
+    ExtentY.clear();
+    ExtentZ.clear();
+  }
+
+  namespace Math
+  {
+    void TransformBounds(const glm::mat4& transform, const glm::vec3& center, const glm::vec3& extents, glm::vec3& outCenter, glm::vec3& outExtents)
+    {
+      outCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+
+      // Arvo: the extents of the transformed box are the extents projected on the absolute basis vectors
+      const glm::mat3 absBasis = glm::mat3(glm::abs(glm::vec3(transform[0])),
+                                           glm::abs(glm::vec3(transform[1])),
+                                           glm::abs(glm::vec3(transform[2])));
+      outExtents = absBasis * extents;
+    }
+
+    static bool IsBoxVisible(const Frustum& frustum, const glm::vec3& center, const glm::vec3& extents)
+    {
+      for (const auto& plane : frustum.Planes)
+      {
+        const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        const float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+
+        if (distance + radius < 0.0f)
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    uint32_t CullBoundingBoxes(const Frustum& frustum, const BoundingBoxStream& boxes, uint8_t* outVisible)
+    {
+      const uint32_t count = boxes.Size();
+      uint32_t visibleCount = 0;
+      uint32_t i = 0;
+
+#if RN_FRUSTUM_SIMD
+      __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+      __m128 absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+
+      for (int p = 0; p < 6; p++)
+      {
+        const glm::vec4& plane = frustum.Planes[p];
+        planeX[p] = _mm_set1_ps(plane.x);
+        planeY[p] = _mm_set1_ps(plane.y);
+        planeZ[p] = _mm_set1_ps(plane.z);
+        planeW[p] = _mm_set1_ps(plane.w);
+        absPlaneX[p] = _mm_set1_ps(glm::abs(plane.x));
+        absPlaneY[p] = _mm_set1_ps(glm::abs(plane.y));
+        absPlaneZ[p] = _mm_set1_ps(glm::abs(plane.z));
+      }
+
+      const __m128 zero = _mm_setzero_ps();
+
+      for (; i + 4 <= count; i += 4)
+      {
+        const __m128 cx = _mm_loadu_ps(boxes.CenterX.data() + i);
+        const __m128 cy = _mm_loadu_ps(boxes.CenterY.data() + i);
+        const __m128 cz = _mm_loadu_ps(boxes.CenterZ.data() + i);
+        const __m128 ex = _mm_loadu_ps(boxes.ExtentX.data() + i);
+        const __m128 ey = _mm_loadu_ps(boxes.ExtentY.data() + i);
+        const __m128 ez = _mm_loadu_ps(boxes.ExtentZ.data() + i);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        for (int p = 0; p < 6; p++)
+        {
+          __m128 distance = _mm_add_ps(_mm_mul_ps(cx, planeX[p]), _mm_mul_ps(cy, planeY[p]));
+          distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(cz, planeZ[p]), planeW[p]));
+
+          __m128 radius = _mm_add_ps(_mm_mul_ps(ex, absPlaneX[p]), _mm_mul_ps(ey, absPlaneY[p]));
+          radius = _mm_add_ps(radius, _mm_mul_ps(ez, absPlaneZ[p]));
+
+          inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+          const uint8_t visible = (mask >> lane) & 1;
+          outVisible[i + lane] = visible;
+          visibleCount += visible;
+        }
+      }
+#endif
+
+      for (; i < count; i++)
+      {
+        const glm::vec3 center = {boxes.CenterX[i], boxes.CenterY[i], boxes.CenterZ[i]};
+        const glm::vec3 extents = {boxes.ExtentX[i], boxes.ExtentY[i], boxes.ExtentZ[i]};
+
+        const uint8_t visible = IsBoxVisible(frustum, center, extents) ? 1 : 0;
+        outVisible[i] = visible;
+        visibleCount += visible;
+      }
+
+      return visibleCount;
+    }
+  }  // namespace Math
+}  // namespace Rain
@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Rain
+{
+  struct Frustum
+  {
+    // Left, right, bottom, top, near, far. xyz is the inward facing normal, w the distance.
+    glm::vec4 Planes[6];
+
+    static Frustum FromViewProjection(const glm::mat4& viewProjection);
+  };
+
+  // World space boxes kept as center/extent streams so the plane test can load four boxes per register.
+  struct BoundingBoxStream
+  {
+    std::vector<float> CenterX, CenterY, CenterZ;
+    std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+    void Push(const glm::vec3& center, const glm::vec3& extents);
+    void Clear();
+    uint32_t Size() const { return (uint32_t)CenterX.size(); }
+  };
+
+  namespace Math
+  {
+    // Transforms a local space box (center/extents) by an affine matrix and returns the enclosing world space box.
+    void TransformBounds(const glm::mat4& transform, const glm::vec3& center, const glm::vec3& extents, glm::vec3& outCenter, glm::vec3& outExtents);
+
+    // Writes 1 to outVisible[i] for every box intersecting the frustum, 0 otherwise. Returns the visible count.
+    uint32_t CullBoundingBoxes(const Frustum& frustum, const BoundingBoxStream& boxes, uint8_t* outVisible);
+  }  // namespace Math
+}  // namespace Rain
@@ -55,8 +55,14 @@ namespace Rain
     m_SamplingContext.Invalidate();
   }
 
-  void OzzAnimator::Update(float deltaTime)
+  void OzzAnimator::Update(float deltaTime, uint64_t frameIndex)
   {
+    if (frameIndex == m_LastUpdateFrame)
+    {
+      return;
+    }
+    m_LastUpdateFrame = frameIndex;
+
     if (!m_Initialized || !m_Playing || !m_Animation)
     {
       return;
@@ -26,7 +26,8 @@ namespace Rain
     void SetAnimation(Ref<OzzAnimation> animation);
     Ref<OzzAnimation> GetAnimation() const { return m_Animation; }
 
-    void Update(float deltaTime);
+    // Advances and samples at most once per frame, however many entities share this animator
+    void Update(float deltaTime, uint64_t frameIndex);
 
     const std::vector<glm::mat4>& GetBoneMatrices() const { return m_BoneMatrices; }
 
@@ -59,6 +60,7 @@ namespace Rain
     std::vector<ozz::math::Float4x4> m_ModelMatrices;
     std::vector<glm::mat4> m_BoneMatrices;
 
+    uint64_t m_LastUpdateFrame = 0;
     float m_CurrentTime = 0.0f;
     float m_PlaybackSpeed = 1.0f;
     bool m_Loop = true;
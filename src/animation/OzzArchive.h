@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <ozz/base/io/archive.h>
+#include <ozz/base/io/stream.h>
+#include <ozz/base/memory/unique_ptr.h>
+
+namespace Rain
+{
+  // Serializes ozz runtime objects to and from byte buffers for cooked and cached data
+  class OzzArchive
+  {
+   public:
+    template <typename T>
+    static std::vector<uint8_t> Save(const T& object)
+    {
+      ozz::io::MemoryStream stream;
+      {
+        ozz::io::OArchive archive(&stream);
+        archive << object;
+      }
+
+      std::vector<uint8_t> bytes(stream.Size());
+      stream.Seek(0, ozz::io::Stream::kSet);
+      stream.Read(bytes.data(), bytes.size());
+      return bytes;
+    }
+
+    // Returns nullptr when the buffer does not hold a T archive
+    template <typename T>
+    static ozz::unique_ptr<T> Load(const uint8_t* data, size_t size)
+    {
+      ozz::io::MemoryStream stream;
+      stream.Write(data, size);
+      stream.Seek(0, ozz::io::Stream::kSet);
+
+      ozz::io::IArchive archive(&stream);
+      if (!archive.TestTag<T>())
+      {
+        return nullptr;
+      }
+
+      auto object = ozz::make_unique<T>();
+      archive >> *object;
+      return object;
+    }
+  };
+}  // namespace Rain
@@ -32,6 +32,7 @@
 
 #include "OzzConverter.h"
 
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 #include <queue>
 #include <unordered_set>
@@ -45,12 +46,124 @@
 #include <ozz/base/maths/transform.h>
 #include <ozz/base/maths/vec_float.h>
 
+#include "OzzArchive.h"
+#include "core/DerivedDataCache.h"
 #include "core/Log.h"
 
 namespace Rain
 {
   namespace
   {
+    // Bump when the conversion output changes for the same input
+    constexpr uint32_t kOzzCacheVersion = 1;
+
+    void HashNodeTree(ContentHasher& hasher, const aiNode* node)
+    {
+      hasher.Update(node->mName.C_Str());
+      hasher.UpdateValue(node->mTransformation);
+      hasher.UpdateValue(node->mNumChildren);
+      for (unsigned int i = 0; i < node->mNumChildren; ++i)
+      {
+        HashNodeTree(hasher, node->mChildren[i]);
+      }
+    }
+
+    std::string GetSkeletonCacheKey(const aiScene* scene, const Skeleton& rainSkeleton)
+    {
+      ContentHasher hasher;
+      HashNodeTree(hasher, scene->mRootNode);
+      for (const Bone& bone : rainSkeleton.Bones)
+      {
+        hasher.Update(bone.Name);
+        hasher.UpdateValue(bone.ParentIndex);
+        hasher.UpdateValue(bone.InverseBindMatrix);
+      }
+      return DerivedDataCache::MakeKey("ozzskeleton", kOzzCacheVersion, hasher.Finish());
+    }
+
+    std::string GetAnimationCacheKey(const aiAnimation* animation, const OzzSkeleton& ozzSkeleton)
+    {
+      ContentHasher hasher;
+      hasher.Update(animation->mName.C_Str());
+      hasher.UpdateValue(animation->mDuration);
+      hasher.UpdateValue(animation->mTicksPerSecond);
+      for (unsigned int i = 0; i < animation->mNumChannels; ++i)
+      {
+        const aiNodeAnim* channel = animation->mChannels[i];
+        hasher.Update(channel->mNodeName.C_Str());
+        hasher.Update(channel->mPositionKeys, channel->mNumPositionKeys * sizeof(aiVectorKey));
+        hasher.Update(channel->mRotationKeys, channel->mNumRotationKeys * sizeof(aiQuatKey));
+        hasher.Update(channel->mScalingKeys, channel->mNumScalingKeys * sizeof(aiVectorKey));
+      }
+
+      // Tracks are laid out in the skeleton's joint order
+      for (int i = 0; i < ozzSkeleton.GetNumJoints(); ++i)
+      {
+        const char* jointName = ozzSkeleton.GetJointName(i);
+        hasher.Update(jointName ? jointName : "");
+      }
+      return DerivedDataCache::MakeKey("ozzanimation", kOzzCacheVersion, hasher.Finish());
+    }
+
+    // Skeleton payload: u32 archive size, archive, u32 matrix count, inverse bind matrices
+    Ref<OzzSkeleton> LoadCachedSkeleton(const std::vector<uint8_t>& payload)
+    {
+      uint32_t archiveSize = 0;
+      if (payload.size() < sizeof(uint32_t))
+      {
+        return nullptr;
+      }
+      std::memcpy(&archiveSize, payload.data(), sizeof(uint32_t));
+
+      size_t offset = sizeof(uint32_t) + archiveSize;
+      uint32_t matrixCount = 0;
+      if (offset + sizeof(uint32_t) > payload.size())
+      {
+        return nullptr;
+      }
+      std::memcpy(&matrixCount, payload.data() + offset, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+      if (offset + matrixCount * sizeof(glm::mat4) > payload.size())
+      {
+        return nullptr;
+      }
+
+      auto skeleton = OzzArchive::Load<ozz::animation::Skeleton>(payload.data() + sizeof(uint32_t), archiveSize);
+      if (!skeleton)
+      {
+        return nullptr;
+      }
+
+      std::vector<glm::mat4> inverseBindMatrices(matrixCount);
+      std::memcpy(inverseBindMatrices.data(), payload.data() + offset, matrixCount * sizeof(glm::mat4));
+
+      auto result = CreateRef<OzzSkeleton>();
+      result->SetSkeleton(std::move(skeleton));
+      result->SetInverseBindMatrices(std::move(inverseBindMatrices));
+      return result;
+    }
+
+    void StoreCachedSkeleton(const std::string& key, const OzzSkeleton& skeleton)
+    {
+      const std::vector<uint8_t> archive = OzzArchive::Save(*skeleton.GetOzzSkeleton());
+      const std::vector<glm::mat4>& inverseBindMatrices = skeleton.GetInverseBindMatrices();
+
+      const uint32_t archiveSize = (uint32_t)archive.size();
+      const uint32_t matrixCount = (uint32_t)inverseBindMatrices.size();
+
+      std::vector<uint8_t> payload(2 * sizeof(uint32_t) + archive.size() + matrixCount * sizeof(glm::mat4));
+      uint8_t* cursor = payload.data();
+      std::memcpy(cursor, &archiveSize, sizeof(uint32_t));
+      cursor += sizeof(uint32_t);
+      std::memcpy(cursor, archive.data(), archive.size());
+      cursor += archive.size();
+      std::memcpy(cursor, &matrixCount, sizeof(uint32_t));
+      cursor += sizeof(uint32_t);
+      std::memcpy(cursor, inverseBindMatrices.data(), matrixCount * sizeof(glm::mat4));
+
+      DerivedDataCache::Put(key, payload.data(), payload.size());
+    }
+
     /**
      * @brief Converts Assimp's row-major 4x4 matrix to GLM's column-major format.
      *
@@ -293,6 +406,17 @@ namespace Rain
       return nullptr;
     }
 
+    // The builders are the slow part, a cached archive skips them entirely
+    const std::string cacheKey = DerivedDataCache::IsEnabled() ? GetSkeletonCacheKey(scene, rainSkeleton) : std::string();
+    std::vector<uint8_t> cached;
+    if (!cacheKey.empty() && DerivedDataCache::Get(cacheKey, cached))
+    {
+      if (Ref<OzzSkeleton> result = LoadCachedSkeleton(cached))
+      {
+        return result;
+      }
+    }
+
     ozz::animation::offline::RawSkeleton rawSkeleton;
 
     // Step 1: Find the root bone (the one with no parent)
@@ -376,6 +500,11 @@ namespace Rain
 
     result->SetInverseBindMatrices(std::move(inverseBindMatrices));
 
+    if (!cacheKey.empty())
+    {
+      StoreCachedSkeleton(cacheKey, *result);
+    }
+
     RN_LOG("OzzConverter: Created OzzSkeleton with {} joints", numOzzJoints);
 
     return result;
@@ -389,6 +518,18 @@ namespace Rain
       return nullptr;
     }
 
+    const std::string cacheKey = DerivedDataCache::IsEnabled() ? GetAnimationCacheKey(animation, ozzSkeleton) : std::string();
+    std::vector<uint8_t> cached;
+    if (!cacheKey.empty() && DerivedDataCache::Get(cacheKey, cached))
+    {
+      if (auto cachedAnimation = OzzArchive::Load<ozz::animation::Animation>(cached.data(), cached.size()))
+      {
+        auto result = CreateRef<OzzAnimation>();
+        result->SetAnimation(std::move(cachedAnimation));
+        return result;
+      }
+    }
+
     const auto* skeleton = ozzSkeleton.GetOzzSkeleton();
     int numJoints = skeleton->num_joints();
 
@@ -485,6 +626,12 @@ namespace Rain
       return nullptr;
     }
 
+    if (!cacheKey.empty())
+    {
+      const std::vector<uint8_t> archive = OzzArchive::Save(*ozzAnimationPtr);
+      DerivedDataCache::Put(cacheKey, archive.data(), archive.size());
+    }
+
     auto result = CreateRef<OzzAnimation>();
     result->SetAnimation(std::move(ozzAnimationPtr));
 
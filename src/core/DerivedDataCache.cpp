@@ -0,0 +1,385 @@
+#include "DerivedDataCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "core/Log.h"
+#include "io/MappedFile.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint64_t kPrime1 = 0x9E3779B97F4A7C15ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kDefaultMaxSize = 4ull * 1024 * 1024 * 1024;
+
+    // Entry header, 16 bytes so payloads keep the 16-byte alignment cooked streams rely on
+    struct EntryHeader
+    {
+      static constexpr uint32_t EntryMagic = 0x43444452;  // "RDDC"
+
+      uint32_t Magic = EntryMagic;
+      uint32_t Reserved = 0;
+      uint64_t PayloadSize = 0;
+    };
+    static_assert(sizeof(EntryHeader) == 16);
+
+    struct CacheState
+    {
+      std::filesystem::path Directory;
+      uint64_t MaxSize = kDefaultMaxSize;
+      bool Enabled = false;
+
+      std::atomic<uint64_t> Hits{0};
+      std::atomic<uint64_t> Misses{0};
+      std::atomic<uint64_t> Writes{0};
+      std::atomic<uint64_t> Evictions{0};
+      std::atomic<uint64_t> BytesRead{0};
+      std::atomic<uint64_t> BytesWritten{0};
+      std::atomic<uint64_t> TotalSize{0};
+      std::atomic<uint32_t> TempCounter{0};
+
+      std::mutex EvictMutex;
+      std::mutex CommitMutex;  // Pairs the rename of an entry with the size of the file it replaces
+    };
+
+    CacheState s_Cache;
+
+    uint64_t Rotl(uint64_t value, int bits)
+    {
+      return (value << bits) | (value >> (64 - bits));
+    }
+
+    uint64_t MixLane(uint64_t state, uint64_t lane)
+    {
+      state ^= Rotl(lane * kPrime2, 31) * kPrime1;
+      return Rotl(state, 27) * kPrime1 + 0x27D4EB2F165667C5ull;
+    }
+
+    std::filesystem::path GetEntryPath(const std::string& key)
+    {
+      return s_Cache.Directory / (key + ".ddc");
+    }
+
+    // Refreshes the timestamp eviction orders by, so hot entries survive
+    void TouchEntry(const std::filesystem::path& path)
+    {
+      std::error_code error;
+      std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    uint64_t ScanDirectorySize()
+    {
+      uint64_t total = 0;
+      std::error_code error;
+      for (const auto& entry : std::filesystem::directory_iterator(s_Cache.Directory, error))
+      {
+        if (entry.is_regular_file(error) && entry.path().extension() == ".ddc")
+        {
+          total += entry.file_size(error);
+        }
+      }
+      return total;
+    }
+  }  // namespace
+
+  ContentHasher::ContentHasher(uint64_t seed)
+      : m_State(seed ^ kPrime1)
+  {
+  }
+
+  void ContentHasher::Update(const void* data, size_t size)
+  {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t state = MixLane(m_State, size);
+
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8)
+    {
+      uint64_t lane;
+      std::memcpy(&lane, bytes + offset, 8);
+      state = MixLane(state, lane);
+    }
+
+    if (offset < size)
+    {
+      uint64_t lane = 0;
+      std::memcpy(&lane, bytes + offset, size - offset);
+      state = MixLane(state, lane);
+    }
+
+    m_State = state;
+  }
+
+  void ContentHasher::Update(const std::string& value)
+  {
+    Update(value.data(), value.size());
+  }
+
+  bool ContentHasher::UpdateFile(const std::string& path)
+  {
+    MappedFile file;
+    if (!file.Open(path))
+    {
+      return false;
+    }
+
+    Update(file.GetData(), file.GetSize());
+    return true;
+  }
+
+  uint64_t ContentHasher::Finish() const
+  {
+    uint64_t hash = m_State;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  void DerivedDataCache::Init(const std::string& directory, uint64_t maxSizeBytes)
+  {
+    std::string cacheDirectory = directory;
+    if (cacheDirectory.empty())
+    {
+      const char* envDirectory = std::getenv("RAIN_DDC_DIR");
+      cacheDirectory = envDirectory ? envDirectory : "DerivedDataCache";
+    }
+
+    if (maxSizeBytes == 0)
+    {
+      const char* envMaxSize = std::getenv("RAIN_DDC_MAX_MB");
+      maxSizeBytes = envMaxSize ? std::strtoull(envMaxSize, nullptr, 10) * 1024 * 1024 : kDefaultMaxSize;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    if (error)
+    {
+      RN_LOG_ERR("DerivedDataCache: cannot create {} ({}), caching disabled", cacheDirectory, error.message());
+      s_Cache.Enabled = false;
+      return;
+    }
+
+    s_Cache.Directory = cacheDirectory;
+    s_Cache.MaxSize = maxSizeBytes;
+    s_Cache.TotalSize = ScanDirectorySize();
+    s_Cache.Enabled = true;
+
+    RN_LOG("DerivedDataCache: {} ({} MB used, {} MB budget)", cacheDirectory, s_Cache.TotalSize.load() / (1024 * 1024), maxSizeBytes / (1024 * 1024));
+  }
+
+  bool DerivedDataCache::IsEnabled()
+  {
+    return s_Cache.Enabled;
+  }
+
+  std::string DerivedDataCache::MakeKey(const char* type, uint32_t formatVersion, uint64_t contentHash)
+  {
+    char key[96];
+    std::snprintf(key, sizeof(key), "%s-v%u-%016llx", type, formatVersion, (unsigned long long)contentHash);
+    return key;
+  }
+
+  bool DerivedDataCache::Get(const std::string& key, std::vector<uint8_t>& outData)
+  {
+    if (!s_Cache.Enabled)
+    {
+      return false;
+    }
+
+    const std::filesystem::path path = GetEntryPath(key);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    EntryHeader header;
+
+    const bool valid = file.is_open() && (uint64_t)file.tellg() >= sizeof(EntryHeader) &&
+                       file.seekg(0) && file.read((char*)&header, sizeof(header)) &&
+                       header.Magic == EntryHeader::EntryMagic;
+    if (!valid)
+    {
+      s_Cache.Misses++;
+      return false;
+    }
+
+    outData.resize(header.PayloadSize);
+    if (!file.read((char*)outData.data(), header.PayloadSize))
+    {
+      outData.clear();
+      s_Cache.Misses++;
+      return false;
+    }
+
+    TouchEntry(path);
+    s_Cache.Hits++;
+    s_Cache.BytesRead += header.PayloadSize;
+    return true;
+  }
+
+  bool DerivedDataCache::GetMapped(const std::string& key, MappedFile& outFile, const uint8_t*& outData, size_t& outSize)
+  {
+    if (!s_Cache.Enabled)
+    {
+      return false;
+    }
+
+    const std::filesystem::path path = GetEntryPath(key);
+    if (!outFile.Open(path.string()) || outFile.GetSize() < sizeof(EntryHeader))
+    {
+      outFile.Close();
+      s_Cache.Misses++;
+      return false;
+    }
+
+    EntryHeader header;
+    std::memcpy(&header, outFile.GetData(), sizeof(header));
+    if (header.Magic != EntryHeader::EntryMagic || header.PayloadSize != outFile.GetSize() - sizeof(EntryHeader))
+    {
+      outFile.Close();
+      s_Cache.Misses++;
+      return false;
+    }
+
+    outData = outFile.GetData() + sizeof(EntryHeader);
+    outSize = header.PayloadSize;
+
+    TouchEntry(path);
+    s_Cache.Hits++;
+    s_Cache.BytesRead += header.PayloadSize;
+    return true;
+  }
+
+  void DerivedDataCache::Put(const std::string& key, const void* data, size_t size)
+  {
+    if (!s_Cache.Enabled)
+    {
+      return;
+    }
+
+    const std::filesystem::path path = GetEntryPath(key);
+
+    // Unique per process, thread and call, another writer of the same key never shares the file
+    const uint64_t writerId = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                              (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    std::filesystem::path tempPath = path;
+    tempPath += "." + std::to_string(writerId) + "." + std::to_string(s_Cache.TempCounter++) + ".tmp";
+
+    {
+      EntryHeader header;
+      header.PayloadSize = size;
+
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file.is_open() || !file.write((const char*)&header, sizeof(header)) || !file.write((const char*)data, size))
+      {
+        RN_LOG_ERR("DerivedDataCache: failed to write {}", tempPath.string());
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+        return;
+      }
+    }
+
+    // Racing writers produce identical bytes for the same key, whichever rename lands last wins.
+    // A replaced entry only adds the difference to the total, otherwise rewrites count twice.
+    const uint64_t entrySize = size + sizeof(EntryHeader);
+    uint64_t totalSize;
+    {
+      std::lock_guard<std::mutex> lock(s_Cache.CommitMutex);
+      std::error_code error;
+      const uint64_t replacedSize = std::filesystem::file_size(path, error);
+      const uint64_t previousSize = error ? 0 : replacedSize;
+
+      std::filesystem::rename(tempPath, path, error);
+      if (error)
+      {
+        std::filesystem::remove(tempPath, error);
+        return;
+      }
+
+      totalSize = s_Cache.TotalSize.fetch_add(entrySize - previousSize) + entrySize - previousSize;
+    }
+
+    s_Cache.Writes++;
+    s_Cache.BytesWritten += size;
+    if (totalSize > s_Cache.MaxSize)
+    {
+      Evict();
+    }
+  }
+
+  void DerivedDataCache::Evict()
+  {
+    std::lock_guard<std::mutex> lock(s_Cache.EvictMutex);
+
+    struct Entry
+    {
+      std::filesystem::path Path;
+      std::filesystem::file_time_type LastUse;
+      uint64_t Size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(s_Cache.Directory, error))
+    {
+      if (entry.is_regular_file(error) && entry.path().extension() == ".ddc")
+      {
+        entries.push_back({entry.path(), entry.last_write_time(error), entry.file_size(error)});
+        totalSize += entries.back().Size;
+      }
+    }
+
+    // Trim below the budget so eviction does not run again on the very next write
+    const uint64_t targetSize = s_Cache.MaxSize / 10 * 9;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+              { return a.LastUse < b.LastUse; });
+
+    for (const Entry& entry : entries)
+    {
+      if (totalSize <= targetSize)
+      {
+        break;
+      }
+
+      // Readers that already mapped the entry keep their view on POSIX
+      if (std::filesystem::remove(entry.Path, error))
+      {
+        totalSize -= entry.Size;
+        s_Cache.Evictions++;
+      }
+    }
+
+    s_Cache.TotalSize = totalSize;
+  }
+
+  DerivedDataCacheStats DerivedDataCache::GetStats()
+  {
+    DerivedDataCacheStats stats;
+    stats.Hits = s_Cache.Hits;
+    stats.Misses = s_Cache.Misses;
+    stats.Writes = s_Cache.Writes;
+    stats.Evictions = s_Cache.Evictions;
+    stats.BytesRead = s_Cache.BytesRead;
+    stats.BytesWritten = s_Cache.BytesWritten;
+    stats.TotalSize = s_Cache.TotalSize;
+    return stats;
+  }
+
+  void DerivedDataCache::LogStats()
+  {
+    const DerivedDataCacheStats stats = GetStats();
+    RN_LOG("DerivedDataCache: {} hits, {} misses, {} writes, {} evictions, {:.2f} MB served, {:.2f} MB written, {:.2f} MB on disk",
+           stats.Hits, stats.Misses, stats.Writes, stats.Evictions,
+           stats.BytesRead / (1024.0 * 1024.0), stats.BytesWritten / (1024.0 * 1024.0), stats.TotalSize / (1024.0 * 1024.0));
+  }
+}  // namespace Rain
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Rain
+{
+  class MappedFile;
+
+  struct DerivedDataCacheStats
+  {
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Writes = 0;
+    uint64_t Evictions = 0;
+    uint64_t BytesRead = 0;  // Served from the cache instead of being re-imported
+    uint64_t BytesWritten = 0;
+    uint64_t TotalSize = 0;  // Current size on disk
+  };
+
+  // Incremental 64-bit content hash for cache keys. Fast, not cryptographic.
+  class ContentHasher
+  {
+   public:
+    explicit ContentHasher(uint64_t seed = 0);
+
+    void Update(const void* data, size_t size);
+    void Update(const std::string& value);
+    bool UpdateFile(const std::string& path);
+
+    template <typename T>
+    void UpdateValue(const T& value)
+    {
+      Update(&value, sizeof(T));
+    }
+
+    uint64_t Finish() const;
+
+   private:
+    uint64_t m_State;
+  };
+
+  // On-disk cache of import results, keyed by a hash of the source bytes, the importer settings
+  // and the output format version. Entries are immutable and published with an atomic rename, so
+  // threads and build agents sharing one directory never observe a partially written entry.
+  // Least recently used entries are evicted once the directory exceeds its size budget.
+  class DerivedDataCache
+  {
+   public:
+    // Empty directory / zero size fall back to RAIN_DDC_DIR / RAIN_DDC_MAX_MB, then to defaults
+    static void Init(const std::string& directory = "", uint64_t maxSizeBytes = 0);
+    static bool IsEnabled();
+
+    static std::string MakeKey(const char* type, uint32_t formatVersion, uint64_t contentHash);
+
+    static bool Get(const std::string& key, std::vector<uint8_t>& outData);
+    // Payload stays valid while outFile is open
+    static bool GetMapped(const std::string& key, MappedFile& outFile, const uint8_t*& outData, size_t& outSize);
+    static void Put(const std::string& key, const void* data, size_t size);
+
+    static DerivedDataCacheStats GetStats();
+    static void LogStats();
+
+   private:
+    static void Evict();
+  };
+}  // namespace Rain
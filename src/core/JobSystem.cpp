@@ -0,0 +1,286 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/SysInfo.h"
+
+namespace Rain
+{
+  namespace
+  {
+    struct Job
+    {
+      JobFunction Function;
+      JobCounter* Counter = nullptr;
+    };
+
+    // Owner pushes and pops at the back, thieves take from the front
+    struct WorkerQueue
+    {
+      std::mutex Mutex;
+      std::deque<Job> Jobs;
+
+      void Push(Job&& job)
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Jobs.push_back(std::move(job));
+      }
+
+      bool Pop(Job& outJob)
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Jobs.empty())
+        {
+          return false;
+        }
+
+        outJob = std::move(Jobs.back());
+        Jobs.pop_back();
+        return true;
+      }
+
+      bool Steal(Job& outJob)
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Jobs.empty())
+        {
+          return false;
+        }
+
+        outJob = std::move(Jobs.front());
+        Jobs.pop_front();
+        return true;
+      }
+    };
+
+    struct JobSystemState
+    {
+      // Queue 0 belongs to the main thread, 1..N to the workers
+      std::vector<std::unique_ptr<WorkerQueue>> Queues;
+      std::vector<std::thread> Workers;
+
+      std::mutex SleepMutex;
+      std::condition_variable WakeCondition;
+      std::atomic<uint32_t> QueuedJobs{0};
+      std::atomic<bool> Running{false};
+
+      std::mutex MainThreadMutex;
+      std::vector<Job> MainThreadJobs;
+      std::vector<Job> MainThreadJobsSwap;
+    };
+
+    JobSystemState s_State;
+    thread_local uint32_t s_QueueIndex = 0;
+    thread_local bool s_IsEngineThread = false;
+    thread_local uint32_t s_StealSeed = 0;
+    thread_local bool s_InMainThreadJobs = false;
+
+    void FinishJob(Job& job)
+    {
+      job.Function();
+      if (job.Counter)
+      {
+        job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    }
+
+    bool TryRunOneJob()
+    {
+      const uint32_t queueCount = (uint32_t)s_State.Queues.size();
+      Job job;
+
+      bool found = s_State.Queues[s_QueueIndex]->Pop(job);
+      for (uint32_t attempt = 1; !found && attempt < queueCount; attempt++)
+      {
+        const uint32_t victim = (s_QueueIndex + attempt + s_StealSeed++) % queueCount;
+        if (victim != s_QueueIndex)
+        {
+          found = s_State.Queues[victim]->Steal(job);
+        }
+      }
+
+      if (!found)
+      {
+        return false;
+      }
+
+      s_State.QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+      FinishJob(job);
+      return true;
+    }
+
+    void WorkerLoop(uint32_t queueIndex)
+    {
+      s_QueueIndex = queueIndex;
+      s_IsEngineThread = true;
+      s_StealSeed = queueIndex;
+
+      while (s_State.Running.load(std::memory_order_acquire))
+      {
+        if (TryRunOneJob())
+        {
+          continue;
+        }
+
+        std::unique_lock<std::mutex> lock(s_State.SleepMutex);
+        s_State.WakeCondition.wait(lock, []
+                                   { return s_State.QueuedJobs.load(std::memory_order_acquire) > 0 || !s_State.Running.load(std::memory_order_acquire); });
+      }
+    }
+  }  // namespace
+
+  void JobSystem::Init(uint32_t workerCount)
+  {
+    RN_ASSERT(!s_State.Running, "JobSystem already initialized");
+
+#if __EMSCRIPTEN__
+    // No worker threads on the web build, everything runs inline on the main thread
+    workerCount = 0;
+#else
+    if (workerCount == 0)
+    {
+      workerCount = (uint32_t)std::max(1, SysInfo::CoreCount() - 1);
+    }
+#endif
+
+    s_QueueIndex = 0;
+    s_IsEngineThread = true;
+
+    s_State.Queues.clear();
+    for (uint32_t i = 0; i < workerCount + 1; i++)
+    {
+      s_State.Queues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+
+    s_State.Running = true;
+    for (uint32_t i = 1; i <= workerCount; i++)
+    {
+      s_State.Workers.emplace_back(WorkerLoop, i);
+    }
+
+    RN_LOG("JobSystem initialized with {} workers", workerCount);
+  }
+
+  void JobSystem::Shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(s_State.SleepMutex);
+      s_State.Running = false;
+    }
+    s_State.WakeCondition.notify_all();
+
+    for (auto& worker : s_State.Workers)
+    {
+      worker.join();
+    }
+
+    s_State.Workers.clear();
+    s_State.Queues.clear();
+  }
+
+  void JobSystem::Run(JobFunction job, JobCounter* counter)
+  {
+    RN_ASSERT(!s_State.Queues.empty(), "JobSystem used before Init");
+
+    if (counter)
+    {
+      counter->Pending.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Threads outside the pool hand their work to the main thread queue, which workers steal from
+    const uint32_t queueIndex = s_IsEngineThread ? s_QueueIndex : 0;
+    s_State.Queues[queueIndex]->Push({std::move(job), counter});
+
+    {
+      std::lock_guard<std::mutex> lock(s_State.SleepMutex);
+      s_State.QueuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    s_State.WakeCondition.notify_one();
+  }
+
+  void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const ParallelForFunction& func, JobCounter& counter)
+  {
+    batchSize = std::max(batchSize, 1u);
+    for (uint32_t begin = 0; begin < count; begin += batchSize)
+    {
+      const uint32_t end = std::min(begin + batchSize, count);
+      Run([&func, begin, end]()
+          { func(begin, end); }, &counter);
+    }
+  }
+
+  void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const ParallelForFunction& func)
+  {
+    JobCounter counter;
+    ParallelFor(count, batchSize, func, counter);
+    Wait(counter);
+  }
+
+  void JobSystem::Wait(JobCounter& counter)
+  {
+    while (!counter.IsDone())
+    {
+      if (IsMainThread())
+      {
+        ProcessMainThreadJobs();
+      }
+
+      if (!TryRunOneJob())
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void JobSystem::RunOnMainThread(JobFunction job, JobCounter* counter)
+  {
+    if (counter)
+    {
+      counter->Pending.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    std::lock_guard<std::mutex> lock(s_State.MainThreadMutex);
+    s_State.MainThreadJobs.push_back({std::move(job), counter});
+  }
+
+  void JobSystem::ProcessMainThreadJobs()
+  {
+    RN_ASSERT(IsMainThread(), "Main thread jobs processed off the main thread");
+
+    // A main thread job waiting on a counter must not re-enter the list being executed
+    if (s_InMainThreadJobs)
+    {
+      return;
+    }
+    s_InMainThreadJobs = true;
+
+    {
+      std::lock_guard<std::mutex> lock(s_State.MainThreadMutex);
+      std::swap(s_State.MainThreadJobs, s_State.MainThreadJobsSwap);
+    }
+
+    // Jobs queued while running these are picked up next time
+    for (auto& job : s_State.MainThreadJobsSwap)
+    {
+      FinishJob(job);
+    }
+    s_State.MainThreadJobsSwap.clear();
+    s_InMainThreadJobs = false;
+  }
+
+  uint32_t JobSystem::GetWorkerCount()
+  {
+    return (uint32_t)s_State.Workers.size();
+  }
+
+  bool JobSystem::IsMainThread()
+  {
+    return s_IsEngineThread && s_QueueIndex == 0;
+  }
+}  // namespace Rain
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace Rain
+{
+  // Fence for a group of jobs. Every job scheduled with a counter increments it and
+  // decrements it when it finishes, so Wait returns once the whole group is done.
+  struct JobCounter
+  {
+    std::atomic<uint32_t> Pending{0};
+
+    bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+  };
+
+  using JobFunction = std::function<void()>;
+  using ParallelForFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+  // Work-stealing scheduler. Each worker (and the main thread) owns a deque, pops its own
+  // newest job and steals the oldest job of another worker when it runs dry.
+  class JobSystem
+  {
+   public:
+    // workerCount 0 picks one worker per core minus the main thread
+    static void Init(uint32_t workerCount = 0);
+    static void Shutdown();
+
+    static void Run(JobFunction job, JobCounter* counter = nullptr);
+
+    // Splits [0, count) into batches of batchSize and runs them across the workers.
+    // The blocking overload waits, and the calling thread helps with the work. With the
+    // counter overload func is referenced, not copied, and must outlive the counter.
+    static void ParallelFor(uint32_t count, uint32_t batchSize, const ParallelForFunction& func, JobCounter& counter);
+    static void ParallelFor(uint32_t count, uint32_t batchSize, const ParallelForFunction& func);
+
+    // Executes other jobs while waiting, so it is safe to call from inside a job
+    static void Wait(JobCounter& counter);
+
+    // Jobs that must run on the main thread (GPU uploads, window calls). Drained once per
+    // frame by the application and while the main thread waits on a counter.
+    static void RunOnMainThread(JobFunction job, JobCounter* counter = nullptr);
+    static void ProcessMainThreadJobs();
+
+    static uint32_t GetWorkerCount();
+    static bool IsMainThread();
+  };
+}  // namespace Rain
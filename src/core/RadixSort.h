@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace Rain
+{
+  // Stable LSD radix sort on the 64-bit T::SortKey member, one byte per pass.
+  // Passes where every key shares the same byte are skipped. Scratch keeps its
+  // capacity between calls, so a steady item count never allocates.
+  template <typename T>
+  void RadixSort(std::vector<T>& items, std::vector<T>& scratch)
+  {
+    const size_t count = items.size();
+    if (count < 2)
+    {
+      return;
+    }
+
+    scratch.resize(count);
+
+    uint32_t histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+
+    for (const T& item : items)
+    {
+      const uint64_t key = item.SortKey;
+      for (int pass = 0; pass < 8; pass++)
+      {
+        histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+      }
+    }
+
+    T* src = items.data();
+    T* dst = scratch.data();
+
+    for (int pass = 0; pass < 8; pass++)
+    {
+      uint32_t* histogram = histograms[pass];
+      const uint8_t firstByte = (src[0].SortKey >> (pass * 8)) & 0xFF;
+      if (histogram[firstByte] == count)
+      {
+        continue;
+      }
+
+      uint32_t offset = 0;
+      for (int bucket = 0; bucket < 256; bucket++)
+      {
+        const uint32_t bucketCount = histogram[bucket];
+        histogram[bucket] = offset;
+        offset += bucketCount;
+      }
+
+      for (size_t i = 0; i < count; i++)
+      {
+        const uint8_t byte = (src[i].SortKey >> (pass * 8)) & 0xFF;
+        dst[histogram[byte]++] = src[i];
+      }
+
+      std::swap(src, dst);
+    }
+
+    if (src != items.data())
+    {
+      items.swap(scratch);
+    }
+  }
+}  // namespace Rain
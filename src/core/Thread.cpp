@@ -10,6 +10,6 @@ void Thread::Sleep(unsigned int ms)
 #if __EMSCRIPTEN__
   emscripten_sleep(ms);
 #else
-  usleep(ms);
+  usleep(ms * 1000);
 #endif
 }
@@ -7,6 +7,7 @@
 #include "io/filesystem.h"
 #include "render/RenderContext.h"
 #include "render/RenderUtils.h"
+#include "render/UploadRing.h"
 
 namespace Rain
 {
@@ -180,6 +181,7 @@ namespace Rain
     cmdBufferDesc.label = RenderUtils::MakeLabel("ImGui Command Buffer");
     WGPUCommandBuffer cmdBuffer = wgpuCommandEncoderFinish(encoder, &cmdBufferDesc);
 
+    UploadRing::Flush();
     wgpuQueueSubmit(queue, 1, &cmdBuffer);
 
     wgpuCommandBufferRelease(cmdBuffer);
@@ -0,0 +1,81 @@
+#include "MappedFile.h"
+#include <fstream>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define RN_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Rain {
+  MappedFile::~MappedFile() {
+    Close();
+  }
+
+  bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#if RN_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+      close(fd);
+      return false;
+    }
+
+    void* mapping = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+      return false;
+    }
+
+    m_Data = (const uint8_t*)mapping;
+    m_Size = (size_t)fileStat.st_size;
+    m_IsMapped = true;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+      return false;
+    }
+
+    const std::streamsize size = file.tellg();
+    if (size <= 0) {
+      return false;
+    }
+
+    m_FallbackData.resize((size_t)size);
+    file.seekg(0);
+    if (!file.read((char*)m_FallbackData.data(), size)) {
+      m_FallbackData.clear();
+      return false;
+    }
+
+    m_Data = m_FallbackData.data();
+    m_Size = m_FallbackData.size();
+    return true;
+#endif
+  }
+
+  void MappedFile::Close() {
+#if RN_HAS_MMAP
+    if (m_IsMapped) {
+      munmap((void*)m_Data, m_Size);
+    }
+#endif
+
+    m_FallbackData.clear();
+    m_FallbackData.shrink_to_fit();
+    m_Data = nullptr;
+    m_Size = 0;
+    m_IsMapped = false;
+  }
+}  // namespace Rain
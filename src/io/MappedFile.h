@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Rain {
+  // Read-only view of a whole file. Memory-mapped where the platform allows it, so large cooked
+  // assets are paged in on demand instead of copied; other platforms read the file into memory.
+  class MappedFile {
+   public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    bool IsOpen() const { return m_Data != nullptr; }
+
+   private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_IsMapped = false;
+    std::vector<uint8_t> m_FallbackData;
+  };
+}  // namespace Rain
@@ -72,6 +72,15 @@ namespace Rain {
     return file.good();
   };
 
+  std::string FileSys::GetCanonicalPath(std::string path) {
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+      canonical = std::filesystem::absolute(path, error).lexically_normal();
+    }
+    return canonical.generic_string();
+  }
+
   void FileSys::WatchFile(const std::string& path, std::function<void(std::string fileName)> callback) {
     std::thread([path, callback]() {
       if (!std::filesystem::exists(path)) {
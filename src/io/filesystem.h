@@ -17,6 +17,8 @@ namespace Rain {
     static void OpenFileSaveDialog(std::string defaultName, std::string defaultPath, std::function<void(std::string filePath)>&& callback);
     static void OpenFileOSDefaults(std::string path);
     static bool IsFileExist(std::string path);
+    // Absolute, normalized and with symlinks resolved, so two spellings of one file compare equal
+    static std::string GetCanonicalPath(std::string path);
     static void WatchFile(const std::string& path, std::function<void(std::string fileName)> callback);
   };
 }  // namespace Rain
@@ -0,0 +1,66 @@
+#include "PhysicsJobSystem.h"
+#include <chrono>
+#include <thread>
+#include "core/JobSystem.h"
+
+namespace Rain
+{
+  PhysicsJobSystem::PhysicsJobSystem(JPH::uint maxJobs, JPH::uint maxBarriers)
+  {
+    JobSystemWithBarrier::Init(maxBarriers);
+    m_Jobs.Init(maxJobs, maxJobs);
+  }
+
+  int PhysicsJobSystem::GetMaxConcurrency() const
+  {
+    return (int)JobSystem::GetWorkerCount() + 1;
+  }
+
+  PhysicsJobSystem::JobHandle PhysicsJobSystem::CreateJob(const char* name, JPH::ColorArg color, const JobFunction& jobFunction, JPH::uint32 numDependencies)
+  {
+    // Same policy as JPH::JobSystemThreadPool: wait for a free slot if the list is exhausted
+    JPH::uint32 index;
+    for (;;)
+    {
+      index = m_Jobs.ConstructObject(name, color, this, jobFunction, numDependencies);
+      if (index != AvailableJobs::cInvalidObjectIndex)
+      {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    Job* job = &m_Jobs.Get(index);
+    JobHandle handle(job);
+
+    if (numDependencies == 0)
+    {
+      QueueJob(job);
+    }
+
+    return handle;
+  }
+
+  void PhysicsJobSystem::QueueJob(Job* job)
+  {
+    // Keep the job alive until it has run on a worker
+    job->AddRef();
+    JobSystem::Run([job]()
+                   {
+      job->Execute();
+      job->Release(); });
+  }
+
+  void PhysicsJobSystem::QueueJobs(Job** jobs, JPH::uint numJobs)
+  {
+    for (JPH::uint i = 0; i < numJobs; i++)
+    {
+      QueueJob(jobs[i]);
+    }
+  }
+
+  void PhysicsJobSystem::FreeJob(Job* job)
+  {
+    m_Jobs.DestructObject(job);
+  }
+}  // namespace Rain
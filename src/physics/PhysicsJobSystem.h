@@ -0,0 +1,26 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+namespace Rain
+{
+  // Runs Jolt jobs on the engine JobSystem so physics and engine work share one pool
+  class PhysicsJobSystem final : public JPH::JobSystemWithBarrier
+  {
+   public:
+    PhysicsJobSystem(JPH::uint maxJobs, JPH::uint maxBarriers);
+
+    virtual int GetMaxConcurrency() const override;
+    virtual JobHandle CreateJob(const char* name, JPH::ColorArg color, const JobFunction& jobFunction, JPH::uint32 numDependencies = 0) override;
+
+   protected:
+    virtual void QueueJob(Job* job) override;
+    virtual void QueueJobs(Job** jobs, JPH::uint numJobs) override;
+    virtual void FreeJob(Job* job) override;
+
+   private:
+    using AvailableJobs = JPH::FixedSizeFreeList<Job>;
+    AvailableJobs m_Jobs;
+  };
+}  // namespace Rain
@@ -32,7 +32,7 @@ namespace Rain
     // JPH::RegisterTypes();
 
     // m_TempAllocator = new JPH::TempAllocatorImpl(64 * 1024 * 1024);
-    // m_JobSystem = new JPH::JobSystemThreadPool(2048, 8, JPH::thread::hardware_concurrency() - 1);
+    // m_JobSystem = new PhysicsJobSystem(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
 
     // m_BroadPhaseLayerInterface = new BPLayerInterfaceImpl();
     // m_ObjectVsBroadPhaseLayerFilter = new ObjectVsBroadPhaseLayerFilterImpl();
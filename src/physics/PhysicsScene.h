@@ -7,6 +7,7 @@
 
 #include "Physics/Vehicle/VehicleConstraint.h"
 #include "physics/PhysicsBody.h"
+#include "physics/PhysicsJobSystem.h"
 #include "physics/PhysicsWheel.h"
 #include "physics/PhysicTypes.h"
 #include "scene/Entity.h"
@@ -53,7 +54,9 @@ namespace Rain
 
    private:
     JPH::TempAllocatorImpl* m_TempAllocator = nullptr;
-    JPH::JobSystemThreadPool* m_JobSystem = nullptr;
+    // Not created yet: Jolt setup in the constructor is disabled, so nothing steps the
+    // PhysicsSystem. Create it next to m_TempAllocator when physics is switched back on.
+    PhysicsJobSystem* m_JobSystem = nullptr;
 
     BPLayerInterfaceImpl* m_BroadPhaseLayerInterface = nullptr;
     ObjectVsBroadPhaseLayerFilterImpl* m_ObjectVsBroadPhaseLayerFilter = nullptr;
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "core/Ref.h"
+
+namespace Rain
+{
+  enum class AssetState : uint8_t
+  {
+    Loading,
+    Ready,
+    Failed
+  };
+
+  // Future-like handle of an asset loading in the background. Get returns the placeholder until
+  // the asset is ready. Then callbacks, Resolve and Fail run on the main thread, the state can be
+  // polled from anywhere.
+  template <typename T>
+  class AsyncAsset
+  {
+   public:
+    using ReadyCallback = std::function<void(Ref<T>)>;
+
+    AsyncAsset(std::string path, Ref<T> placeholder = nullptr)
+        : m_Path(std::move(path)), m_Placeholder(placeholder) {}
+
+    AssetState GetState() const { return m_State.load(std::memory_order_acquire); }
+    bool IsReady() const { return GetState() == AssetState::Ready; }
+    bool IsFailed() const { return GetState() == AssetState::Failed; }
+    const std::string& GetPath() const { return m_Path; }
+
+    Ref<T> Get() const { return IsReady() ? m_Asset : m_Placeholder; }
+
+    // Runs immediately when already loaded, never runs if the load fails
+    void Then(ReadyCallback callback)
+    {
+      if (IsReady())
+      {
+        callback(m_Asset);
+      }
+      else if (!IsFailed())
+      {
+        m_Callbacks.push_back(std::move(callback));
+      }
+    }
+
+    void Resolve(Ref<T> asset)
+    {
+      m_Asset = asset;
+      m_State.store(AssetState::Ready, std::memory_order_release);
+
+      // Callbacks may register new callbacks on other assets, never on this one
+      std::vector<ReadyCallback> callbacks = std::move(m_Callbacks);
+      for (auto& callback : callbacks)
+      {
+        callback(m_Asset);
+      }
+    }
+
+    void Fail()
+    {
+      m_State.store(AssetState::Failed, std::memory_order_release);
+      m_Callbacks.clear();
+    }
+
+   private:
+    std::string m_Path;
+    Ref<T> m_Asset;
+    Ref<T> m_Placeholder;
+    std::atomic<AssetState> m_State{AssetState::Loading};
+    std::vector<ReadyCallback> m_Callbacks;
+  };
+
+  template <typename T>
+  using AssetFuture = Ref<AsyncAsset<T>>;
+}  // namespace Rain
@@ -30,6 +30,47 @@ namespace Rain
     return RenderPassResourceType::PT_Uniform;
   }
 
+  // The object behind an input and its generation, either changing means the entry is stale
+  uint32_t GetResourceGeneration(const RenderPassInput& input, const void*& outResource)
+  {
+    switch (input.Type)
+    {
+      case PT_Uniform:
+      case PT_Storage:
+        outResource = input.UniformIntput.get();
+        return input.UniformIntput ? input.UniformIntput->Generation : 0;
+      case PT_Texture:
+        outResource = input.TextureInput.get();
+        return input.TextureInput ? input.TextureInput->GetGeneration() : 0;
+      case PT_Sampler:
+        outResource = input.SamplerInput.get();
+        return input.SamplerInput ? input.SamplerInput->GetGeneration() : 0;
+      default:
+        outResource = nullptr;
+        return 0;
+    }
+  }
+
+  void WriteEntry(WGPUBindGroupEntry& entry, const RenderPassInput& input)
+  {
+    switch (input.Type)
+    {
+      case PT_Uniform:
+      case PT_Storage:
+        entry.buffer = input.UniformIntput->Buffer;
+        entry.size = input.UniformIntput->Size;
+        break;
+      case PT_Texture:
+        entry.textureView = input.TextureInput->GetReadableView();
+        break;
+      case PT_Sampler:
+        entry.sampler = *input.SamplerInput->GetNativeSampler();
+        break;
+      case PT_DynamicUniform:
+        break;
+    }
+  }
+
   bool IsInputValid(const RenderPassInput& input)
   {
     switch (input.Type)
@@ -58,8 +99,9 @@ namespace Rain
     const auto* decl = GetInputDeclaration(name);
     if (decl != nullptr)
     {
-      m_Inputs[decl->Group][decl->Location].Type = RenderPassResourceType::PT_Texture;
-      m_Inputs[decl->Group][decl->Location].TextureInput = texture;
+      RenderPassInput& input = GetInput(decl->Group, decl->Location);
+      input.Type = RenderPassResourceType::PT_Texture;
+      input.TextureInput = texture;
     }
     else
     {
@@ -74,8 +116,9 @@ namespace Rain
     if (decl != nullptr)
     {
       // Use the declared type (PT_Uniform or PT_Storage) from the shader
-      m_Inputs[decl->Group][decl->Location].Type = decl->Type;
-      m_Inputs[decl->Group][decl->Location].UniformIntput = uniform;
+      RenderPassInput& input = GetInput(decl->Group, decl->Location);
+      input.Type = decl->Type;
+      input.UniformIntput = uniform;
     }
     else
     {
@@ -88,8 +131,9 @@ namespace Rain
     const auto* decl = GetInputDeclaration(name);
     if (decl != nullptr)
     {
-      m_Inputs[decl->Group][decl->Location].Type = RenderPassResourceType::PT_Sampler;
-      m_Inputs[decl->Group][decl->Location].SamplerInput = sampler;
+      RenderPassInput& input = GetInput(decl->Group, decl->Location);
+      input.Type = RenderPassResourceType::PT_Sampler;
+      input.SamplerInput = sampler;
     }
     else
     {
@@ -195,109 +239,108 @@ namespace Rain
     InvalidateAndUpdate();
   }
 
-  void BindingManager::InvalidateAndUpdate()
+  RenderPassInput& BindingManager::GetInput(uint32_t group, uint32_t location)
   {
-    RN_PROFILE_FUNC;
-    for (const auto& [index, inputs] : m_Inputs)
+    auto& groupInputs = m_Inputs[group];
+    auto it = groupInputs.find(location);
+    if (it == groupInputs.end())
+    {
+      m_SlotsStale = true;
+      it = groupInputs.emplace(location, RenderPassInput()).first;
+    }
+    return it->second;
+  }
+
+  void BindingManager::RebuildSlots()
+  {
+    // Inputs that were already tracked keep their state so they are not rewritten
+    std::vector<BindingSlot> previous = std::move(m_Slots);
+    m_Slots.clear();
+
+    for (const auto& [group, inputs] : m_Inputs)
     {
       for (const auto& [location, input] : inputs)
       {
-        const auto& storedEntry = m_GroupEntryMap[index].at(location);
-
-        switch (input.Type)
+        BindingSlot slot = {group, location, &input};
+        for (const BindingSlot& old : previous)
         {
-          case PT_Uniform:
-            if (storedEntry.buffer != input.UniformIntput->Buffer)
-            {
-              m_InvalidatedInputs[index][location] = input;
-            }
-            break;
-          case PT_Texture:
-
-            if (input.TextureInput->GetType() == TextureType::TextureDimCube && storedEntry.textureView != input.TextureInput->GetReadableView())
-            {
-              m_InvalidatedInputs[index][location] = input;
-            }
-
-            if (storedEntry.textureView != input.TextureInput->GetReadableView())
-            {
-              m_InvalidatedInputs[index][location] = input;
-            }
-            break;
-          case PT_Sampler:
-            if (storedEntry.sampler != *input.SamplerInput->GetNativeSampler())
-            {
-              m_InvalidatedInputs[index][location] = input;
-            }
-            break;
-          case PT_Storage:
-            if (storedEntry.buffer != input.UniformIntput->Buffer)
-            {
-              m_InvalidatedInputs[index][location] = input;
-            }
-            break;
-          case PT_DynamicUniform:
+          if (old.Input == &input)
+          {
+            slot = old;
             break;
+          }
         }
+        m_Slots.push_back(slot);
       }
     }
 
-    if (m_InvalidatedInputs.empty())
+    m_SlotsStale = false;
+  }
+
+  void BindingManager::InvalidateAndUpdate()
+  {
+    // Bind groups can only be created once the device exists, stale slots are picked up then
+    if (!RenderContext::IsReady())
     {
       return;
     }
 
-    for (const auto& [index, inputs] : m_InvalidatedInputs)
+    if (m_SlotsStale)
     {
-      for (const auto& [location, input] : inputs)
+      RebuildSlots();
+    }
+
+    uint32_t dirtyGroups = 0;
+    for (BindingSlot& slot : m_Slots)
+    {
+      const void* resource = nullptr;
+      const uint32_t generation = GetResourceGeneration(*slot.Input, resource);
+      if (resource == slot.Resource && generation == slot.Generation)
       {
-        WGPUBindGroupEntry& storedEntry = m_GroupEntryMap[index].at(location);
+        continue;
+      }
 
-        switch (input.Type)
-        {
-          case PT_Uniform:
-            storedEntry.buffer = input.UniformIntput->Buffer;
-            storedEntry.size = input.UniformIntput->Size;
-            break;
-          case PT_Texture:
-            storedEntry.textureView = input.TextureInput->GetReadableView();
-            break;
-          case PT_Sampler:
-            storedEntry.sampler = *input.SamplerInput->GetNativeSampler();
-            break;
-          case PT_Storage:
-            storedEntry.buffer = input.UniformIntput->Buffer;
-            storedEntry.size = input.UniformIntput->Size;
-            break;
-          case PT_DynamicUniform:
-            break;
-        }
+      slot.Resource = resource;
+      slot.Generation = generation;
+
+      WGPUBindGroupEntry& entry = m_GroupEntryMap[slot.Group][slot.Location];
+      entry.binding = slot.Location;
+      WriteEntry(entry, *slot.Input);
+      dirtyGroups |= 1u << slot.Group;
+    }
+
+    if (dirtyGroups == 0)
+    {
+      return;
+    }
+
+    RN_PROFILE_FUNC;
+    std::vector<WGPUBindGroupEntry> entries;
+    for (const auto& [index, groupEntries] : m_GroupEntryMap)
+    {
+      if ((dirtyGroups & (1u << index)) == 0)
+      {
+        continue;
       }
 
-      std::vector<WGPUBindGroupEntry> entries;
-      for (const auto& [_, entry] : m_GroupEntryMap[index])
+      entries.clear();
+      for (const auto& [_, entry] : groupEntries)
       {
         entries.emplace_back(entry);
       }
 
-      std::string label = m_BindingSpec.Name;
-      WGPUBindGroupDescriptor bgDesc = {.nextInChain = nullptr, .label = label.c_str()};
+      WGPUBindGroupDescriptor bgDesc = {.nextInChain = nullptr, .label = m_BindingSpec.Name.c_str()};
       bgDesc.layout = m_BindingSpec.ShaderRef->GetReflectionInfo().LayoutDescriptors[index];
       bgDesc.entryCount = entries.size();
       bgDesc.entries = entries.data();
 
-      if (RenderContext::IsReady())
-      {
-        auto bindGroup = wgpuDeviceCreateBindGroup(RenderContext::GetDevice(), &bgDesc);
+      auto bindGroup = wgpuDeviceCreateBindGroup(RenderContext::GetDevice(), &bgDesc);
 
-        RN_ASSERT(bindGroup != 0, "BindGroup creation failed.");
-        RN_LOG("Created BindingManager {} {}", m_BindingSpec.Name, (void*)bindGroup);
+      RN_ASSERT(bindGroup != 0, "BindGroup creation failed.");
+      RN_LOG("Created BindingManager {} {}", m_BindingSpec.Name, (void*)bindGroup);
 
-        m_BindGroups[index] = bindGroup;
-      }
+      m_BindGroups[index] = bindGroup;
     }
-
-    m_InvalidatedInputs.clear();
   }
 
   const RenderPassInputDeclaration* BindingManager::GetInputDeclaration(const std::string& name) const
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "render/GPUAllocator.h"
 #include "render/Sampler.h"
 #include "render/Shader.h"
@@ -29,6 +30,15 @@ namespace Rain {
     Ref<Sampler> SamplerInput = nullptr;
   };
 
+  // Resource identity and generation last written into the bind group entry of an input
+  struct BindingSlot {
+    uint32_t Group;
+    uint32_t Location;
+    const RenderPassInput* Input;
+    const void* Resource = nullptr;
+    uint32_t Generation = 0;
+  };
+
   struct RenderPassInputDeclaration {
     std::string Name;
     RenderPassResourceType Type;
@@ -50,6 +60,7 @@ namespace Rain {
     void Init();
     bool Validate();
     void Bake();
+    // Called per draw: scans the (resource, generation) pairs and only rebuilds groups whose inputs changed
     void InvalidateAndUpdate();
 
     const RenderPassInputDeclaration* GetInputDeclaration(const std::string& name) const;
@@ -64,7 +75,13 @@ namespace Rain {
     std::map<uint32_t, std::map<uint32_t, WGPUBindGroupEntry>> m_GroupEntryMap;
 
     std::map<uint32_t, std::map<uint32_t, RenderPassInput>> m_Inputs;
-    std::map<uint32_t, std::map<uint32_t, RenderPassInput>> m_InvalidatedInputs;
+
+    // Flat view of m_Inputs, rebuilt when Set adds a location
+    std::vector<BindingSlot> m_Slots;
+    bool m_SlotsStale = true;
+
+    void RebuildSlots();
+    RenderPassInput& GetInput(uint32_t group, uint32_t location);
 
     BindingSpec m_BindingSpec;
   };
@@ -0,0 +1,454 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "core/Assert.h"
+#include "core/JobSystem.h"
+#include "render/RenderUtils.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint32_t kTexelCount = 16;
+
+    // BC7 4-bit index interpolation weights, out of 64
+    constexpr int kWeights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Writes the fields of a 128-bit block LSB first
+    class BitWriter
+    {
+     public:
+      explicit BitWriter(uint8_t* block)
+          : m_Block(block) { std::memset(m_Block, 0, 16); }
+
+      void Write(uint32_t value, uint32_t bitCount)
+      {
+        for (uint32_t i = 0; i < bitCount; i++, m_Position++)
+        {
+          if (value & (1u << i))
+          {
+            m_Block[m_Position >> 3] |= (uint8_t)(1u << (m_Position & 7));
+          }
+        }
+      }
+
+     private:
+      uint8_t* m_Block;
+      uint32_t m_Position = 0;
+    };
+
+    // Line through the texels along their principal axis, found by power iteration on the
+    // covariance matrix. Returns the two extreme points of the projected texels.
+    void FindEndpoints(const uint8_t* rgba, uint32_t channels, float outLow[4], float outHigh[4])
+    {
+      float mean[4] = {};
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          mean[c] += rgba[i * 4 + c];
+        }
+      }
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        mean[c] /= kTexelCount;
+      }
+
+      float covariance[4][4] = {};
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        float delta[4];
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          delta[c] = rgba[i * 4 + c] - mean[c];
+        }
+        for (uint32_t a = 0; a < channels; a++)
+        {
+          for (uint32_t b = 0; b < channels; b++)
+          {
+            covariance[a][b] += delta[a] * delta[b];
+          }
+        }
+      }
+
+      float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+      for (int iteration = 0; iteration < 8; iteration++)
+      {
+        float next[4] = {};
+        float length = 0.0f;
+        for (uint32_t a = 0; a < channels; a++)
+        {
+          for (uint32_t b = 0; b < channels; b++)
+          {
+            next[a] += covariance[a][b] * axis[b];
+          }
+          length = std::max(length, std::fabs(next[a]));
+        }
+
+        // Flat block, any axis works
+        if (length < 1e-6f)
+        {
+          break;
+        }
+
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          axis[c] = next[c] / length;
+        }
+      }
+
+      float axisLengthSq = 0.0f;
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        axisLengthSq += axis[c] * axis[c];
+      }
+
+      float minT = 0.0f;
+      float maxT = 0.0f;
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        float t = 0.0f;
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        }
+        t /= axisLengthSq;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+      }
+
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        const float base = c < channels ? mean[c] : 255.0f;
+        const float direction = c < channels ? axis[c] : 0.0f;
+        outLow[c] = std::clamp(base + minT * direction, 0.0f, 255.0f);
+        outHigh[c] = std::clamp(base + maxT * direction, 0.0f, 255.0f);
+      }
+    }
+
+    uint32_t SquaredDistance(const uint8_t* texel, const int* color, uint32_t channels)
+    {
+      uint32_t distance = 0;
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        const int delta = (int)texel[c] - color[c];
+        distance += delta * delta;
+      }
+      return distance;
+    }
+
+    // Picks the nearest palette entry for every texel, returns the summed squared error
+    uint32_t AssignIndices(const uint8_t* rgba, const int (*palette)[4], uint32_t paletteSize, uint32_t channels, uint8_t* outIndices)
+    {
+      uint32_t totalError = 0;
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        uint32_t bestError = UINT32_MAX;
+        for (uint32_t p = 0; p < paletteSize; p++)
+        {
+          const uint32_t error = SquaredDistance(rgba + i * 4, palette[p], channels);
+          if (error < bestError)
+          {
+            bestError = error;
+            outIndices[i] = (uint8_t)p;
+          }
+        }
+        totalError += bestError;
+      }
+      return totalError;
+    }
+
+    uint16_t PackRGB565(const float* color)
+    {
+      const uint32_t r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+      const uint32_t g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+      const uint32_t b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+      return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRGB565(uint16_t packed, int* outColor)
+    {
+      const int r = (packed >> 11) & 31;
+      const int g = (packed >> 5) & 63;
+      const int b = packed & 31;
+      outColor[0] = (r << 3) | (r >> 2);
+      outColor[1] = (g << 2) | (g >> 4);
+      outColor[2] = (b << 3) | (b >> 2);
+      outColor[3] = 255;
+    }
+
+    // Mode 6 endpoint: 7 bits per channel plus one shared p-bit
+    struct BC7Endpoint
+    {
+      int Quantized[4];
+      int PBit;
+      int Decoded[4];
+    };
+
+    BC7Endpoint QuantizeBC7Endpoint(const float* color)
+    {
+      BC7Endpoint best = {};
+      float bestError = INFINITY;
+      for (int pBit = 0; pBit < 2; pBit++)
+      {
+        BC7Endpoint candidate = {};
+        candidate.PBit = pBit;
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++)
+        {
+          candidate.Quantized[c] = std::clamp((int)std::lround((color[c] - pBit) / 2.0f), 0, 127);
+          candidate.Decoded[c] = (candidate.Quantized[c] << 1) | pBit;
+          const float delta = candidate.Decoded[c] - color[c];
+          error += delta * delta;
+        }
+
+        if (error < bestError)
+        {
+          bestError = error;
+          best = candidate;
+        }
+      }
+      return best;
+    }
+
+    uint32_t EncodeBC7Indices(const uint8_t* rgba, const BC7Endpoint& low, const BC7Endpoint& high, uint8_t* outIndices)
+    {
+      int palette[16][4];
+      for (int i = 0; i < 16; i++)
+      {
+        for (int c = 0; c < 4; c++)
+        {
+          palette[i][c] = ((64 - kWeights4[i]) * low.Decoded[c] + kWeights4[i] * high.Decoded[c] + 32) >> 6;
+        }
+      }
+      return AssignIndices(rgba, palette, 16, 4, outIndices);
+    }
+
+    // Least squares endpoints for fixed indices, usually a clear win over the PCA extremes
+    bool RefineBC7Endpoints(const uint8_t* rgba, const uint8_t* indices, float outLow[4], float outHigh[4])
+    {
+      float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+      float ax[4] = {}, bx[4] = {};
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        const float t = kWeights4[indices[i]] / 64.0f;
+        const float s = 1.0f - t;
+        aa += s * s;
+        ab += s * t;
+        bb += t * t;
+        for (int c = 0; c < 4; c++)
+        {
+          ax[c] += s * rgba[i * 4 + c];
+          bx[c] += t * rgba[i * 4 + c];
+        }
+      }
+
+      const float determinant = aa * bb - ab * ab;
+      if (std::fabs(determinant) < 1e-6f)
+      {
+        return false;
+      }
+
+      for (int c = 0; c < 4; c++)
+      {
+        outLow[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        outHigh[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+      }
+      return true;
+    }
+  }  // namespace
+
+  void BlockCompression::EncodeBC1(const uint8_t* rgba, uint8_t* outBlock)
+  {
+    float low[4], high[4];
+    FindEndpoints(rgba, 3, low, high);
+
+    uint16_t color0 = PackRGB565(high);
+    uint16_t color1 = PackRGB565(low);
+    if (color0 < color1)
+    {
+      std::swap(color0, color1);
+    }
+
+    uint32_t indexBits = 0;
+    if (color0 != color1)
+    {
+      // color0 > color1 selects the opaque four color mode
+      int palette[4][4];
+      UnpackRGB565(color0, palette[0]);
+      UnpackRGB565(color1, palette[1]);
+      for (int c = 0; c < 3; c++)
+      {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+      }
+
+      uint8_t indices[kTexelCount];
+      AssignIndices(rgba, palette, 4, 3, indices);
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        indexBits |= (uint32_t)indices[i] << (i * 2);
+      }
+    }
+
+    std::memcpy(outBlock, &color0, 2);
+    std::memcpy(outBlock + 2, &color1, 2);
+    std::memcpy(outBlock + 4, &indexBits, 4);
+  }
+
+  void BlockCompression::EncodeBC4(const uint8_t* rgba, uint32_t channel, uint8_t* outBlock)
+  {
+    int minValue = 255;
+    int maxValue = 0;
+    for (uint32_t i = 0; i < kTexelCount; i++)
+    {
+      minValue = std::min(minValue, (int)rgba[i * 4 + channel]);
+      maxValue = std::max(maxValue, (int)rgba[i * 4 + channel]);
+    }
+
+    outBlock[0] = (uint8_t)maxValue;
+    outBlock[1] = (uint8_t)minValue;
+
+    uint64_t indexBits = 0;
+    if (maxValue != minValue)
+    {
+      // red0 > red1 selects the eight value mode
+      int palette[8];
+      palette[0] = maxValue;
+      palette[1] = minValue;
+      for (int k = 2; k < 8; k++)
+      {
+        palette[k] = ((8 - k) * maxValue + (k - 1) * minValue) / 7;
+      }
+
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        const int value = rgba[i * 4 + channel];
+        uint64_t bestIndex = 0;
+        int bestError = INT32_MAX;
+        for (int k = 0; k < 8; k++)
+        {
+          const int error = std::abs(value - palette[k]);
+          if (error < bestError)
+          {
+            bestError = error;
+            bestIndex = (uint64_t)k;
+          }
+        }
+        indexBits |= bestIndex << (i * 3);
+      }
+    }
+
+    for (int byte = 0; byte < 6; byte++)
+    {
+      outBlock[2 + byte] = (uint8_t)(indexBits >> (byte * 8));
+    }
+  }
+
+  void BlockCompression::EncodeBC5(const uint8_t* rgba, uint8_t* outBlock)
+  {
+    EncodeBC4(rgba, 0, outBlock);
+    EncodeBC4(rgba, 1, outBlock + 8);
+  }
+
+  void BlockCompression::EncodeBC7(const uint8_t* rgba, uint8_t* outBlock)
+  {
+    // Mode 6 only: one RGBA subset with 4-bit indices. Fast and good on smooth color data.
+    float low[4], high[4];
+    FindEndpoints(rgba, 4, low, high);
+
+    BC7Endpoint endpoint0 = QuantizeBC7Endpoint(low);
+    BC7Endpoint endpoint1 = QuantizeBC7Endpoint(high);
+    uint8_t indices[kTexelCount];
+    uint32_t error = EncodeBC7Indices(rgba, endpoint0, endpoint1, indices);
+
+    float refinedLow[4], refinedHigh[4];
+    if (error > 0 && RefineBC7Endpoints(rgba, indices, refinedLow, refinedHigh))
+    {
+      const BC7Endpoint refined0 = QuantizeBC7Endpoint(refinedLow);
+      const BC7Endpoint refined1 = QuantizeBC7Endpoint(refinedHigh);
+      uint8_t refinedIndices[kTexelCount];
+      const uint32_t refinedError = EncodeBC7Indices(rgba, refined0, refined1, refinedIndices);
+      if (refinedError < error)
+      {
+        endpoint0 = refined0;
+        endpoint1 = refined1;
+        std::memcpy(indices, refinedIndices, sizeof(indices));
+      }
+    }
+
+    // The anchor index is stored with its top bit implied zero
+    if (indices[0] & 8)
+    {
+      std::swap(endpoint0, endpoint1);
+      for (uint32_t i = 0; i < kTexelCount; i++)
+      {
+        indices[i] = (uint8_t)(15 - indices[i]);
+      }
+    }
+
+    BitWriter writer(outBlock);
+    writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+      writer.Write((uint32_t)endpoint0.Quantized[c], 7);
+      writer.Write((uint32_t)endpoint1.Quantized[c], 7);
+    }
+    writer.Write((uint32_t)endpoint0.PBit, 1);
+    writer.Write((uint32_t)endpoint1.PBit, 1);
+
+    writer.Write(indices[0], 3);
+    for (uint32_t i = 1; i < kTexelCount; i++)
+    {
+      writer.Write(indices[i], 4);
+    }
+  }
+
+  void BlockCompression::CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format, uint8_t* outBlocks)
+  {
+    RN_ASSERT(width % 4 == 0 && height % 4 == 0, "BlockCompression: image size must be a multiple of 4");
+
+    const uint32_t blocksX = width / 4;
+    const uint32_t blocksY = height / 4;
+    const uint32_t blockBytes = TextureUtils::GetBlockBytes(format);
+
+    JobSystem::ParallelFor(blocksY, 8, [=](uint32_t begin, uint32_t end)
+                           {
+      uint8_t texels[kTexelCount * 4];
+      for (uint32_t by = begin; by < end; by++)
+      {
+        for (uint32_t bx = 0; bx < blocksX; bx++)
+        {
+          for (uint32_t row = 0; row < 4; row++)
+          {
+            std::memcpy(texels + row * 16, rgba + ((by * 4 + row) * width + bx * 4) * 4, 16);
+          }
+
+          uint8_t* block = outBlocks + (by * blocksX + bx) * blockBytes;
+          switch (format)
+          {
+            case TextureFormat::BC1:
+              EncodeBC1(texels, block);
+              break;
+            case TextureFormat::BC4:
+              EncodeBC4(texels, 0, block);
+              break;
+            case TextureFormat::BC5:
+              EncodeBC5(texels, block);
+              break;
+            case TextureFormat::BC7:
+              EncodeBC7(texels, block);
+              break;
+            default:
+              RN_ASSERT(false, "BlockCompression: not a block compressed format");
+          }
+        }
+      } });
+  }
+
+  uint64_t BlockCompression::GetCompressedSize(uint32_t width, uint32_t height, TextureFormat format)
+  {
+    return (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * TextureUtils::GetBlockBytes(format);
+  }
+}  // namespace Rain
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include "render/Texture.h"
+
+namespace Rain
+{
+  // CPU encoders for the BCn block formats. Every encoder takes one 4x4 block of RGBA8 texels
+  // (row-major, 64 bytes) and writes a single compressed block.
+  class BlockCompression
+  {
+   public:
+    static void EncodeBC1(const uint8_t* rgba, uint8_t* outBlock);
+    static void EncodeBC4(const uint8_t* rgba, uint32_t channel, uint8_t* outBlock);
+    static void EncodeBC5(const uint8_t* rgba, uint8_t* outBlock);
+    static void EncodeBC7(const uint8_t* rgba, uint8_t* outBlock);
+
+    // Compresses a whole RGBA8 image, width and height must be multiples of 4.
+    // Block rows are spread over the JobSystem.
+    static void CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format, uint8_t* outBlocks);
+
+    static uint64_t GetCompressedSize(uint32_t width, uint32_t height, TextureFormat format);
+  };
+}  // namespace Rain
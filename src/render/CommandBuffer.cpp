@@ -2,6 +2,7 @@
 #include "core/Ref.h"
 #include "render/RenderContext.h"
 #include "render/RenderUtils.h"
+#include "render/UploadRing.h"
 
 namespace Rain
 {
@@ -28,6 +29,7 @@ namespace Rain
 
   void CommandBuffer::Submit()
   {
+    UploadRing::Flush();
     wgpuQueueSubmit(*RenderContext::GetQueue().get(), 1, &m_Buffer);
 
     wgpuCommandBufferRelease(m_Buffer);
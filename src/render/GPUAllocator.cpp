@@ -1,13 +1,17 @@
 #include "GPUAllocator.h"
+#include <algorithm>
 #include <cassert>
 #include "core/Assert.h"
 #include "render/Render.h"
 #include "render/RenderContext.h"
+#include "render/UploadRing.h"
 
 namespace Rain
 {
   int GPUAllocator::allocatedBufferCount = 0;
   int GPUAllocator::allocatedBufferTotalSize = 0;
+  int GPUAllocator::peakBufferCount = 0;
+  int GPUAllocator::peakBufferTotalSize = 0;
 
   Ref<GPUBuffer> GPUAllocator::GAlloc(WGPUBufferUsageFlags usage, int size)
   {
@@ -29,6 +33,8 @@ namespace Rain
 
     allocatedBufferCount++;
     allocatedBufferTotalSize += size;
+    peakBufferCount = std::max(peakBufferCount, allocatedBufferCount);
+    peakBufferTotalSize = std::max(peakBufferTotalSize, allocatedBufferTotalSize);
 
     auto* RenderInstance = Render::Get();
 
@@ -40,6 +46,25 @@ namespace Rain
     return CreateRef<GPUBuffer>(wgpuDeviceCreateBuffer(RenderInstance->GetRenderContext()->GetDevice(), &bufferDesc), size);
   }
 
+  void GPUAllocator::GFree(const Ref<GPUBuffer>& buffer)
+  {
+    if (!buffer)
+    {
+      return;
+    }
+
+    allocatedBufferCount--;
+    allocatedBufferTotalSize -= buffer->Size;
+
+    // The device keeps the buffer alive until submitted work using it has finished
+    if (buffer->Buffer)
+    {
+      wgpuBufferRelease(buffer->Buffer);
+      buffer->Buffer = nullptr;
+      buffer->Generation++;
+    }
+  }
+
   void GPUBuffer::SetData(void const* data, int size)
   {
     SetData(data, 0, size);
@@ -52,7 +77,7 @@ namespace Rain
       if (auto renderContext = Instance->GetRenderContext())
       {
         RN_CORE_ASSERT(this->Buffer, "internal buffer of the GPUBuffer is not initialised.");
-        wgpuQueueWriteBuffer(*renderContext->GetQueue(), this->Buffer, offset, data, size);
+        UploadRing::WriteBuffer(this->Buffer, offset, data, size);
       }
     }
   }
@@ -16,10 +16,15 @@ namespace Rain
    public:
     static Ref<GPUBuffer> GAlloc(std::string label, WGPUBufferUsageFlags usage, int size);
     static Ref<GPUBuffer> GAlloc(WGPUBufferUsageFlags usage, int size);
+    static void GFree(const Ref<GPUBuffer>& buffer);
 
     static int allocatedBufferCount;
     static int allocatedBufferTotalSize;
 
+    // High-water marks since startup
+    static int peakBufferCount;
+    static int peakBufferTotalSize;
+
    private:
     static void GSet(Ref<GPUBuffer> buffer, void* data, int size);
 
@@ -32,6 +37,7 @@ namespace Rain
    public:
     WGPUBuffer Buffer;
     int Size;
+    uint32_t Generation = 0;  // Bumped when Buffer is released or replaced
     GPUBuffer() {};
     GPUBuffer(WGPUBuffer buffer, int size)
         : Buffer(buffer), Size(size) {};
@@ -0,0 +1,56 @@
+#include "GPUFrameArena.h"
+#include <algorithm>
+#include "core/Log.h"
+
+namespace Rain
+{
+  GPUFrameArena::GPUFrameArena(const std::string& label, WGPUBufferUsageFlags usage, uint32_t initialSize)
+      : m_Label(label), m_Usage(usage | WGPUBufferUsage_CopyDst)
+  {
+    initialSize = (initialSize + 3) & ~3u;
+    m_Buffer = GPUAllocator::GAlloc(m_Label, m_Usage, initialSize);
+    m_Staging.reserve(initialSize);
+  }
+
+  GPUFrameArena::~GPUFrameArena()
+  {
+    GPUAllocator::GFree(m_Buffer);
+  }
+
+  Ref<GPUFrameArena> GPUFrameArena::Create(const std::string& label, WGPUBufferUsageFlags usage, uint32_t initialSize)
+  {
+    return CreateRef<GPUFrameArena>(label, usage, initialSize);
+  }
+
+  void GPUFrameArena::BeginFrame()
+  {
+    m_Staging.clear();
+  }
+
+  uint32_t GPUFrameArena::Allocate(uint32_t size)
+  {
+    const uint32_t offset = (uint32_t)m_Staging.size();
+    m_Staging.resize(offset + ((size + 3) & ~3u));
+    return offset;
+  }
+
+  void GPUFrameArena::Upload()
+  {
+    const uint32_t usedSize = GetUsedSize();
+    if (usedSize == 0)
+    {
+      return;
+    }
+
+    if ((uint32_t)m_Buffer->Size < usedSize)
+    {
+      const uint32_t newSize = std::max(usedSize, (uint32_t)m_Buffer->Size * 2);
+      RN_LOG("GPUFrameArena '{}' growing from {} to {} bytes", m_Label, m_Buffer->Size, newSize);
+
+      GPUAllocator::GFree(m_Buffer);
+      m_Buffer = GPUAllocator::GAlloc(m_Label, m_Usage, newSize);
+    }
+
+    m_Buffer->SetData(m_Staging.data(), usedSize);
+  }
+}  // namespace Rain
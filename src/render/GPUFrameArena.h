@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render/GPUAllocator.h"
+
+namespace Rain
+{
+  // Per-frame linear allocator backed by one GPU buffer.
+  // Data is written into CPU staging and uploaded once per frame. A single buffer is safe
+  // without tracking GPU completion: the upload is a queue operation, ordered after the
+  // submits that read last frame's data and before the ones that read this frame's.
+  // The buffer grows geometrically and never shrinks, so a steady workload never
+  // reallocates, and bind groups that reference it only change when it grows.
+  class GPUFrameArena
+  {
+   public:
+    GPUFrameArena(const std::string& label, WGPUBufferUsageFlags usage, uint32_t initialSize);
+    ~GPUFrameArena();
+
+    static Ref<GPUFrameArena> Create(const std::string& label, WGPUBufferUsageFlags usage, uint32_t initialSize);
+
+    void BeginFrame();
+
+    // Returns the byte offset of the allocation inside the buffer
+    uint32_t Allocate(uint32_t size);
+    void* GetData(uint32_t offset) { return m_Staging.data() + offset; }
+
+    // Grows the buffer if needed and uploads everything allocated so far
+    void Upload();
+
+    const Ref<GPUBuffer>& GetBuffer() const { return m_Buffer; }
+    uint32_t GetUsedSize() const { return (uint32_t)m_Staging.size(); }
+    uint32_t GetCapacity() const { return (uint32_t)m_Buffer->Size; }
+
+   private:
+    std::string m_Label;
+    WGPUBufferUsageFlags m_Usage;
+    Ref<GPUBuffer> m_Buffer;
+
+    std::vector<uint8_t> m_Staging;
+  };
+}  // namespace Rain
@@ -0,0 +1,262 @@
+#include "GeometryArena.h"
+#include <algorithm>
+#include <vector>
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "render/Mesh.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint64_t kPageSize = 64ull * 1024 * 1024;
+
+    struct FreeRange
+    {
+      uint32_t Offset;
+      uint32_t Count;
+    };
+
+    struct ArenaPage
+    {
+      Ref<GPUBuffer> Buffer;
+      uint32_t Capacity = 0;  // Elements
+      uint32_t Used = 0;
+      uint32_t Allocations = 0;
+      std::vector<FreeRange> FreeList;  // Sorted by offset, neighbours are never adjacent
+    };
+
+    struct StreamState
+    {
+      std::vector<ArenaPage> Pages;  // Released pages keep their slot so page indices stay stable
+    };
+
+    StreamState s_Streams[(size_t)GeometryStream::Count];
+
+    const char* GetStreamLabel(GeometryStream stream)
+    {
+      switch (stream)
+      {
+        case GeometryStream::Vertex:
+          return "geometry_arena_vertex";
+        case GeometryStream::SkeletalVertex:
+          return "geometry_arena_skeletal_vertex";
+        default:
+          return "geometry_arena_index";
+      }
+    }
+
+    uint32_t CreatePage(GeometryStream stream, uint32_t capacity)
+    {
+      StreamState& state = s_Streams[(size_t)stream];
+      const WGPUBufferUsageFlags usage = WGPUBufferUsage_CopyDst | (stream == GeometryStream::Index ? WGPUBufferUsage_Index : WGPUBufferUsage_Vertex);
+
+      uint32_t index = 0;
+      while (index < state.Pages.size() && state.Pages[index].Buffer)
+      {
+        index++;
+      }
+      if (index == state.Pages.size())
+      {
+        state.Pages.emplace_back();
+      }
+
+      ArenaPage& page = state.Pages[index];
+      page.Buffer = GPUAllocator::GAlloc(GetStreamLabel(stream), usage, (int)((uint64_t)capacity * GeometryArena::GetStride(stream)));
+      page.Capacity = capacity;
+      page.Used = 0;
+      page.Allocations = 0;
+      page.FreeList = {{0, capacity}};
+
+      RN_LOG("GeometryArena: new {} page {} with {} elements", GetStreamLabel(stream), index, capacity);
+      return index;
+    }
+
+    // Best fit, the smallest hole that holds count
+    bool AllocateFromPage(ArenaPage& page, uint32_t count, uint32_t& outOffset)
+    {
+      size_t best = page.FreeList.size();
+      for (size_t i = 0; i < page.FreeList.size(); i++)
+      {
+        const FreeRange& range = page.FreeList[i];
+        if (range.Count >= count && (best == page.FreeList.size() || range.Count < page.FreeList[best].Count))
+        {
+          best = i;
+        }
+      }
+
+      if (best == page.FreeList.size())
+      {
+        return false;
+      }
+
+      FreeRange& range = page.FreeList[best];
+      outOffset = range.Offset;
+      range.Offset += count;
+      range.Count -= count;
+      if (range.Count == 0)
+      {
+        page.FreeList.erase(page.FreeList.begin() + best);
+      }
+
+      page.Used += count;
+      page.Allocations++;
+      return true;
+    }
+
+    void FreeToPage(ArenaPage& page, uint32_t offset, uint32_t count)
+    {
+      auto next = std::lower_bound(page.FreeList.begin(), page.FreeList.end(), offset, [](const FreeRange& range, uint32_t value)
+                                   { return range.Offset < value; });
+      auto inserted = page.FreeList.insert(next, {offset, count});
+
+      // Coalesce with the following and the preceding hole
+      auto following = inserted + 1;
+      if (following != page.FreeList.end() && inserted->Offset + inserted->Count == following->Offset)
+      {
+        inserted->Count += following->Count;
+        page.FreeList.erase(following);
+      }
+      if (inserted != page.FreeList.begin())
+      {
+        auto preceding = inserted - 1;
+        if (preceding->Offset + preceding->Count == inserted->Offset)
+        {
+          preceding->Count += inserted->Count;
+          page.FreeList.erase(inserted);
+        }
+      }
+
+      page.Used -= count;
+      page.Allocations--;
+    }
+  }  // namespace
+
+  void GeometryArena::Shutdown()
+  {
+    for (StreamState& state : s_Streams)
+    {
+      for (ArenaPage& page : state.Pages)
+      {
+        if (page.Buffer)
+        {
+          GPUAllocator::GFree(page.Buffer);
+        }
+      }
+      state.Pages.clear();
+    }
+  }
+
+  uint32_t GeometryArena::GetStride(GeometryStream stream)
+  {
+    switch (stream)
+    {
+      case GeometryStream::Vertex:
+        return sizeof(PackedVertex);
+      case GeometryStream::SkeletalVertex:
+        return sizeof(PackedSkeletalVertex);
+      default:
+        return sizeof(uint32_t);
+    }
+  }
+
+  GeometryAllocation GeometryArena::Allocate(GeometryStream stream, uint32_t count)
+  {
+    GeometryAllocation allocation;
+    if (count == 0)
+    {
+      return allocation;
+    }
+
+    StreamState& state = s_Streams[(size_t)stream];
+    for (uint32_t i = 0; i < state.Pages.size(); i++)
+    {
+      if (state.Pages[i].Buffer && AllocateFromPage(state.Pages[i], count, allocation.Offset))
+      {
+        allocation.Page = i;
+        allocation.Count = count;
+        return allocation;
+      }
+    }
+
+    const uint32_t pageCapacity = (uint32_t)(kPageSize / GetStride(stream));
+    allocation.Page = CreatePage(stream, std::max(count, pageCapacity));
+    allocation.Count = count;
+    AllocateFromPage(state.Pages[allocation.Page], count, allocation.Offset);
+    return allocation;
+  }
+
+  void GeometryArena::Free(GeometryStream stream, GeometryAllocation& allocation)
+  {
+    if (!allocation.IsValid())
+    {
+      return;
+    }
+
+    // Meshes released after Shutdown have nothing left to return
+    StreamState& state = s_Streams[(size_t)stream];
+    if (allocation.Page >= state.Pages.size())
+    {
+      allocation = GeometryAllocation();
+      return;
+    }
+    RN_ASSERT(state.Pages[allocation.Page].Buffer, "GeometryArena: free from a released page");
+
+    ArenaPage& page = state.Pages[allocation.Page];
+    FreeToPage(page, allocation.Offset, allocation.Count);
+
+    // Empty pages are released, except the first one so a steady scene does not churn buffers
+    if (page.Allocations == 0 && allocation.Page > 0)
+    {
+      GPUAllocator::GFree(page.Buffer);
+      page = ArenaPage();
+    }
+
+    allocation = GeometryAllocation();
+  }
+
+  void GeometryArena::Write(GeometryStream stream, const GeometryAllocation& allocation, const void* data)
+  {
+    if (!allocation.IsValid())
+    {
+      return;
+    }
+
+    const uint32_t stride = GetStride(stream);
+    GetBuffer(stream, allocation.Page)->SetData(data, (int)(allocation.Offset * stride), (int)(allocation.Count * stride));
+  }
+
+  const Ref<GPUBuffer>& GeometryArena::GetBuffer(GeometryStream stream, uint32_t page)
+  {
+    // Invalid allocations (a stream the mesh does not have) and pages gone after Shutdown
+    static const Ref<GPUBuffer> s_NullBuffer;
+    const StreamState& state = s_Streams[(size_t)stream];
+    return page < state.Pages.size() ? state.Pages[page].Buffer : s_NullBuffer;
+  }
+
+  GeometryArenaStats GeometryArena::GetStats()
+  {
+    GeometryArenaStats stats;
+    for (size_t stream = 0; stream < (size_t)GeometryStream::Count; stream++)
+    {
+      const uint32_t stride = GetStride((GeometryStream)stream);
+      for (const ArenaPage& page : s_Streams[stream].Pages)
+      {
+        if (!page.Buffer)
+        {
+          continue;
+        }
+
+        stats.Pages++;
+        stats.Allocations += page.Allocations;
+        stats.UsedBytes += (uint64_t)page.Used * stride;
+        stats.CapacityBytes += (uint64_t)page.Capacity * stride;
+
+        // The hole at the end of a page is room to grow, not fragmentation
+        const bool tailFree = !page.FreeList.empty() && page.FreeList.back().Offset + page.FreeList.back().Count == page.Capacity;
+        stats.FreeRanges += (uint32_t)page.FreeList.size() - (tailFree ? 1 : 0);
+      }
+    }
+    return stats;
+  }
+}  // namespace Rain
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include "core/Ref.h"
+#include "render/GPUAllocator.h"
+
+namespace Rain
+{
+  enum class GeometryStream : uint8_t
+  {
+    Vertex,          // PackedVertex
+    SkeletalVertex,  // PackedSkeletalVertex
+    Index,           // uint32_t
+    Count
+  };
+
+  // Range of one stream, Offset and Count are in elements so Offset can go straight into
+  // baseVertex / firstIndex of a draw with the page buffer bound at offset 0
+  struct GeometryAllocation
+  {
+    uint32_t Page = UINT32_MAX;
+    uint32_t Offset = 0;
+    uint32_t Count = 0;
+
+    bool IsValid() const { return Page != UINT32_MAX; }
+  };
+
+  struct GeometryArenaStats
+  {
+    uint32_t Pages = 0;
+    uint32_t Allocations = 0;
+    uint32_t FreeRanges = 0;  // Holes between allocations, a rough fragmentation measure
+    uint64_t UsedBytes = 0;
+    uint64_t CapacityBytes = 0;
+  };
+
+  // Shared vertex and index buffers for all meshes. Each stream is a list of large pages
+  // suballocated with a best-fit free list; meshes bigger than a page get a page of their own.
+  // Consecutive draws from one page bind the same buffers, which the renderer then skips.
+  // Freed ranges can be reused right away, queue writes are ordered after earlier submits.
+  class GeometryArena
+  {
+   public:
+    static void Shutdown();
+
+    static uint32_t GetStride(GeometryStream stream);
+
+    // Returns an invalid allocation for count 0
+    static GeometryAllocation Allocate(GeometryStream stream, uint32_t count);
+    static void Free(GeometryStream stream, GeometryAllocation& allocation);
+
+    // Writes allocation.Count elements, nothing for an invalid allocation
+    static void Write(GeometryStream stream, const GeometryAllocation& allocation, const void* data);
+
+    // Null for the page of an invalid allocation
+    static const Ref<GPUBuffer>& GetBuffer(GeometryStream stream, uint32_t page);
+
+    static GeometryArenaStats GetStats();
+  };
+}  // namespace Rain
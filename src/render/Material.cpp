@@ -31,20 +31,18 @@ namespace Rain
       }
     }
 
-    int size = 0;
-    for (const auto& [_, member] : m_Shader->GetReflectionInfo().ShaderTypes[MATERIAL_UNIFORM_KEY])
-    {
-      size += member.Size;
-    }
-    m_UniformStorageBuffer.Allocate(size);
-    m_UniformStorageBuffer.ZeroInitialize();
-
-    m_UBMaterial = GPUAllocator::GAlloc(name, WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform, size);
-    m_BindManager->Set("uMaterial", m_UBMaterial);
+    // Every material binds the shared buffer and reads its slot through the instance data
+    m_ConstantsIndex = MaterialConstants::Allocate();
+    m_BindManager->Set("uMaterials", MaterialConstants::GetBuffer());
 
     Render::RegisterShaderDependency(shader, this);
   }
 
+  Material::~Material()
+  {
+    MaterialConstants::Free(m_ConstantsIndex);
+  }
+
   Ref<Material> Material::CreateMaterial(const std::string& name, Ref<Shader> shader)
   {
     return CreateRef<Material>(name, shader);
@@ -52,7 +50,6 @@ namespace Rain
 
   void Material::Bake()
   {
-    m_UBMaterial->SetData(m_UniformStorageBuffer.Data, m_UniformStorageBuffer.GetSize());
     m_BindManager->Bake();
   }
 
@@ -69,6 +66,7 @@ namespace Rain
 
   void Material::Set(const std::string& name, Ref<Texture2D> texture)
   {
+    m_Textures[name] = texture;
     m_BindManager->Set(name, texture);
   }
   void Material::Set(const std::string& name, Ref<GPUBuffer> uniform)
@@ -1,8 +1,10 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <unordered_map>
 #include "core/UUID.h"
 #include "render/BindingManager.h"
 #include "render/GPUAllocator.h"
+#include "render/MaterialConstants.h"
 #include "render/Texture.h"
 
 #define MATERIAL_UNIFORM_KEY "MaterialUniform"
@@ -23,12 +25,17 @@ namespace Rain {
     void Set(const std::string& name, bool value);
 
     Material(const std::string& name, Ref<Shader> shader);
+    ~Material();
 
     void Bake();
     const std::string& GetName() { return m_Name; }
+    // Slot of this material in MaterialConstants, carried by the instance data
+    uint32_t GetConstantsIndex() const { return m_ConstantsIndex; }
     void OnShaderReload();
 
     const WGPUBindGroup& GetBinding(int index);
+    // Textures bound by name, for residency requests
+    const std::unordered_map<std::string, Ref<Texture2D>>& GetTextures() const { return m_Textures; }
     static Ref<Material> CreateMaterial(const std::string& name, Ref<Shader> shader);
     const ShaderTypeDecl& FindShaderUniformDecl(const std::string& name);
 
@@ -40,9 +47,7 @@ namespace Rain {
         return;
       }
 
-      auto& buffer = m_UniformStorageBuffer;
-      buffer.Write((byte*)&value, decl.Size, decl.Offset);
-      m_UBMaterial->SetData(m_UniformStorageBuffer.Data, m_UniformStorageBuffer.GetSize());
+      MaterialConstants::Write(m_ConstantsIndex, decl.Offset, &value, decl.Size);
     }
 
     Ref<BindingManager> m_BindManager;
@@ -50,8 +55,8 @@ namespace Rain {
    private:
     Ref<Shader> m_Shader;
     std::string m_Name;
-    Ref<GPUBuffer> m_UBMaterial;
-    Buffer m_UniformStorageBuffer;
+    uint32_t m_ConstantsIndex;
+    std::unordered_map<std::string, Ref<Texture2D>> m_Textures;
   };
 
   class MaterialTable {
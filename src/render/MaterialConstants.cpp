@@ -0,0 +1,184 @@
+#include "MaterialConstants.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "core/Assert.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "debug/Profiler.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint32_t kInitialSlots = 256;
+    constexpr WGPUBufferUsageFlags kUsage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Storage;
+
+    struct ConstantsState
+    {
+      Ref<GPUBuffer> Buffer;
+      uint32_t Capacity = 0;  // Slots in Buffer
+      std::vector<uint8_t> Shadow;      // SlotSize bytes per slot, grows ahead of Buffer
+      std::vector<uint8_t> DirtyFlags;  // Per slot, guards DirtySlots against duplicates
+      std::vector<uint32_t> DirtySlots;
+      std::vector<uint32_t> FreeSlots;
+      MaterialConstantsStats Stats;
+    };
+
+    ConstantsState s_Constants;
+
+    void MarkDirty(uint32_t slot)
+    {
+      if (!s_Constants.DirtyFlags[slot])
+      {
+        s_Constants.DirtyFlags[slot] = 1;
+        s_Constants.DirtySlots.push_back(slot);
+      }
+    }
+
+    // Replaces the handle inside the shared GPUBuffer so bind groups holding it rebuild on the
+    // generation change, then everything in use is uploaded again
+    void GrowBuffer(uint32_t slotCount)
+    {
+      uint32_t capacity = std::max(s_Constants.Capacity, kInitialSlots);
+      while (capacity < slotCount)
+      {
+        capacity *= 2;
+      }
+
+      Ref<GPUBuffer> grown = GPUAllocator::GAlloc("material_constants", kUsage, (int)(capacity * MaterialConstants::SlotSize));
+      if (!s_Constants.Buffer)
+      {
+        s_Constants.Buffer = grown;
+      }
+      else
+      {
+        std::swap(s_Constants.Buffer->Buffer, grown->Buffer);
+        std::swap(s_Constants.Buffer->Size, grown->Size);
+        GPUAllocator::GFree(grown);
+        s_Constants.Buffer->Generation++;
+      }
+
+      s_Constants.Capacity = capacity;
+      s_Constants.DirtySlots.clear();
+      std::fill(s_Constants.DirtyFlags.begin(), s_Constants.DirtyFlags.end(), 0);
+      for (uint32_t slot = 0; slot < (uint32_t)s_Constants.DirtyFlags.size(); slot++)
+      {
+        MarkDirty(slot);
+      }
+
+      RN_LOG("MaterialConstants: buffer grown to {} slots", capacity);
+    }
+  }  // namespace
+
+  void MaterialConstants::Shutdown()
+  {
+    GPUAllocator::GFree(s_Constants.Buffer);
+    s_Constants = ConstantsState();
+  }
+
+  uint32_t MaterialConstants::Allocate()
+  {
+    RN_ASSERT(JobSystem::IsMainThread(), "MaterialConstants::Allocate must be called on the main thread");
+
+    uint32_t slot;
+    if (!s_Constants.FreeSlots.empty())
+    {
+      slot = s_Constants.FreeSlots.back();
+      s_Constants.FreeSlots.pop_back();
+      std::memset(&s_Constants.Shadow[(size_t)slot * SlotSize], 0, SlotSize);
+    }
+    else
+    {
+      slot = (uint32_t)s_Constants.DirtyFlags.size();
+      s_Constants.Shadow.resize(s_Constants.Shadow.size() + SlotSize, 0);
+      s_Constants.DirtyFlags.push_back(0);
+    }
+
+    // The buffer exists from the first material on so bind groups have something to point at
+    if (!s_Constants.Buffer)
+    {
+      GrowBuffer(kInitialSlots);
+    }
+
+    MarkDirty(slot);
+    s_Constants.Stats.Materials++;
+    return slot;
+  }
+
+  void MaterialConstants::Free(uint32_t slot)
+  {
+    // Materials released after Shutdown have nothing left to return
+    if (slot >= s_Constants.DirtyFlags.size())
+    {
+      return;
+    }
+
+    s_Constants.FreeSlots.push_back(slot);
+    s_Constants.Stats.Materials--;
+  }
+
+  void MaterialConstants::Write(uint32_t slot, uint32_t offset, const void* data, uint32_t size)
+  {
+    RN_ASSERT(offset + size <= SlotSize, "MaterialConstants: write past the end of a material slot");
+    std::memcpy(&s_Constants.Shadow[(size_t)slot * SlotSize + offset], data, size);
+    MarkDirty(slot);
+  }
+
+  void MaterialConstants::Flush()
+  {
+    RN_PROFILE_FUNC;
+    MaterialConstantsStats& stats = s_Constants.Stats;
+    stats.FlushedRanges = 0;
+    stats.FlushedBytes = 0;
+
+    const uint32_t slotCount = (uint32_t)s_Constants.DirtyFlags.size();
+    if (slotCount > s_Constants.Capacity)
+    {
+      GrowBuffer(slotCount);
+    }
+    stats.Capacity = s_Constants.Capacity;
+
+    std::vector<uint32_t>& dirty = s_Constants.DirtySlots;
+    if (dirty.empty() || !s_Constants.Buffer->Buffer)
+    {
+      return;
+    }
+
+    // One write per run of neighbouring slots
+    std::sort(dirty.begin(), dirty.end());
+    size_t runStart = 0;
+    for (size_t i = 1; i <= dirty.size(); i++)
+    {
+      if (i < dirty.size() && dirty[i] == dirty[i - 1] + 1)
+      {
+        continue;
+      }
+
+      const uint32_t firstSlot = dirty[runStart];
+      const uint32_t bytes = (dirty[i - 1] - firstSlot + 1) * SlotSize;
+      s_Constants.Buffer->SetData(&s_Constants.Shadow[(size_t)firstSlot * SlotSize], (int)(firstSlot * SlotSize), (int)bytes);
+
+      stats.FlushedRanges++;
+      stats.FlushedBytes += bytes;
+      runStart = i;
+    }
+
+    for (uint32_t slot : dirty)
+    {
+      s_Constants.DirtyFlags[slot] = 0;
+    }
+    dirty.clear();
+  }
+
+  const Ref<GPUBuffer>& MaterialConstants::GetBuffer()
+  {
+    return s_Constants.Buffer;
+  }
+
+  const MaterialConstantsStats& MaterialConstants::GetStats()
+  {
+    return s_Constants.Stats;
+  }
+}  // namespace Rain
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include "core/Ref.h"
+#include "render/GPUAllocator.h"
+
+namespace Rain
+{
+  struct MaterialConstantsStats
+  {
+    uint32_t Materials = 0;
+    uint32_t Capacity = 0;       // Slots in the GPU buffer
+    uint32_t FlushedRanges = 0;  // Last Flush
+    uint64_t FlushedBytes = 0;
+  };
+
+  // Constants of every material in one storage buffer, a fixed size slot per material indexed by
+  // Material::GetConstantsIndex. Writes go to a CPU shadow copy and Flush uploads the dirty slots
+  // once per frame, coalesced into contiguous ranges.
+  class MaterialConstants
+  {
+   public:
+    // Array stride of MaterialUniform in the shaders, which pad the struct up to it
+    static constexpr uint32_t SlotSize = 64;
+
+    static void Shutdown();
+
+    static uint32_t Allocate();
+    static void Free(uint32_t slot);
+    static void Write(uint32_t slot, uint32_t offset, const void* data, uint32_t size);
+    static void Flush();
+
+    // The object stays the same when the buffer grows, its Generation is bumped instead
+    static const Ref<GPUBuffer>& GetBuffer();
+
+    static const MaterialConstantsStats& GetStats();
+  };
+}  // namespace Rain
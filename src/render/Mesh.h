@@ -2,17 +2,16 @@
 
 #include <vector>
 #include "Material.h"
+#include "Math/AABB.h"
 #include "animation/OzzAnimation.h"
 #include "animation/OzzSkeleton.h"
 #include "animation/Skeleton.h"
 #include "core/UUID.h"
-
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/Importer.hpp>
+#include "render/GeometryArena.h"
 
 namespace Rain
 {
+  // Full precision vertex produced by import, packed into PackedVertex when cooked
   struct VertexAttribute
   {
     glm::vec3 Position;
@@ -43,14 +42,65 @@ namespace Rain
     glm::vec4 BoneWeights;   // 16 bytes
   };
 
+  // GPU vertex stream, 20 bytes. Positions are unorm16 across the submesh bounds, normal and
+  // tangent are octahedral snorm16 and the bitangent is rebuilt as cross(N, T) * sign.
+  struct PackedVertex
+  {
+    uint16_t Position[4];  // w holds the bitangent sign, 0 for -1 and 65535 for +1
+    int16_t Normal[2];
+    int16_t Tangent[2];
+    uint16_t TexCoords[2];  // Half floats
+  };
+
+  // Skinned GPU vertex stream, 32 bytes
+  struct PackedSkeletalVertex
+  {
+    PackedVertex Base;
+    uint8_t BoneIndices[4];
+    uint16_t BoneWeights[4];  // unorm16, sums to one
+  };
+
+  static_assert(sizeof(PackedVertex) == 20 && sizeof(PackedSkeletalVertex) == 32, "Packed vertex layouts must match the pipeline vertex layouts");
+
+  // Index range of one detail level, all levels of a submesh share its vertices
+  struct SubMeshLod
+  {
+    uint32_t BaseIndex = 0;
+    uint32_t IndexCount = 0;
+    float Error = 0.0f;  // Simplification error relative to the submesh bounding radius
+  };
+
   struct SubMesh
   {
    public:
+    static constexpr uint32_t MaxLodCount = 5;
+
     uint32_t BaseVertex;
     uint32_t BaseIndex;
     uint32_t IndexCount;
     uint32_t VertexCount;
     uint32_t MaterialIndex;
+
+    // Local space bounds, computed at import
+    AABB BoundingBox;
+
+    // Lods[0] is the full range above, coarser levels follow
+    uint32_t LodCount = 1;
+    SubMeshLod Lods[MaxLodCount];
+
+    // Placement in the geometry arena pages of the owning MeshSource, set on upload.
+    // Draws use these instead of BaseVertex, LOD index ranges are offset by ArenaIndexOffset.
+    int32_t ArenaBaseVertex = 0;
+    int32_t ArenaSkeletalBaseVertex = 0;
+    uint32_t ArenaIndexOffset = 0;
+
+    // Decodes packed positions: Offset + unorm * Scale. Flat axes keep a unit scale.
+    glm::vec3 GetPositionOffset() const { return BoundingBox.Min; }
+    glm::vec3 GetPositionScale() const
+    {
+      const glm::vec3 size = BoundingBox.Max - BoundingBox.Min;
+      return glm::vec3(size.x > 0.0f ? size.x : 1.0f, size.y > 0.0f ? size.y : 1.0f, size.z > 0.0f ? size.z : 1.0f);
+    }
   };
 
   class MeshNode
@@ -64,6 +114,10 @@ namespace Rain
     inline bool IsRoot() const { return Parent == 0xffffffff; }
   };
 
+  struct CookedMesh;
+  struct MaterialDesc;
+  struct MeshLoadState;
+
   // TODO: At the moment we pack everything into MeshSource class, in the future we should seperate import, materials etc.
   class MeshSource
   {
@@ -77,14 +131,25 @@ namespace Rain
     Ref<MaterialTable> Materials;
 
     MeshSource(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& indices);
+    // Loads the cooked mesh from the DerivedDataCache, cooking the source on a miss
     MeshSource(std::string path);
+    // Deferred load for the async path: call Decode on a worker, then Upload on the main thread.
+    // With streamTextures, material textures load in the background behind placeholders.
+    MeshSource(std::string path, bool streamTextures);
+    ~MeshSource();
+
+    bool Decode();
+    void Upload();
+    // Bytes the pending Upload will write to the GPU
+    uint64_t GetUploadSize() const;
 
     const Ref<MeshNode> GetRootNode() const { return m_Nodes[0]; }
     const std::vector<Ref<MeshNode>> GetNodes() const { return m_Nodes; }
 
-    Ref<GPUBuffer> GetVertexBuffer() { return m_VertexBuffer; }
-    Ref<GPUBuffer> GetIndexBuffer() { return m_IndexBuffer; }
-    Ref<GPUBuffer> GetSkeletalVertexBuffer() { return m_SkeletalVertexBuffer; }
+    // Arena pages holding this mesh, shared with other meshes
+    const Ref<GPUBuffer>& GetVertexBuffer() const { return GeometryArena::GetBuffer(GeometryStream::Vertex, m_VertexAllocation.Page); }
+    const Ref<GPUBuffer>& GetIndexBuffer() const { return GeometryArena::GetBuffer(GeometryStream::Index, m_IndexAllocation.Page); }
+    const Ref<GPUBuffer>& GetSkeletalVertexBuffer() const { return GeometryArena::GetBuffer(GeometryStream::SkeletalVertex, m_SkeletalVertexAllocation.Page); }
 
     bool HasSkeleton() const { return m_Skeleton != nullptr && !m_Skeleton->Bones.empty(); }
     Ref<Skeleton> GetSkeleton() { return m_Skeleton; }
@@ -95,15 +160,18 @@ namespace Rain
     size_t GetOzzAnimationCount() const { return m_OzzAnimations.size(); }
 
    private:
-    Ref<GPUBuffer> m_VertexBuffer;
-    Ref<GPUBuffer> m_IndexBuffer;
-    Ref<GPUBuffer> m_SkeletalVertexBuffer;
+    GeometryAllocation m_VertexAllocation;
+    GeometryAllocation m_IndexAllocation;
+    GeometryAllocation m_SkeletalVertexAllocation;
     Ref<Skeleton> m_Skeleton;
 
     Ref<OzzSkeleton> m_OzzSkeleton;
     std::vector<Ref<OzzAnimation>> m_OzzAnimations;
 
-    void TraverseNode(aiNode* node, const aiScene* scene);
-    void ExtractBones(const aiScene* scene);
+    Scope<MeshLoadState> m_LoadState;
+    bool m_StreamTextures = false;
+
+    void Load(const CookedMesh& cooked);
+    void BuildMaterials(const std::vector<MaterialDesc>& materials);
   };
 }  // namespace Rain
@@ -0,0 +1,1056 @@
+#include "MeshCooker.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "animation/OzzArchive.h"
+#include "animation/OzzConverter.h"
+#include "core/Assert.h"
+#include "core/DerivedDataCache.h"
+#include "core/Log.h"
+#include "io/MappedFile.h"
+#include "io/filesystem.h"
+#include "render/MeshOptimizer.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr unsigned int kImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices;
+    constexpr uint32_t kMaxPackedBones = 256;
+    constexpr uint32_t kMinLodIndexCount = 64 * 3;
+
+    class BlobWriter
+    {
+     public:
+      explicit BlobWriter(std::vector<uint8_t>& data)
+          : m_Data(data) { m_Data.clear(); }
+
+      size_t Tell() const { return m_Data.size(); }
+
+      void WriteBytes(const void* data, size_t size)
+      {
+        const uint8_t* bytes = (const uint8_t*)data;
+        m_Data.insert(m_Data.end(), bytes, bytes + size);
+      }
+
+      template <typename T>
+      void Write(const T& value)
+      {
+        WriteBytes(&value, sizeof(T));
+      }
+
+      void WriteString(const std::string& value)
+      {
+        Write<uint32_t>((uint32_t)value.size());
+        WriteBytes(value.data(), value.size());
+      }
+
+      void WriteBlob(const std::vector<uint8_t>& blob)
+      {
+        Write<uint32_t>((uint32_t)blob.size());
+        WriteBytes(blob.data(), blob.size());
+      }
+
+      void Align(size_t alignment)
+      {
+        m_Data.resize((m_Data.size() + alignment - 1) & ~(alignment - 1), 0);
+      }
+
+      template <typename T>
+      void Overwrite(size_t offset, const T& value)
+      {
+        std::memcpy(m_Data.data() + offset, &value, sizeof(T));
+      }
+
+     private:
+      std::vector<uint8_t>& m_Data;
+    };
+
+    // Bounds-checked reader, a truncated or corrupt blob fails the parse instead of reading past it
+    class BlobReader
+    {
+     public:
+      BlobReader(const uint8_t* data, size_t size)
+          : m_Data(data), m_Size(size) {}
+
+      bool IsValid() const { return m_Valid; }
+
+      const uint8_t* ReadBytes(size_t size)
+      {
+        if (!m_Valid || m_Offset + size > m_Size)
+        {
+          m_Valid = false;
+          return nullptr;
+        }
+
+        const uint8_t* bytes = m_Data + m_Offset;
+        m_Offset += size;
+        return bytes;
+      }
+
+      template <typename T>
+      T Read()
+      {
+        T value{};
+        if (const uint8_t* bytes = ReadBytes(sizeof(T)))
+        {
+          std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+      }
+
+      std::string ReadString()
+      {
+        const uint32_t size = Read<uint32_t>();
+        const uint8_t* bytes = ReadBytes(size);
+        return bytes ? std::string((const char*)bytes, size) : std::string();
+      }
+
+      std::pair<const uint8_t*, uint32_t> ReadBlob()
+      {
+        const uint32_t size = Read<uint32_t>();
+        return {ReadBytes(size), size};
+      }
+
+      // Element count of a list whose elements take at least minElementSize bytes, so a count
+      // the remaining bytes cannot hold fails here instead of sizing a huge allocation
+      uint32_t ReadCount(size_t minElementSize)
+      {
+        const uint32_t count = Read<uint32_t>();
+        if (!m_Valid || count > (m_Size - m_Offset) / minElementSize)
+        {
+          m_Valid = false;
+          return 0;
+        }
+        return count;
+      }
+
+     private:
+      const uint8_t* m_Data;
+      size_t m_Size;
+      size_t m_Offset = 0;
+      bool m_Valid = true;
+    };
+
+    glm::mat4 ConvertMatrix(const aiMatrix4x4& from)
+    {
+      glm::mat4 to;
+
+      to[0][0] = from.a1;
+      to[0][1] = from.b1;
+      to[0][2] = from.c1;
+      to[0][3] = from.d1;
+      to[1][0] = from.a2;
+      to[1][1] = from.b2;
+      to[1][2] = from.c2;
+      to[1][3] = from.d2;
+      to[2][0] = from.a3;
+      to[2][1] = from.b3;
+      to[2][2] = from.c3;
+      to[2][3] = from.d3;
+      to[3][0] = from.a4;
+      to[3][1] = from.b4;
+      to[3][2] = from.c4;
+      to[3][3] = from.d4;
+
+      return to;
+    }
+
+    TextureWrappingFormat ConvertAssimpWrapMode(aiTextureMapMode mode)
+    {
+      switch (mode)
+      {
+        case aiTextureMapMode_Wrap:
+          return TextureWrappingFormat::Repeat;
+        case aiTextureMapMode_Clamp:
+          return TextureWrappingFormat::ClampToEdges;
+        case aiTextureMapMode_Mirror:
+          return TextureWrappingFormat::Repeat;
+        case aiTextureMapMode_Decal:
+          return TextureWrappingFormat::ClampToEdges;
+        default:
+          return TextureWrappingFormat::Repeat;
+      }
+    }
+
+    bool ReadTextureDesc(aiMaterial* aiMat, aiTextureType texType, int texIndex, MaterialTextureDesc& outDesc)
+    {
+      aiString texturePath;
+      if (aiMat->GetTexture(texType, texIndex, &texturePath) != aiReturn_SUCCESS)
+      {
+        RN_LOG_ERR("MeshCooker: failed to read texture {} of material {}", texIndex, aiMat->GetName().C_Str());
+        return false;
+      }
+
+      outDesc.Name = FileSys::GetFileName(texturePath.C_Str());
+      outDesc.Path = texturePath.C_Str();
+      outDesc.Wrap = TextureWrappingFormat::Repeat;
+
+      aiTextureMapMode wrapU = aiTextureMapMode_Wrap;
+      aiTextureMapMode wrapV = aiTextureMapMode_Wrap;
+
+      if (aiMat->Get(AI_MATKEY_MAPPINGMODE_U(texType, texIndex), wrapU) == AI_SUCCESS)
+      {
+        outDesc.Wrap = ConvertAssimpWrapMode(wrapU);
+      }
+      if (aiMat->Get(AI_MATKEY_MAPPINGMODE_V(texType, texIndex), wrapV) == AI_SUCCESS)
+      {
+        if (ConvertAssimpWrapMode(wrapV) == TextureWrappingFormat::ClampToEdges)
+        {
+          outDesc.Wrap = TextureWrappingFormat::ClampToEdges;
+        }
+      }
+
+      return true;
+    }
+
+    void ImportMaterials(const aiScene* scene, std::vector<MaterialDesc>& outMaterials)
+    {
+      outMaterials.resize(scene->mNumMaterials);
+
+      for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+      {
+        aiMaterial* aiMat = scene->mMaterials[i];
+        MaterialDesc& desc = outMaterials[i];
+        desc.Name = aiMat->GetName().C_Str();
+
+        // The last diffuse texture wins, matching how the material slot is overwritten
+        for (uint32_t j = 0; j < aiMat->GetTextureCount(aiTextureType_DIFFUSE); j++)
+        {
+          MaterialTextureDesc albedo;
+          if (ReadTextureDesc(aiMat, aiTextureType_DIFFUSE, j, albedo))
+          {
+            desc.AlbedoTexture = albedo;
+          }
+        }
+
+        if (aiMat->GetTextureCount(aiTextureType_NORMALS) > 0)
+        {
+          ReadTextureDesc(aiMat, aiTextureType_NORMALS, 0, desc.NormalTexture);
+        }
+
+        if (aiMat->GetTextureCount(aiTextureType_METALNESS) > 0)
+        {
+          ReadTextureDesc(aiMat, aiTextureType_METALNESS, 0, desc.MetallicTexture);
+        }
+      }
+    }
+
+    void ImportStreams(const aiScene* scene, std::vector<VertexAttribute>& outVertices, std::vector<uint32_t>& outIndices, std::vector<SubMesh>& outSubMeshes)
+    {
+      uint32_t vertexCount = 0;
+      uint32_t indexCount = 0;
+      for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+      {
+        const aiMesh* mesh = scene->mMeshes[i];
+        vertexCount += mesh->mNumVertices;
+        for (uint32_t j = 0; j < mesh->mNumFaces; j++)
+        {
+          indexCount += mesh->mFaces[j].mNumIndices;
+        }
+      }
+
+      // Sized once up front, every submesh writes into its own range
+      outVertices.assign(vertexCount, VertexAttribute{});
+      outIndices.resize(indexCount);
+      outSubMeshes.resize(scene->mNumMeshes);
+
+      uint32_t offsetVertex = 0;
+      uint32_t offsetIndex = 0;
+
+      for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+      {
+        const aiMesh* mesh = scene->mMeshes[i];
+        SubMesh& subMesh = outSubMeshes[i];
+        subMesh.MaterialIndex = mesh->mMaterialIndex;
+        subMesh.BaseVertex = offsetVertex;
+        subMesh.VertexCount = mesh->mNumVertices;
+        subMesh.BaseIndex = offsetIndex;
+
+        for (uint32_t j = 0; j < mesh->mNumVertices; j++)
+        {
+          VertexAttribute& vertex = outVertices[offsetVertex + j];
+          vertex.Position = glm::vec3(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+          subMesh.BoundingBox.Expand(vertex.Position);
+
+          if (mesh->HasNormals())
+          {
+            vertex.Normal = glm::vec3(mesh->mNormals[j].x, mesh->mNormals[j].y, mesh->mNormals[j].z);
+          }
+
+          if (mesh->HasTangentsAndBitangents())
+          {
+            vertex.Tangent = glm::vec3(mesh->mTangents[j].x, mesh->mTangents[j].y, mesh->mTangents[j].z);
+            vertex.Bitangent = glm::vec3(mesh->mBitangents[j].x, mesh->mBitangents[j].y, mesh->mBitangents[j].z);
+          }
+
+          if (mesh->mTextureCoords[0])
+          {
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
+          }
+        }
+
+        uint32_t meshIndexCount = 0;
+        for (uint32_t j = 0; j < mesh->mNumFaces; j++)
+        {
+          const aiFace& face = mesh->mFaces[j];
+          std::memcpy(&outIndices[offsetIndex + meshIndexCount], face.mIndices, face.mNumIndices * sizeof(uint32_t));
+          meshIndexCount += face.mNumIndices;
+        }
+
+        subMesh.IndexCount = meshIndexCount;
+        offsetVertex += mesh->mNumVertices;
+        offsetIndex += meshIndexCount;
+      }
+    }
+
+    void ImportNodes(const aiNode* node, std::vector<MeshNode>& outNodes)
+    {
+      if (node->mNumMeshes > 0)
+      {
+        MeshNode meshNode;
+        meshNode.Parent = outNodes.empty() ? meshNode.Parent : (uint32_t)outNodes.size() - 1;
+        meshNode.Name = std::string(node->mName.C_Str());
+        meshNode.SubMeshId = node->mMeshes[0];  // For now just handle first mesh
+        meshNode.LocalTransform = ConvertMatrix(node->mTransformation);
+        outNodes.push_back(meshNode);
+      }
+
+      for (uint32_t i = 0; i < node->mNumChildren; i++)
+      {
+        ImportNodes(node->mChildren[i], outNodes);
+      }
+    }
+
+    void FindBoneNodes(aiNode* node, const Skeleton& skeleton, std::unordered_map<std::string, aiNode*>& boneNodes)
+    {
+      std::string nodeName(node->mName.C_Str());
+      if (skeleton.BoneNameToIndex.find(nodeName) != skeleton.BoneNameToIndex.end())
+      {
+        boneNodes[nodeName] = node;
+      }
+
+      for (uint32_t i = 0; i < node->mNumChildren; i++)
+      {
+        FindBoneNodes(node->mChildren[i], skeleton, boneNodes);
+      }
+    }
+
+    bool ImportSkeleton(const aiScene* scene, Skeleton& outSkeleton, std::vector<SkeletalVertexAttribute>& outVertices)
+    {
+      bool hasBones = false;
+      uint32_t totalVertices = 0;
+      for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+      {
+        totalVertices += scene->mMeshes[i]->mNumVertices;
+        hasBones |= scene->mMeshes[i]->mNumBones > 0;
+      }
+
+      if (!hasBones)
+      {
+        return false;
+      }
+
+      // First pass: collect all unique bones with inverse bind matrices
+      for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++)
+      {
+        const aiMesh* mesh = scene->mMeshes[meshIdx];
+        for (uint32_t boneIdx = 0; boneIdx < mesh->mNumBones; boneIdx++)
+        {
+          const aiBone* bone = mesh->mBones[boneIdx];
+          std::string boneName(bone->mName.C_Str());
+
+          if (outSkeleton.BoneNameToIndex.find(boneName) == outSkeleton.BoneNameToIndex.end())
+          {
+            outSkeleton.BoneNameToIndex[boneName] = (uint32_t)outSkeleton.Bones.size();
+
+            Bone newBone;
+            newBone.Name = boneName;
+            newBone.ParentIndex = -1;
+            newBone.InverseBindMatrix = ConvertMatrix(bone->mOffsetMatrix);
+            outSkeleton.Bones.push_back(newBone);
+          }
+        }
+      }
+
+      // Second pass: find bone nodes in scene hierarchy and resolve local transforms and parents
+      std::unordered_map<std::string, aiNode*> boneNodes;
+      FindBoneNodes(scene->mRootNode, outSkeleton, boneNodes);
+
+      for (auto& bone : outSkeleton.Bones)
+      {
+        auto it = boneNodes.find(bone.Name);
+        if (it == boneNodes.end())
+        {
+          continue;
+        }
+
+        aiNode* node = it->second;
+        bone.LocalTransform = ConvertMatrix(node->mTransformation);
+        if (node->mParent)
+        {
+          bone.ParentIndex = outSkeleton.GetBoneIndex(node->mParent->mName.C_Str());
+        }
+      }
+
+      // Parents before children, so the runtime can compute matrices in one pass
+      outSkeleton.SortBones();
+      outSkeleton.ComputeBoneMatrices();
+
+      outVertices.assign(totalVertices, SkeletalVertexAttribute{});
+      uint32_t vertexOffset = 0;
+
+      for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++)
+      {
+        const aiMesh* mesh = scene->mMeshes[meshIdx];
+        SkeletalVertexAttribute* meshVertices = outVertices.data() + vertexOffset;
+
+        for (uint32_t j = 0; j < mesh->mNumVertices; j++)
+        {
+          SkeletalVertexAttribute& vertex = meshVertices[j];
+          vertex.Position = glm::vec3(mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z);
+
+          if (mesh->HasNormals())
+          {
+            vertex.Normal = glm::vec3(mesh->mNormals[j].x, mesh->mNormals[j].y, mesh->mNormals[j].z);
+          }
+
+          if (mesh->HasTangentsAndBitangents())
+          {
+            vertex.Tangent = glm::vec3(mesh->mTangents[j].x, mesh->mTangents[j].y, mesh->mTangents[j].z);
+            vertex.Bitangent = glm::vec3(mesh->mBitangents[j].x, mesh->mBitangents[j].y, mesh->mBitangents[j].z);
+          }
+
+          if (mesh->mTextureCoords[0])
+          {
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
+          }
+
+          vertex.BoneIndices = glm::uvec4(0, 0, 0, 0);
+          vertex.BoneWeights = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+
+        for (uint32_t boneIdx = 0; boneIdx < mesh->mNumBones; boneIdx++)
+        {
+          const aiBone* bone = mesh->mBones[boneIdx];
+          int32_t boneIndex = outSkeleton.GetBoneIndex(bone->mName.C_Str());
+          if (boneIndex < 0)
+          {
+            continue;
+          }
+
+          for (uint32_t weightIdx = 0; weightIdx < bone->mNumWeights; weightIdx++)
+          {
+            const aiVertexWeight& weight = bone->mWeights[weightIdx];
+            SkeletalVertexAttribute& vertex = meshVertices[weight.mVertexId];
+
+            // Find first empty slot for bone weight
+            for (int slot = 0; slot < 4; slot++)
+            {
+              if (vertex.BoneWeights[slot] == 0.0f)
+              {
+                vertex.BoneIndices[slot] = boneIndex;
+                vertex.BoneWeights[slot] = weight.mWeight;
+                break;
+              }
+            }
+          }
+        }
+
+        // Normalize weights and ensure at least one bone affects each vertex
+        for (uint32_t j = 0; j < mesh->mNumVertices; j++)
+        {
+          SkeletalVertexAttribute& vertex = meshVertices[j];
+          float totalWeight = vertex.BoneWeights.x + vertex.BoneWeights.y + vertex.BoneWeights.z + vertex.BoneWeights.w;
+
+          if (totalWeight > 0.0f)
+          {
+            vertex.BoneWeights /= totalWeight;
+          }
+          else
+          {
+            vertex.BoneIndices = glm::uvec4(0, 0, 0, 0);
+            vertex.BoneWeights = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+          }
+        }
+
+        vertexOffset += mesh->mNumVertices;
+      }
+
+      RN_LOG("MeshCooker: imported skeleton with {} bones", outSkeleton.Bones.size());
+      return true;
+    }
+
+    // Reorders every submesh for the post-transform cache, overdraw and vertex fetch. Skinned
+    // vertices share the submesh ranges and follow the same remap.
+    void OptimizeStreams(const std::string& sourcePath, std::vector<VertexAttribute>& vertices, std::vector<SkeletalVertexAttribute>& skeletalVertices,
+                         std::vector<uint32_t>& indices, const std::vector<SubMesh>& subMeshes)
+    {
+      double missesBefore = 0.0;
+      double missesAfter = 0.0;
+      size_t triangleCount = 0;
+      std::vector<uint32_t> remap;
+
+      for (const SubMesh& subMesh : subMeshes)
+      {
+        uint32_t* subIndices = indices.data() + subMesh.BaseIndex;
+        VertexAttribute* subVertices = vertices.data() + subMesh.BaseVertex;
+        const size_t subTriangles = subMesh.IndexCount / 3;
+
+        missesBefore += MeshOptimizer::AnalyzeVertexCache(subIndices, subMesh.IndexCount, subMesh.VertexCount).ACMR * subTriangles;
+
+        MeshOptimizer::OptimizeVertexCache(subIndices, subMesh.IndexCount, subMesh.VertexCount);
+        MeshOptimizer::OptimizeOverdraw(subIndices, subMesh.IndexCount, &subVertices->Position, subMesh.VertexCount, sizeof(VertexAttribute));
+        MeshOptimizer::OptimizeVertexFetch(subIndices, subMesh.IndexCount, subMesh.VertexCount, remap);
+        MeshOptimizer::RemapVertices(subVertices, subMesh.VertexCount, remap);
+        if (!skeletalVertices.empty())
+        {
+          MeshOptimizer::RemapVertices(skeletalVertices.data() + subMesh.BaseVertex, subMesh.VertexCount, remap);
+        }
+
+        missesAfter += MeshOptimizer::AnalyzeVertexCache(subIndices, subMesh.IndexCount, subMesh.VertexCount).ACMR * subTriangles;
+        triangleCount += subTriangles;
+      }
+
+      if (triangleCount > 0 && !vertices.empty())
+      {
+        RN_LOG("MeshCooker: optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", sourcePath, missesBefore / triangleCount, missesAfter / triangleCount,
+               missesBefore / vertices.size(), missesAfter / vertices.size());
+      }
+    }
+
+    // Appends coarser index ranges for every submesh, each level simplified from the one before
+    // to half its triangles. Stops early once a level is too small or barely shrinks.
+    void GenerateLods(const std::vector<VertexAttribute>& vertices, std::vector<uint32_t>& indices, std::vector<SubMesh>& subMeshes)
+    {
+      std::vector<uint32_t> lodIndices;
+      uint32_t lodCount = 0;
+
+      for (SubMesh& subMesh : subMeshes)
+      {
+        subMesh.Lods[0] = {subMesh.BaseIndex, subMesh.IndexCount, 0.0f};
+        subMesh.LodCount = 1;
+
+        const float radius = glm::length(subMesh.BoundingBox.GetExtents());
+        while (subMesh.LodCount < SubMesh::MaxLodCount && radius > 0.0f)
+        {
+          const SubMeshLod previous = subMesh.Lods[subMesh.LodCount - 1];
+          const size_t target = previous.IndexCount / 6 * 3;
+          if (target < kMinLodIndexCount)
+          {
+            break;
+          }
+
+          float error = 0.0f;
+          lodIndices.resize(previous.IndexCount);
+          const size_t count = MeshOptimizer::Simplify(indices.data() + previous.BaseIndex, previous.IndexCount, &vertices[subMesh.BaseVertex].Position, subMesh.VertexCount,
+                                                       sizeof(VertexAttribute), target, lodIndices.data(), error);
+          if (count == 0 || count > previous.IndexCount * 3 / 4)
+          {
+            break;
+          }
+
+          MeshOptimizer::OptimizeVertexCache(lodIndices.data(), count, subMesh.VertexCount);
+
+          // Errors add up over the chain, every level is measured against the one before
+          SubMeshLod& lod = subMesh.Lods[subMesh.LodCount++];
+          lod.BaseIndex = (uint32_t)indices.size();
+          lod.IndexCount = (uint32_t)count;
+          lod.Error = previous.Error + error / radius;
+          indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + count);
+          lodCount++;
+        }
+      }
+
+      if (lodCount > 0)
+      {
+        RN_LOG("MeshCooker: generated {} LOD levels over {} submeshes", lodCount, subMeshes.size());
+      }
+    }
+
+    // Octahedral mapping of a unit vector onto [-1, 1]^2
+    glm::vec2 OctEncode(glm::vec3 n)
+    {
+      n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+      if (n.z >= 0.0f)
+      {
+        return glm::vec2(n.x, n.y);
+      }
+      return glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+
+    void PackDirection(const glm::vec3& direction, const glm::vec3& fallback, int16_t* out)
+    {
+      const glm::vec2 encoded = OctEncode(glm::dot(direction, direction) > 1e-12f ? direction : fallback);
+      out[0] = (int16_t)glm::packSnorm1x16(encoded.x);
+      out[1] = (int16_t)glm::packSnorm1x16(encoded.y);
+    }
+
+    template <typename Vertex>
+    PackedVertex PackVertex(const Vertex& vertex, const SubMesh& subMesh)
+    {
+      PackedVertex packed;
+      const glm::vec3 unorm = (vertex.Position - subMesh.GetPositionOffset()) / subMesh.GetPositionScale();
+      for (int i = 0; i < 3; i++)
+      {
+        packed.Position[i] = glm::packUnorm1x16(unorm[i]);
+      }
+      packed.Position[3] = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? 0 : 65535;
+
+      PackDirection(vertex.Normal, glm::vec3(0.0f, 0.0f, 1.0f), packed.Normal);
+      PackDirection(vertex.Tangent, glm::vec3(1.0f, 0.0f, 0.0f), packed.Tangent);
+      packed.TexCoords[0] = glm::packHalf1x16(vertex.TexCoords.x);
+      packed.TexCoords[1] = glm::packHalf1x16(vertex.TexCoords.y);
+      return packed;
+    }
+
+    // Runs over the submesh ranges, packed positions are relative to the bounds of their submesh
+    template <typename Packed, typename Source, typename PackFn>
+    std::vector<Packed> PackStream(const std::vector<Source>& vertices, const std::vector<SubMesh>& subMeshes, PackFn pack)
+    {
+      std::vector<Packed> packed(vertices.size());
+      if (vertices.empty())
+      {
+        return packed;
+      }
+
+      for (const SubMesh& subMesh : subMeshes)
+      {
+        for (uint32_t i = subMesh.BaseVertex; i < subMesh.BaseVertex + subMesh.VertexCount; i++)
+        {
+          packed[i] = pack(vertices[i], subMesh);
+        }
+      }
+      return packed;
+    }
+
+    PackedSkeletalVertex PackSkeletalVertex(const SkeletalVertexAttribute& vertex, const SubMesh& subMesh)
+    {
+      PackedSkeletalVertex packed;
+      packed.Base = PackVertex(vertex, subMesh);
+
+      // Rounded weights lose up to a few units in total, the remainder goes to the heaviest bone
+      uint32_t total = 0;
+      int heaviest = 0;
+      for (int i = 0; i < 4; i++)
+      {
+        RN_ASSERT(vertex.BoneIndices[i] < kMaxPackedBones, "MeshCooker: bone index does not fit the packed vertex");
+        packed.BoneIndices[i] = (uint8_t)vertex.BoneIndices[i];
+        packed.BoneWeights[i] = glm::packUnorm1x16(vertex.BoneWeights[i]);
+        total += packed.BoneWeights[i];
+        heaviest = vertex.BoneWeights[i] > vertex.BoneWeights[heaviest] ? i : heaviest;
+      }
+      packed.BoneWeights[heaviest] = (uint16_t)std::clamp<int32_t>((int32_t)packed.BoneWeights[heaviest] + 65535 - (int32_t)total, 0, 65535);
+      return packed;
+    }
+
+    template <typename T>
+    void WriteStream(BlobWriter& writer, RMeshHeader& header, RMeshSectionType type, const std::vector<T>& items)
+    {
+      RMeshSection& section = header.Sections[(size_t)type];
+      writer.Align(16);
+      section.Offset = writer.Tell();
+      writer.WriteBytes(items.data(), items.size() * sizeof(T));
+      section.Size = writer.Tell() - section.Offset;
+    }
+
+    void BeginSection(BlobWriter& writer, RMeshHeader& header, RMeshSectionType type)
+    {
+      writer.Align(16);
+      header.Sections[(size_t)type].Offset = writer.Tell();
+    }
+
+    void EndSection(BlobWriter& writer, RMeshHeader& header, RMeshSectionType type)
+    {
+      RMeshSection& section = header.Sections[(size_t)type];
+      section.Size = writer.Tell() - section.Offset;
+    }
+
+    void WriteTextureDesc(BlobWriter& writer, const MaterialTextureDesc& desc)
+    {
+      writer.WriteString(desc.Name);
+      writer.WriteString(desc.Path);
+      writer.Write<uint32_t>(desc.Wrap);
+    }
+
+    MaterialTextureDesc ReadTextureDesc(BlobReader& reader)
+    {
+      MaterialTextureDesc desc;
+      desc.Name = reader.ReadString();
+      desc.Path = reader.ReadString();
+      desc.Wrap = (TextureWrappingFormat)reader.Read<uint32_t>();
+      return desc;
+    }
+
+    bool IsHeaderCompatible(const RMeshHeader& header)
+    {
+      return header.Magic == RMeshHeader::FileMagic && header.Version == RMeshHeader::CurrentVersion &&
+             header.VertexStride == sizeof(PackedVertex) && header.SkeletalVertexStride == sizeof(PackedSkeletalVertex);
+    }
+
+    bool IsRangeInside(uint64_t base, uint64_t count, uint64_t total)
+    {
+      return base + count <= total;
+    }
+
+    // Every range a draw or the scene hierarchy indexes with must lie inside the streams and
+    // lists of the same blob, otherwise a stale or foreign entry would draw out of bounds
+    bool ValidateRanges(const CookedMesh& mesh)
+    {
+      if (mesh.SkeletalVertexCount != 0 && mesh.SkeletalVertexCount != mesh.VertexCount)
+      {
+        return false;
+      }
+
+      for (const SubMesh& subMesh : mesh.SubMeshes)
+      {
+        if (!IsRangeInside(subMesh.BaseVertex, subMesh.VertexCount, mesh.VertexCount) ||
+            !IsRangeInside(subMesh.BaseIndex, subMesh.IndexCount, mesh.IndexCount) ||
+            subMesh.MaterialIndex >= mesh.Materials.size() ||
+            subMesh.LodCount == 0 || subMesh.LodCount > SubMesh::MaxLodCount)
+        {
+          return false;
+        }
+
+        for (uint32_t lod = 0; lod < subMesh.LodCount; lod++)
+        {
+          if (!IsRangeInside(subMesh.Lods[lod].BaseIndex, subMesh.Lods[lod].IndexCount, mesh.IndexCount))
+          {
+            return false;
+          }
+        }
+      }
+
+      // GetRootNode reads the first node, parents always precede their children
+      if (mesh.Nodes.empty())
+      {
+        return false;
+      }
+
+      for (size_t i = 0; i < mesh.Nodes.size(); i++)
+      {
+        const MeshNode& node = mesh.Nodes[i];
+        if (node.SubMeshId < 0 || (size_t)node.SubMeshId >= mesh.SubMeshes.size() || (!node.IsRoot() && node.Parent >= i))
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // External buffers of a .gltf are part of its content, the .gltf json alone only names them
+    void HashGltfBuffers(ContentHasher& hasher, const std::string& sourcePath, const uint8_t* json, size_t size)
+    {
+      const std::string_view text((const char*)json, size);
+      const std::filesystem::path directory = std::filesystem::path(sourcePath).parent_path();
+
+      for (size_t pos = text.find("\"uri\""); pos != std::string_view::npos; pos = text.find("\"uri\"", pos + 5))
+      {
+        const size_t begin = text.find('"', text.find(':', pos + 5));
+        const size_t end = begin == std::string_view::npos ? begin : text.find('"', begin + 1);
+        if (end == std::string_view::npos)
+        {
+          break;
+        }
+
+        const std::string uri(text.substr(begin + 1, end - begin - 1));
+        const std::string extension = std::filesystem::path(uri).extension().string();
+        if (uri.rfind("data:", 0) != 0 && extension == ".bin")
+        {
+          hasher.Update(uri);
+          hasher.UpdateFile((directory / uri).string());
+        }
+      }
+    }
+  }  // namespace
+
+  std::string MeshCooker::GetCacheKey(const std::string& sourcePath)
+  {
+    ContentHasher hasher;
+    hasher.UpdateValue(kImportFlags);
+    hasher.UpdateValue((uint32_t)sizeof(PackedVertex));
+    hasher.UpdateValue((uint32_t)sizeof(PackedSkeletalVertex));
+
+    MappedFile source;
+    if (source.Open(sourcePath))
+    {
+      hasher.Update(source.GetData(), source.GetSize());
+      if (FileSys::GetFileExtension(sourcePath) == "gltf")
+      {
+        HashGltfBuffers(hasher, sourcePath, source.GetData(), source.GetSize());
+      }
+    }
+
+    return DerivedDataCache::MakeKey("mesh", RMeshHeader::CurrentVersion, hasher.Finish());
+  }
+
+  bool MeshCooker::Cook(const std::string& sourcePath, std::vector<uint8_t>& outBlob)
+  {
+    Assimp::Importer import;
+    const aiScene* scene = import.ReadFile(sourcePath, kImportFlags);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+      RN_LOG_ERR("MeshCooker: failed to import {}: {}", sourcePath, import.GetErrorString());
+      return false;
+    }
+
+    std::vector<VertexAttribute> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<SubMesh> subMeshes;
+    ImportStreams(scene, vertices, indices, subMeshes);
+
+    std::vector<MaterialDesc> materials;
+    ImportMaterials(scene, materials);
+
+    std::vector<MeshNode> nodes;
+    ImportNodes(scene->mRootNode, nodes);
+
+    Skeleton skeleton;
+    std::vector<SkeletalVertexAttribute> skeletalVertices;
+    const bool hasSkeleton = ImportSkeleton(scene, skeleton, skeletalVertices);
+    // Packed bone indices are 8 bit, a bigger rig would skin to the wrong bones
+    if (skeleton.Bones.size() > kMaxPackedBones)
+    {
+      RN_LOG_ERR("MeshCooker: {} has {} bones, packed vertices index at most {}", sourcePath, skeleton.Bones.size(), kMaxPackedBones);
+      return false;
+    }
+
+    OptimizeStreams(sourcePath, vertices, skeletalVertices, indices, subMeshes);
+    GenerateLods(vertices, indices, subMeshes);
+
+    const std::vector<PackedVertex> packedVertices = PackStream<PackedVertex>(vertices, subMeshes, PackVertex<VertexAttribute>);
+    const std::vector<PackedSkeletalVertex> packedSkeletalVertices = PackStream<PackedSkeletalVertex>(skeletalVertices, subMeshes, PackSkeletalVertex);
+
+    RMeshHeader header;
+
+    BlobWriter writer(outBlob);
+    writer.Write(header);
+
+    WriteStream(writer, header, RMeshSectionType::Vertices, packedVertices);
+    WriteStream(writer, header, RMeshSectionType::SkeletalVertices, packedSkeletalVertices);
+    WriteStream(writer, header, RMeshSectionType::Indices, indices);
+    WriteStream(writer, header, RMeshSectionType::SubMeshes, subMeshes);
+
+    BeginSection(writer, header, RMeshSectionType::Nodes);
+    writer.Write<uint32_t>((uint32_t)nodes.size());
+    for (const MeshNode& node : nodes)
+    {
+      writer.Write<uint32_t>(node.Parent);
+      writer.Write<int32_t>(node.SubMeshId);
+      writer.WriteString(node.Name);
+      writer.Write(node.LocalTransform);
+    }
+    EndSection(writer, header, RMeshSectionType::Nodes);
+
+    BeginSection(writer, header, RMeshSectionType::Materials);
+    writer.Write<uint32_t>((uint32_t)materials.size());
+    for (const MaterialDesc& material : materials)
+    {
+      writer.WriteString(material.Name);
+      writer.Write(material.Metallic);
+      writer.Write(material.Roughness);
+      writer.Write(material.Ao);
+      WriteTextureDesc(writer, material.AlbedoTexture);
+      WriteTextureDesc(writer, material.NormalTexture);
+      WriteTextureDesc(writer, material.MetallicTexture);
+    }
+    EndSection(writer, header, RMeshSectionType::Materials);
+
+    if (hasSkeleton)
+    {
+      BeginSection(writer, header, RMeshSectionType::Skeleton);
+      writer.Write<uint32_t>((uint32_t)skeleton.Bones.size());
+      for (const Bone& bone : skeleton.Bones)
+      {
+        writer.WriteString(bone.Name);
+        writer.Write(bone.ParentIndex);
+        writer.Write(bone.InverseBindMatrix);
+        writer.Write(bone.LocalTransform);
+      }
+      EndSection(writer, header, RMeshSectionType::Skeleton);
+    }
+
+    // Animations are stored as ozz archives so loading skips the offline builders entirely
+    if (hasSkeleton && scene->mNumAnimations > 0)
+    {
+      if (Ref<OzzSkeleton> ozzSkeleton = OzzConverter::ConvertSkeleton(scene, skeleton))
+      {
+        BeginSection(writer, header, RMeshSectionType::Animation);
+        writer.WriteBlob(OzzArchive::Save(*ozzSkeleton->GetOzzSkeleton()));
+
+        const std::vector<glm::mat4>& inverseBindMatrices = ozzSkeleton->GetInverseBindMatrices();
+        writer.Write<uint32_t>((uint32_t)inverseBindMatrices.size());
+        writer.WriteBytes(inverseBindMatrices.data(), inverseBindMatrices.size() * sizeof(glm::mat4));
+
+        std::vector<std::vector<uint8_t>> animations;
+        for (uint32_t i = 0; i < scene->mNumAnimations; ++i)
+        {
+          if (Ref<OzzAnimation> animation = OzzConverter::ConvertAnimation(scene->mAnimations[i], *ozzSkeleton))
+          {
+            animations.push_back(OzzArchive::Save(*animation->GetOzzAnimation()));
+          }
+        }
+
+        writer.Write<uint32_t>((uint32_t)animations.size());
+        for (const auto& animation : animations)
+        {
+          writer.WriteBlob(animation);
+        }
+        EndSection(writer, header, RMeshSectionType::Animation);
+      }
+    }
+
+    writer.Overwrite(0, header);
+
+    RN_LOG("MeshCooker: cooked {} ({} vertices, {} indices, {} KB)", sourcePath, vertices.size(), indices.size(), outBlob.size() / 1024);
+    return true;
+  }
+
+  bool MeshCooker::Parse(const uint8_t* data, size_t size, CookedMesh& outMesh)
+  {
+    if (size < sizeof(RMeshHeader))
+    {
+      return false;
+    }
+
+    RMeshHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (!IsHeaderCompatible(header))
+    {
+      return false;
+    }
+
+    // Entries may come from another machine's cache, nothing in them is trusted
+    for (const RMeshSection& section : header.Sections)
+    {
+      if (section.Offset > size || section.Size > size - section.Offset)
+      {
+        return false;
+      }
+    }
+
+    auto sectionData = [&](RMeshSectionType type)
+    { return data + header.Sections[(size_t)type].Offset; };
+    auto sectionSize = [&](RMeshSectionType type)
+    { return header.Sections[(size_t)type].Size; };
+
+    outMesh.Vertices = (const PackedVertex*)sectionData(RMeshSectionType::Vertices);
+    outMesh.VertexCount = (uint32_t)(sectionSize(RMeshSectionType::Vertices) / sizeof(PackedVertex));
+    outMesh.SkeletalVertices = (const PackedSkeletalVertex*)sectionData(RMeshSectionType::SkeletalVertices);
+    outMesh.SkeletalVertexCount = (uint32_t)(sectionSize(RMeshSectionType::SkeletalVertices) / sizeof(PackedSkeletalVertex));
+    outMesh.Indices = (const uint32_t*)sectionData(RMeshSectionType::Indices);
+    outMesh.IndexCount = (uint32_t)(sectionSize(RMeshSectionType::Indices) / sizeof(uint32_t));
+
+    outMesh.SubMeshes.resize(sectionSize(RMeshSectionType::SubMeshes) / sizeof(SubMesh));
+    std::memcpy(outMesh.SubMeshes.data(), sectionData(RMeshSectionType::SubMeshes), outMesh.SubMeshes.size() * sizeof(SubMesh));
+
+    BlobReader nodeReader(sectionData(RMeshSectionType::Nodes), sectionSize(RMeshSectionType::Nodes));
+    outMesh.Nodes.resize(nodeReader.ReadCount(2 * sizeof(uint32_t) + sizeof(int32_t) + sizeof(glm::mat4)));
+    for (MeshNode& node : outMesh.Nodes)
+    {
+      node.Parent = nodeReader.Read<uint32_t>();
+      node.SubMeshId = nodeReader.Read<int32_t>();
+      node.Name = nodeReader.ReadString();
+      node.LocalTransform = nodeReader.Read<glm::mat4>();
+    }
+
+    BlobReader materialReader(sectionData(RMeshSectionType::Materials), sectionSize(RMeshSectionType::Materials));
+    outMesh.Materials.resize(materialReader.ReadCount(sizeof(uint32_t) + 3 * sizeof(float)));
+    for (MaterialDesc& material : outMesh.Materials)
+    {
+      material.Name = materialReader.ReadString();
+      material.Metallic = materialReader.Read<float>();
+      material.Roughness = materialReader.Read<float>();
+      material.Ao = materialReader.Read<float>();
+      material.AlbedoTexture = ReadTextureDesc(materialReader);
+      material.NormalTexture = ReadTextureDesc(materialReader);
+      material.MetallicTexture = ReadTextureDesc(materialReader);
+    }
+
+    if (!nodeReader.IsValid() || !materialReader.IsValid() || !ValidateRanges(outMesh))
+    {
+      return false;
+    }
+
+    if (sectionSize(RMeshSectionType::Skeleton) > 0)
+    {
+      BlobReader reader(sectionData(RMeshSectionType::Skeleton), sectionSize(RMeshSectionType::Skeleton));
+      outMesh.Rig = CreateRef<Skeleton>();
+      outMesh.Rig->Bones.resize(reader.ReadCount(sizeof(uint32_t) + sizeof(int32_t) + 2 * sizeof(glm::mat4)));
+      for (size_t i = 0; i < outMesh.Rig->Bones.size(); i++)
+      {
+        Bone& bone = outMesh.Rig->Bones[i];
+        bone.Name = reader.ReadString();
+        bone.ParentIndex = reader.Read<int32_t>();
+        bone.InverseBindMatrix = reader.Read<glm::mat4>();
+        bone.LocalTransform = reader.Read<glm::mat4>();
+        outMesh.Rig->BoneNameToIndex[bone.Name] = (uint32_t)i;
+      }
+
+      if (!reader.IsValid() || outMesh.Rig->Bones.size() > kMaxPackedBones)
+      {
+        return false;
+      }
+
+      for (const Bone& bone : outMesh.Rig->Bones)
+      {
+        if (bone.ParentIndex < -1 || bone.ParentIndex >= (int32_t)outMesh.Rig->Bones.size())
+        {
+          return false;
+        }
+      }
+
+      outMesh.Rig->ComputeBoneMatrices();
+    }
+
+    if (sectionSize(RMeshSectionType::Animation) > 0)
+    {
+      BlobReader reader(sectionData(RMeshSectionType::Animation), sectionSize(RMeshSectionType::Animation));
+
+      auto [skeletonData, skeletonSize] = reader.ReadBlob();
+      const uint32_t inverseBindCount = reader.Read<uint32_t>();
+      const uint8_t* inverseBindData = reader.ReadBytes(inverseBindCount * sizeof(glm::mat4));
+      if (!reader.IsValid())
+      {
+        return false;
+      }
+
+      auto skeleton = OzzArchive::Load<ozz::animation::Skeleton>(skeletonData, skeletonSize);
+      if (!skeleton)
+      {
+        return false;
+      }
+
+      outMesh.OzzRig = CreateRef<OzzSkeleton>();
+      outMesh.OzzRig->SetSkeleton(std::move(skeleton));
+
+      std::vector<glm::mat4> inverseBindMatrices(inverseBindCount);
+      std::memcpy(inverseBindMatrices.data(), inverseBindData, inverseBindCount * sizeof(glm::mat4));
+      outMesh.OzzRig->SetInverseBindMatrices(std::move(inverseBindMatrices));
+
+      const uint32_t animationCount = reader.Read<uint32_t>();
+      for (uint32_t i = 0; i < animationCount && reader.IsValid(); i++)
+      {
+        auto [animationData, animationSize] = reader.ReadBlob();
+        if (auto animation = OzzArchive::Load<ozz::animation::Animation>(animationData, animationSize))
+        {
+          auto ozzAnimation = CreateRef<OzzAnimation>();
+          ozzAnimation->SetAnimation(std::move(animation));
+          outMesh.Animations.push_back(ozzAnimation);
+        }
+      }
+    }
+
+    return true;
+  }
+}  // namespace Rain
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render/Mesh.h"
+#include "render/Sampler.h"
+
+namespace Rain
+{
+  enum class RMeshSectionType : uint32_t
+  {
+    Vertices = 0,
+    SkeletalVertices,
+    Indices,
+    SubMeshes,
+    Nodes,
+    Materials,
+    Skeleton,
+    Animation,
+    Count
+  };
+
+  struct RMeshSection
+  {
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+  };
+
+  // Cooked mesh layout: this header followed by the sections it indexes. Stream sections are
+  // stored in their GPU layout (PackedVertex, PackedSkeletalVertex) and 16-byte aligned, so they
+  // upload straight from the mapped entry.
+  struct RMeshHeader
+  {
+    static constexpr uint32_t FileMagic = 0x48534D52;  // "RMSH"
+    static constexpr uint32_t CurrentVersion = 5;
+
+    uint32_t Magic = FileMagic;
+    uint32_t Version = CurrentVersion;
+    uint32_t VertexStride = sizeof(PackedVertex);
+    uint32_t SkeletalVertexStride = sizeof(PackedSkeletalVertex);
+    uint32_t Reserved = 0;
+    RMeshSection Sections[(size_t)RMeshSectionType::Count];
+  };
+
+  struct MaterialTextureDesc
+  {
+    std::string Name;
+    std::string Path;  // Relative to the mesh source directory
+    TextureWrappingFormat Wrap = TextureWrappingFormat::Repeat;
+
+    bool IsValid() const { return !Path.empty(); }
+  };
+
+  struct MaterialDesc
+  {
+    std::string Name;
+    float Metallic = 0.0f;
+    float Roughness = 0.8f;
+    float Ao = 0.5f;
+
+    MaterialTextureDesc AlbedoTexture;
+    MaterialTextureDesc NormalTexture;
+    MaterialTextureDesc MetallicTexture;
+  };
+
+  // Parsed cooked mesh. Stream pointers alias the blob, which must outlive this view.
+  struct CookedMesh
+  {
+    const PackedVertex* Vertices = nullptr;
+    uint32_t VertexCount = 0;
+    const PackedSkeletalVertex* SkeletalVertices = nullptr;
+    uint32_t SkeletalVertexCount = 0;
+    const uint32_t* Indices = nullptr;
+    uint32_t IndexCount = 0;
+
+    std::vector<SubMesh> SubMeshes;
+    std::vector<MeshNode> Nodes;
+    std::vector<MaterialDesc> Materials;
+
+    Ref<Skeleton> Rig;
+    Ref<OzzSkeleton> OzzRig;
+    std::vector<Ref<OzzAnimation>> Animations;
+  };
+
+  // Offline import of Assimp sources into cooked blobs, and the runtime parser for them. Cooking
+  // reorders every submesh with MeshOptimizer and appends its simplified LOD index ranges, so
+  // the cached blob carries both.
+  // Blobs are stored in the DerivedDataCache under GetCacheKey.
+  class MeshCooker
+  {
+   public:
+    // Covers the source bytes, external glTF buffers, import flags and the blob version
+    static std::string GetCacheKey(const std::string& sourcePath);
+
+    static bool Cook(const std::string& sourcePath, std::vector<uint8_t>& outBlob);
+
+    static bool Parse(const uint8_t* data, size_t size, CookedMesh& outMesh);
+  };
+}  // namespace Rain
@@ -0,0 +1,556 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Rain
+{
+  namespace
+  {
+    // Per-vertex triangle lists, the input of Tipsify
+    struct TriangleAdjacency
+    {
+      std::vector<uint32_t> Counts;
+      std::vector<uint32_t> Offsets;
+      std::vector<uint32_t> Triangles;
+
+      TriangleAdjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+          : Counts(vertexCount, 0), Offsets(vertexCount + 1, 0), Triangles(indexCount)
+      {
+        for (size_t i = 0; i < indexCount; i++)
+        {
+          Counts[indices[i]]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+          Offsets[v + 1] = Offsets[v] + Counts[v];
+        }
+
+        std::vector<uint32_t> cursor(Offsets.begin(), Offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+          Triangles[cursor[indices[i]]++] = (uint32_t)(i / 3);
+        }
+      }
+    };
+
+    // FIFO cache by insertion time, a vertex is resident while fewer than cacheSize others came after it
+    struct CacheSimulator
+    {
+      std::vector<uint32_t> InsertTime;
+      uint32_t Time;
+      uint32_t Size;
+
+      CacheSimulator(size_t vertexCount, uint32_t cacheSize)
+          : InsertTime(vertexCount, 0), Time(cacheSize + 1), Size(cacheSize) {}
+
+      bool IsResident(uint32_t vertex) const { return Time - InsertTime[vertex] <= Size; }
+
+      // Returns true on a miss
+      bool Access(uint32_t vertex)
+      {
+        if (IsResident(vertex))
+        {
+          return false;
+        }
+        InsertTime[vertex] = Time++;
+        return true;
+      }
+    };
+
+    const glm::vec3& GetPosition(const glm::vec3* positions, size_t stride, uint32_t vertex)
+    {
+      return *(const glm::vec3*)((const uint8_t*)positions + vertex * stride);
+    }
+
+    // Sum of squared distances to a set of planes, weighted by triangle area
+    struct Quadric
+    {
+      double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+      double B0 = 0, B1 = 0, B2 = 0;
+      double C = 0;
+      double Weight = 0;
+
+      void AddPlane(const glm::dvec3& n, double d, double weight)
+      {
+        A00 += weight * n.x * n.x;
+        A01 += weight * n.x * n.y;
+        A02 += weight * n.x * n.z;
+        A11 += weight * n.y * n.y;
+        A12 += weight * n.y * n.z;
+        A22 += weight * n.z * n.z;
+        B0 += weight * n.x * d;
+        B1 += weight * n.y * d;
+        B2 += weight * n.z * d;
+        C += weight * d * d;
+        Weight += weight;
+      }
+
+      void Add(const Quadric& other)
+      {
+        A00 += other.A00;
+        A01 += other.A01;
+        A02 += other.A02;
+        A11 += other.A11;
+        A12 += other.A12;
+        A22 += other.A22;
+        B0 += other.B0;
+        B1 += other.B1;
+        B2 += other.B2;
+        C += other.C;
+        Weight += other.Weight;
+      }
+
+      // Mean squared distance of p to the planes
+      double Evaluate(const glm::vec3& p) const
+      {
+        const double x = p.x, y = p.y, z = p.z;
+        const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) + 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+        return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+      }
+    };
+
+    struct PositionHash
+    {
+      size_t operator()(const glm::vec3& p) const
+      {
+        uint32_t bits[3];
+        std::memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+      }
+    };
+
+    struct Collapse
+    {
+      uint32_t From;
+      uint32_t To;
+      float Cost;
+    };
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+      return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    }
+  }  // namespace
+
+  VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+  {
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0)
+    {
+      return stats;
+    }
+
+    CacheSimulator cache(vertexCount, cacheSize);
+    uint32_t misses = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      misses += cache.Access(indices[i]);
+    }
+
+    stats.ACMR = (float)misses / (float)(indexCount / 3);
+    stats.ATVR = (float)misses / (float)vertexCount;
+    return stats;
+  }
+
+  void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+  {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+      return;
+    }
+
+    TriangleAdjacency adjacency(indices, indexCount, vertexCount);
+    std::vector<uint32_t>& liveTriangles = adjacency.Counts;
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    std::vector<uint32_t> output;
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    output.reserve(indexCount);
+    deadEnd.reserve(indexCount);
+
+    uint32_t time = cacheSize + 1;
+    uint32_t cursor = 0;
+    int64_t fanning = indices[0];
+
+    while (fanning >= 0)
+    {
+      // Emit every remaining triangle around the fanning vertex
+      candidates.clear();
+      for (uint32_t k = adjacency.Offsets[fanning]; k < adjacency.Offsets[fanning + 1]; k++)
+      {
+        const uint32_t triangle = adjacency.Triangles[k];
+        if (emitted[triangle])
+        {
+          continue;
+        }
+
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+          const uint32_t vertex = indices[triangle * 3 + corner];
+          output.push_back(vertex);
+          deadEnd.push_back(vertex);
+          candidates.push_back(vertex);
+          liveTriangles[vertex]--;
+
+          if (time - cacheTime[vertex] > cacheSize)
+          {
+            cacheTime[vertex] = time++;
+          }
+        }
+        emitted[triangle] = 1;
+      }
+
+      // Next fan: the oldest candidate that stays resident while its own fan is emitted
+      fanning = -1;
+      int64_t bestPriority = -1;
+      for (uint32_t vertex : candidates)
+      {
+        if (liveTriangles[vertex] == 0)
+        {
+          continue;
+        }
+
+        int64_t priority = 0;
+        if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+        {
+          priority = time - cacheTime[vertex];
+        }
+        if (priority > bestPriority)
+        {
+          bestPriority = priority;
+          fanning = vertex;
+        }
+      }
+
+      // Dead end: the most recently used vertex with work left, then input order
+      while (fanning < 0 && !deadEnd.empty())
+      {
+        const uint32_t vertex = deadEnd.back();
+        deadEnd.pop_back();
+        if (liveTriangles[vertex] > 0)
+        {
+          fanning = vertex;
+        }
+      }
+
+      while (fanning < 0 && cursor < vertexCount)
+      {
+        if (liveTriangles[cursor] > 0)
+        {
+          fanning = cursor;
+        }
+        cursor++;
+      }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+  }
+
+  void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t positionStride, uint32_t cacheSize)
+  {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+      return;
+    }
+
+    // Triangles that miss on all three vertices follow a cache flush, splitting there keeps the cache order inside clusters
+    std::vector<uint32_t> clusterStarts;
+    CacheSimulator cache(vertexCount, cacheSize);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+      uint32_t misses = 0;
+      for (uint32_t corner = 0; corner < 3; corner++)
+      {
+        misses += cache.Access(indices[t * 3 + corner]);
+      }
+
+      if (t == 0 || misses == 3)
+      {
+        clusterStarts.push_back((uint32_t)t);
+      }
+    }
+    clusterStarts.push_back((uint32_t)triangleCount);
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    if (clusterCount < 2)
+    {
+      return;
+    }
+
+    // Area weighted centroid and normal of every cluster and of the whole mesh
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+      float clusterArea = 0.0f;
+      for (uint32_t t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++)
+      {
+        const glm::vec3& p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+        const glm::vec3& p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+        const glm::vec3& p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+
+        const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float area = glm::length(normal);
+        clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+        clusterNormals[cluster] += normal;
+        clusterArea += area;
+      }
+
+      meshCentroid += clusterCentroids[cluster];
+      meshArea += clusterArea;
+      clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : GetPosition(positions, positionStride, indices[clusterStarts[cluster] * 3]);
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+    // Clusters far out along their own normal are likely to occlude the rest, they go first
+    struct ClusterKey
+    {
+      float Key;
+      uint32_t Cluster;
+    };
+
+    std::vector<ClusterKey> order(clusterCount);
+    for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+      const float normalLength = glm::length(clusterNormals[cluster]);
+      const float key = normalLength > 0.0f ? glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster] / normalLength) : 0.0f;
+      order[cluster] = {key, cluster};
+    }
+    std::stable_sort(order.begin(), order.end(), [](const ClusterKey& a, const ClusterKey& b)
+                     { return a.Key > b.Key; });
+
+    std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+    uint32_t* out = indices;
+    for (const ClusterKey& entry : order)
+    {
+      const uint32_t begin = clusterStarts[entry.Cluster] * 3;
+      const uint32_t end = clusterStarts[entry.Cluster + 1] * 3;
+      out = std::copy(source.begin() + begin, source.begin() + end, out);
+    }
+  }
+
+  size_t MeshOptimizer::Simplify(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t positionStride, size_t targetIndexCount,
+                                 uint32_t* outIndices, float& outError)
+  {
+    outError = 0.0f;
+    std::vector<uint32_t> result(indices, indices + indexCount);
+    auto position = [&](uint32_t vertex) -> const glm::vec3&
+    { return GetPosition(positions, positionStride, vertex); };
+
+    // Vertices that share a position are one point of the surface, split only by their attributes
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<uint32_t> wedgeCount(vertexCount, 0);
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> positionIds;
+    positionIds.reserve(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+      canonical[v] = positionIds.emplace(position(v), v).first->second;
+    }
+
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    for (uint32_t index : result)
+    {
+      if (!referenced[index])
+      {
+        referenced[index] = 1;
+        wedgeCount[canonical[index]]++;
+      }
+    }
+
+    // Seams, open borders and non-manifold edges are locked
+    std::vector<uint8_t> locked(vertexCount, 0);
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    edgeUses.reserve(indexCount);
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+      for (uint32_t e = 0; e < 3; e++)
+      {
+        edgeUses[EdgeKey(canonical[result[i + e]], canonical[result[i + (e + 1) % 3]])]++;
+      }
+    }
+    for (const auto& [key, uses] : edgeUses)
+    {
+      if (uses != 2)
+      {
+        locked[(uint32_t)(key >> 32)] = 1;
+        locked[(uint32_t)key] = 1;
+      }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+      const glm::dvec3 p0 = position(result[i]);
+      const glm::dvec3 p1 = position(result[i + 1]);
+      const glm::dvec3 p2 = position(result[i + 2]);
+      const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+      const double area = glm::length(normal);
+      if (area > 0.0)
+      {
+        const glm::dvec3 n = normal / area;
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+          quadrics[canonical[result[i + corner]]].AddPlane(n, -glm::dot(n, p0), area);
+        }
+      }
+    }
+
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+      locked[v] = locked[canonical[v]] || wedgeCount[canonical[v]] > 1;
+    }
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTarget(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    double maxCost = 0.0;
+
+    // Each pass collapses the cheapest independent edges, until the target or no edge is left
+    while (result.size() > targetIndexCount)
+    {
+      TriangleAdjacency adjacency(result.data(), result.size(), vertexCount);
+
+      collapses.clear();
+      for (size_t i = 0; i < result.size(); i += 3)
+      {
+        for (uint32_t e = 0; e < 3; e++)
+        {
+          const uint32_t a = result[i + e];
+          const uint32_t b = result[i + (e + 1) % 3];
+          if (!locked[a])
+          {
+            collapses.push_back({a, b, (float)quadrics[canonical[a]].Evaluate(position(b))});
+          }
+          if (!locked[b])
+          {
+            collapses.push_back({b, a, (float)quadrics[canonical[b]].Evaluate(position(a))});
+          }
+        }
+      }
+
+      std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+                { return a.Cost < b.Cost; });
+
+      for (uint32_t v = 0; v < vertexCount; v++)
+      {
+        collapseTarget[v] = v;
+      }
+      std::fill(touched.begin(), touched.end(), 0);
+
+      const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+      size_t removed = 0;
+      for (const Collapse& collapse : collapses)
+      {
+        if (removed >= trianglesToRemove)
+        {
+          break;
+        }
+        if (touched[collapse.From] || touched[collapse.To])
+        {
+          continue;
+        }
+
+        // Moving From onto To must not flip any triangle that survives the collapse
+        const glm::vec3& target = position(collapse.To);
+        bool flips = false;
+        size_t collapsedTriangles = 0;
+        for (uint32_t k = adjacency.Offsets[collapse.From]; k < adjacency.Offsets[collapse.From + 1] && !flips; k++)
+        {
+          const uint32_t* triangle = &result[adjacency.Triangles[k] * 3];
+          if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+          {
+            collapsedTriangles++;
+            continue;
+          }
+
+          glm::vec3 before[3], after[3];
+          for (uint32_t corner = 0; corner < 3; corner++)
+          {
+            before[corner] = position(triangle[corner]);
+            after[corner] = triangle[corner] == collapse.From ? target : before[corner];
+          }
+          const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+          const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+          // Rotations close to 90 degrees leave slivers standing on edge, they count as flips too
+          flips = glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter);
+        }
+
+        if (flips)
+        {
+          continue;
+        }
+
+        // The one-ring of From is frozen for the rest of the pass, its flip checks used these positions
+        for (uint32_t k = adjacency.Offsets[collapse.From]; k < adjacency.Offsets[collapse.From + 1]; k++)
+        {
+          const uint32_t* triangle = &result[adjacency.Triangles[k] * 3];
+          touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+        }
+        touched[collapse.To] = 1;
+
+        collapseTarget[collapse.From] = collapse.To;
+        quadrics[canonical[collapse.To]].Add(quadrics[canonical[collapse.From]]);
+        maxCost = std::max(maxCost, (double)collapse.Cost);
+        removed += collapsedTriangles;
+      }
+
+      if (removed == 0)
+      {
+        break;
+      }
+
+      // Remap and drop the triangles that became degenerate
+      size_t write = 0;
+      for (size_t i = 0; i < result.size(); i += 3)
+      {
+        const uint32_t a = collapseTarget[result[i]];
+        const uint32_t b = collapseTarget[result[i + 1]];
+        const uint32_t c = collapseTarget[result[i + 2]];
+        if (a != b && b != c && a != c)
+        {
+          result[write++] = a;
+          result[write++] = b;
+          result[write++] = c;
+        }
+      }
+      result.resize(write);
+    }
+
+    outError = (float)std::sqrt(maxCost);
+    std::copy(result.begin(), result.end(), outIndices);
+    return result.size();
+  }
+
+  void MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& outRemap)
+  {
+    outRemap.assign(vertexCount, UINT32_MAX);
+
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+      uint32_t& target = outRemap[indices[i]];
+      if (target == UINT32_MAX)
+      {
+        target = next++;
+      }
+      indices[i] = target;
+    }
+
+    for (uint32_t& target : outRemap)
+    {
+      if (target == UINT32_MAX)
+      {
+        target = next++;
+      }
+    }
+  }
+}  // namespace Rain
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Rain
+{
+  // Post-transform cache efficiency of an index buffer, simulated with a FIFO cache
+  struct VertexCacheStats
+  {
+    float ACMR = 0.0f;  // Average cache miss ratio, transformed vertices per triangle (0.5 is ideal)
+    float ATVR = 0.0f;  // Average transformed vertex ratio, transformed vertices per vertex (1.0 is ideal)
+  };
+
+  // Import-time index and vertex processing, after the meshoptimizer pipeline: Tipsify for the
+  // post-transform cache, cluster sorting for overdraw, first-use order for vertex fetch and
+  // index-only simplification for LODs. Works on one submesh at a time with indices relative to
+  // its first vertex, CPU only.
+  class MeshOptimizer
+  {
+   public:
+    static constexpr uint32_t CacheSize = 16;
+
+    static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = CacheSize);
+
+    // Tipsify (Sander et al. 2007), reorders triangles in place
+    static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = CacheSize);
+
+    // Splits the cache-optimized order where the cache runs cold and sorts those clusters so
+    // outward-facing ones draw first. positionStride is the byte distance between positions.
+    static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t positionStride, uint32_t cacheSize = CacheSize);
+
+    // Quadric error metric edge collapse (Garland and Heckbert) onto existing vertices, so the
+    // result indexes the same vertex buffer. Vertices on open borders and attribute seams stay
+    // put. Returns the new index count, at most indexCount; outError is the RMS distance of the
+    // collapsed vertices from their original planes, in position units.
+    static size_t Simplify(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t vertexCount, size_t positionStride, size_t targetIndexCount,
+                           uint32_t* outIndices, float& outError);
+
+    // Renumbers vertices in first-use order and rewrites the indices. outRemap maps old to new,
+    // unreferenced vertices go last in their original order.
+    static void OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& outRemap);
+
+    template <typename T>
+    static void RemapVertices(T* vertices, size_t vertexCount, const std::vector<uint32_t>& remap)
+    {
+      std::vector<T> source(vertices, vertices + vertexCount);
+      for (size_t i = 0; i < vertexCount; i++)
+      {
+        vertices[remap[i]] = source[i];
+      }
+    }
+  };
+}  // namespace Rain
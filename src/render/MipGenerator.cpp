@@ -0,0 +1,189 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "core/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define RN_MIP_SSE 1
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define RN_MIP_WASM 1
+#endif
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint32_t kRowsPerJob = 16;
+    constexpr uint32_t kEncodeTableSize = 4096;
+
+#if defined(RN_MIP_SSE)
+    using Texel = __m128;
+    inline Texel LoadTexel(const float* p) { return _mm_loadu_ps(p); }
+    inline void StoreTexel(float* p, Texel t) { _mm_storeu_ps(p, t); }
+    inline Texel Average(Texel a, Texel b, Texel c, Texel d)
+    {
+      return _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), _mm_set1_ps(0.25f));
+    }
+#elif defined(RN_MIP_WASM)
+    using Texel = v128_t;
+    inline Texel LoadTexel(const float* p) { return wasm_v128_load(p); }
+    inline void StoreTexel(float* p, Texel t) { wasm_v128_store(p, t); }
+    inline Texel Average(Texel a, Texel b, Texel c, Texel d)
+    {
+      return wasm_f32x4_mul(wasm_f32x4_add(wasm_f32x4_add(a, b), wasm_f32x4_add(c, d)), wasm_f32x4_splat(0.25f));
+    }
+#else
+    struct Texel
+    {
+      float V[4];
+    };
+    inline Texel LoadTexel(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    inline void StoreTexel(float* p, Texel t) { std::copy(t.V, t.V + 4, p); }
+    inline Texel Average(Texel a, Texel b, Texel c, Texel d)
+    {
+      Texel r;
+      for (int i = 0; i < 4; i++)
+      {
+        r.V[i] = (a.V[i] + b.V[i] + c.V[i] + d.V[i]) * 0.25f;
+      }
+      return r;
+    }
+#endif
+
+    // Lookup tables for the 8-bit decode and the sRGB encode, built once
+    struct ColorTables
+    {
+      float SrgbToLinear[256];
+      float UnormToFloat[256];
+      uint8_t LinearToSrgb[kEncodeTableSize + 1];
+
+      ColorTables()
+      {
+        for (int i = 0; i < 256; i++)
+        {
+          const float c = i / 255.0f;
+          SrgbToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+          UnormToFloat[i] = c;
+        }
+        for (uint32_t i = 0; i <= kEncodeTableSize; i++)
+        {
+          const float l = (float)i / kEncodeTableSize;
+          const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+          LinearToSrgb[i] = (uint8_t)std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f);
+        }
+      }
+    };
+
+    const ColorTables& GetColorTables()
+    {
+      static const ColorTables tables;
+      return tables;
+    }
+
+    void DecodeRow(const uint8_t* src, uint32_t width, MipFilter filter, float* dst)
+    {
+      const ColorTables& tables = GetColorTables();
+      const float* rgbTable = filter == MipFilter::SRGB ? tables.SrgbToLinear : tables.UnormToFloat;
+      for (uint32_t i = 0; i < width * 4; i += 4)
+      {
+        dst[i + 0] = rgbTable[src[i + 0]];
+        dst[i + 1] = rgbTable[src[i + 1]];
+        dst[i + 2] = rgbTable[src[i + 2]];
+        dst[i + 3] = tables.UnormToFloat[src[i + 3]];
+      }
+    }
+
+    inline uint8_t EncodeUnorm(float value)
+    {
+      return (uint8_t)(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    void EncodeTexel(const float* texel, MipFilter filter, uint8_t* dst)
+    {
+      if (filter == MipFilter::SRGB)
+      {
+        const ColorTables& tables = GetColorTables();
+        for (int c = 0; c < 3; c++)
+        {
+          dst[c] = tables.LinearToSrgb[(uint32_t)(std::clamp(texel[c], 0.0f, 1.0f) * kEncodeTableSize + 0.5f)];
+        }
+        dst[3] = EncodeUnorm(texel[3]);
+        return;
+      }
+
+      if (filter == MipFilter::Normal)
+      {
+        // Averaged normals shorten, push them back onto the unit sphere
+        float n[3] = {texel[0] * 2.0f - 1.0f, texel[1] * 2.0f - 1.0f, texel[2] * 2.0f - 1.0f};
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 1e-5f)
+        {
+          for (int c = 0; c < 3; c++)
+          {
+            dst[c] = EncodeUnorm(n[c] / length * 0.5f + 0.5f);
+          }
+          dst[3] = EncodeUnorm(texel[3]);
+          return;
+        }
+      }
+
+      for (int c = 0; c < 4; c++)
+      {
+        dst[c] = EncodeUnorm(texel[c]);
+      }
+    }
+
+    // Averages two float rows into one output row of half the width
+    void AverageRows(const float* row0, const float* row1, uint32_t width, uint32_t dstWidth, float* dst)
+    {
+      for (uint32_t x = 0; x < dstWidth; x++)
+      {
+        const uint32_t x0 = std::min(x * 2, width - 1) * 4;
+        const uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+        StoreTexel(dst + x * 4, Average(LoadTexel(row0 + x0), LoadTexel(row0 + x1), LoadTexel(row1 + x0), LoadTexel(row1 + x1)));
+      }
+    }
+  }  // namespace
+
+  void MipGenerator::DownsampleRGBA8(const uint8_t* src, uint32_t width, uint32_t height, MipFilter filter, uint8_t* dst)
+  {
+    const uint32_t dstWidth = GetLevelSize(width, 1);
+    const uint32_t dstHeight = GetLevelSize(height, 1);
+
+    JobSystem::ParallelFor(dstHeight, kRowsPerJob, [=](uint32_t begin, uint32_t end)
+                           {
+      std::vector<float> row0(width * 4), row1(width * 4), averaged(dstWidth * 4);
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        DecodeRow(src + (size_t)y0 * width * 4, width, filter, row0.data());
+        DecodeRow(src + (size_t)y1 * width * 4, width, filter, row1.data());
+        AverageRows(row0.data(), row1.data(), width, dstWidth, averaged.data());
+
+        uint8_t* out = dst + (size_t)y * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; x++)
+        {
+          EncodeTexel(&averaged[x * 4], filter, out + x * 4);
+        }
+      } });
+  }
+
+  void MipGenerator::DownsampleRGBA32F(const float* src, uint32_t width, uint32_t height, float* dst)
+  {
+    const uint32_t dstWidth = GetLevelSize(width, 1);
+    const uint32_t dstHeight = GetLevelSize(height, 1);
+
+    JobSystem::ParallelFor(dstHeight, kRowsPerJob, [=](uint32_t begin, uint32_t end)
+                           {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const float* row0 = src + (size_t)std::min(y * 2, height - 1) * width * 4;
+        const float* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+        AverageRows(row0, row1, width, dstWidth, dst + (size_t)y * dstWidth * 4);
+      } });
+  }
+}  // namespace Rain
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace Rain
+{
+  // How texels are averaged when a level is halved
+  enum class MipFilter
+  {
+    Linear,  // Data textures (masks, roughness), averaged as stored
+    SRGB,    // Color, averaged in linear space and re-encoded
+    Normal   // Tangent-space normals, averaged and renormalized
+  };
+
+  // CPU mip generation for the texture cook path. Each call halves one level with a 2x2 box
+  // filter, odd edges reuse the last texel. Rows are spread over the JobSystem and texels are
+  // averaged four channels at a time with SSE2 or WASM SIMD where available.
+  class MipGenerator
+  {
+   public:
+    static void DownsampleRGBA8(const uint8_t* src, uint32_t width, uint32_t height, MipFilter filter, uint8_t* dst);
+    static void DownsampleRGBA32F(const float* src, uint32_t width, uint32_t height, float* dst);
+
+    static uint32_t GetLevelSize(uint32_t size, uint32_t level) { return (size >> level) > 0 ? (size >> level) : 1; }
+  };
+}  // namespace Rain
@@ -32,6 +32,14 @@ namespace Rain
         return WGPUVertexFormat_Uint32x3;
       case ShaderDataType::Int4:
         return WGPUVertexFormat_Uint32x4;
+      case ShaderDataType::Half2:
+        return WGPUVertexFormat_Float16x2;
+      case ShaderDataType::Snorm16x2:
+        return WGPUVertexFormat_Snorm16x2;
+      case ShaderDataType::Unorm16x4:
+        return WGPUVertexFormat_Unorm16x4;
+      case ShaderDataType::Uint8x4:
+        return WGPUVertexFormat_Uint8x4;
       case ShaderDataType::Bool:
         RN_CORE_ASSERT("Vertex format cannot be boolean");
       case ShaderDataType::None:
@@ -7,6 +7,7 @@ namespace Rain
   {
     std::vector<RenderPipeline*> Pipelines;
     std::vector<Material*> Materials;
+    std::vector<std::function<void()>> Callbacks;
   };
 
   Render* Render::m_RenderInstance = nullptr;
@@ -23,6 +24,11 @@ namespace Rain
     s_ShaderDependencies[shader->GetName()].Pipelines.push_back(material);
   }
 
+  void Render::RegisterShaderDependency(Ref<Shader> shader, std::function<void()> onReload)
+  {
+    s_ShaderDependencies[shader->GetName()].Callbacks.push_back(std::move(onReload));
+  }
+
   void Render::ReloadShader(Ref<Shader> shader)
   {
     auto dependencies = s_ShaderDependencies[shader->GetName()];
@@ -35,5 +41,10 @@ namespace Rain
     {
       pipeline->Invalidate();
     }
+
+    for (auto& callback : dependencies.Callbacks)
+    {
+      callback();
+    }
   }
 }  // namespace Rain
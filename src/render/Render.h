@@ -34,21 +34,26 @@ namespace Rain
     virtual void BeginRenderPass(Ref<RenderPass> pass, Ref<CommandBuffer> encoder) = 0;
     virtual void EndRenderPass(Ref<RenderPass> pass) = 0;
 
+    // transformBuffer is bound whole and instances start at firstInstance, so consecutive
+    // batches from one instance buffer keep the same vertex buffer binding
     virtual void RenderMesh(Ref<RenderPass> renderCommandBuffer,
                             WGPURenderPipeline pipeline,
                             Ref<MeshSource> mesh,
                             uint32_t submeshIndex,
+                            uint32_t lod,
                             Ref<MaterialTable> material,
                             Ref<GPUBuffer> transformBuffer,
-                            uint32_t transformOffset,
+                            uint32_t firstInstance,
                             uint32_t instanceCount) = 0;
 
     virtual void RenderSkeletalMesh(Ref<RenderPass> renderCommandBuffer,
                                     WGPURenderPipeline pipeline,
                                     Ref<MeshSource> mesh,
                                     uint32_t submeshIndex,
+                                    uint32_t lod,
                                     Ref<MaterialTable> materialTable,
                                     Ref<GPUBuffer> transformBuffer,
+                                    uint32_t firstInstance,
                                     uint32_t instanceCount) = 0;
 
     virtual void SubmitFullscreenQuad(Ref<RenderPass> renderCommandBuffer, WGPURenderPipeline pipeline) = 0;
@@ -67,6 +72,8 @@ namespace Rain
 
     static void RegisterShaderDependency(Ref<Shader> shader, Material* material);
     static void RegisterShaderDependency(Ref<Shader> shader, RenderPipeline* material);
+    // For objects that cache something built from the shader outside of a RenderPipeline
+    static void RegisterShaderDependency(Ref<Shader> shader, std::function<void()> onReload);
     static void ReloadShaders();
     static void ReloadShader(Ref<Shader> shader);
 
@@ -13,6 +13,7 @@ namespace Rain
     static WGPUDevice& GetDevice() { return *Instance().m_Device; }
     static Ref<WGPUQueue> GetQueue() { return Instance().m_Queue; }
     static RenderContext& Instance() { return *m_Instance; };
+    static bool HasFeature(WGPUFeatureName feature) { return IsReady() && wgpuDeviceHasFeature(GetDevice(), feature); }
 
     RenderContext() = default;
     RenderContext(WGPUAdapter adapter, WGPUDevice device, WGPUQueue queue)
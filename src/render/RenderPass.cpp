@@ -34,4 +34,66 @@ namespace Rain {
   void RenderPass::Prepare() {
     m_PassBinds->InvalidateAndUpdate();
   }
+
+  void RenderPass::SetRenderPassEncoder(WGPURenderPassEncoder encoder) {
+    m_Encoder = encoder;
+
+    m_BoundPipeline = nullptr;
+    for (BoundBuffer& bound : m_BoundVertexBuffers) {
+      bound = BoundBuffer();
+    }
+    m_BoundIndexBuffer = BoundBuffer();
+    m_BoundIndexFormat = WGPUIndexFormat_Undefined;
+    for (WGPUBindGroup& bound : m_BoundBindGroups) {
+      bound = nullptr;
+    }
+    m_StateStats = RenderPassStateStats();
+  }
+
+  void RenderPass::SetPipeline(WGPURenderPipeline pipeline) {
+    if (m_BoundPipeline == pipeline) {
+      m_StateStats.Skipped++;
+      return;
+    }
+
+    wgpuRenderPassEncoderSetPipeline(m_Encoder, pipeline);
+    m_BoundPipeline = pipeline;
+    m_StateStats.Issued++;
+  }
+
+  void RenderPass::SetVertexBuffer(uint32_t slot, WGPUBuffer buffer, uint64_t offset, uint64_t size) {
+    RN_ASSERT(slot < MaxVertexBuffers, "RenderPass: vertex buffer slot {} out of range", slot);
+    if (m_BoundVertexBuffers[slot].Matches(buffer, offset, size)) {
+      m_StateStats.Skipped++;
+      return;
+    }
+
+    wgpuRenderPassEncoderSetVertexBuffer(m_Encoder, slot, buffer, offset, size);
+    m_BoundVertexBuffers[slot] = {buffer, offset, size};
+    m_StateStats.Issued++;
+  }
+
+  void RenderPass::SetIndexBuffer(WGPUBuffer buffer, WGPUIndexFormat format, uint64_t offset, uint64_t size) {
+    if (m_BoundIndexBuffer.Matches(buffer, offset, size) && m_BoundIndexFormat == format) {
+      m_StateStats.Skipped++;
+      return;
+    }
+
+    wgpuRenderPassEncoderSetIndexBuffer(m_Encoder, buffer, format, offset, size);
+    m_BoundIndexBuffer = {buffer, offset, size};
+    m_BoundIndexFormat = format;
+    m_StateStats.Issued++;
+  }
+
+  void RenderPass::SetBindGroup(uint32_t index, WGPUBindGroup bindGroup) {
+    RN_ASSERT(index < MaxBindGroups, "RenderPass: bind group index {} out of range", index);
+    if (m_BoundBindGroups[index] == bindGroup) {
+      m_StateStats.Skipped++;
+      return;
+    }
+
+    wgpuRenderPassEncoderSetBindGroup(m_Encoder, index, bindGroup, 0, nullptr);
+    m_BoundBindGroups[index] = bindGroup;
+    m_StateStats.Issued++;
+  }
 }  // namespace Rain
@@ -15,6 +15,13 @@ namespace Rain
     glm::vec4 MarkerColor;
   };
 
+  // Encoder state calls since the pass began
+  struct RenderPassStateStats
+  {
+    uint32_t Issued = 0;
+    uint32_t Skipped = 0;  // Matched what was already bound
+  };
+
   // There is an interesting case in WebGPU which it doesn't have any explicit barriers and
   // all synchronization goes implicitly within API, due to that all PASSES that are using the same resources
   // Ran sequental instead of parallel, careness needed
@@ -42,10 +49,38 @@ namespace Rain
     Ref<BindingManager> m_PassBinds;
     RenderPassSpec m_PassSpec;
 
-    void SetRenderPassEncoder(WGPURenderPassEncoder encoder) { m_Encoder = encoder; }
+    // Starts recording, clears the tracked state and counters
+    void SetRenderPassEncoder(WGPURenderPassEncoder encoder);
     WGPURenderPassEncoder GetRenderPassEncoder() { return m_Encoder; }
 
+    // State setters for the pass encoder, calls matching the state already bound in this pass are dropped
+    void SetPipeline(WGPURenderPipeline pipeline);
+    void SetVertexBuffer(uint32_t slot, WGPUBuffer buffer, uint64_t offset, uint64_t size);
+    void SetIndexBuffer(WGPUBuffer buffer, WGPUIndexFormat format, uint64_t offset, uint64_t size);
+    void SetBindGroup(uint32_t index, WGPUBindGroup bindGroup);
+
+    const RenderPassStateStats& GetStateStats() const { return m_StateStats; }
+
    private:
+    static constexpr uint32_t MaxVertexBuffers = 4;
+    static constexpr uint32_t MaxBindGroups = 4;
+
+    struct BoundBuffer
+    {
+      WGPUBuffer Buffer = nullptr;
+      uint64_t Offset = 0;
+      uint64_t Size = 0;
+
+      bool Matches(WGPUBuffer buffer, uint64_t offset, uint64_t size) const { return Buffer == buffer && Offset == offset && Size == size; }
+    };
+
     WGPURenderPassEncoder m_Encoder;
+
+    WGPURenderPipeline m_BoundPipeline = nullptr;
+    BoundBuffer m_BoundVertexBuffers[MaxVertexBuffers];
+    BoundBuffer m_BoundIndexBuffer;
+    WGPUIndexFormat m_BoundIndexFormat = WGPUIndexFormat_Undefined;
+    WGPUBindGroup m_BoundBindGroups[MaxBindGroups] = {};
+    RenderPassStateStats m_StateStats;
   };
 }  // namespace Rain
@@ -147,6 +147,14 @@ namespace Rain
         return WGPUTextureFormat_RGBA16Float;
       case RGBA32F:
         return WGPUTextureFormat_RGBA32Float;
+      case BC1:
+        return WGPUTextureFormat_BC1RGBAUnorm;
+      case BC4:
+        return WGPUTextureFormat_BC4RUnorm;
+      case BC5:
+        return WGPUTextureFormat_BC5RGUnorm;
+      case BC7:
+        return WGPUTextureFormat_BC7RGBAUnorm;
       case Undefined:
         return WGPUTextureFormat_Undefined;
       default:
@@ -243,4 +251,24 @@ namespace Rain
         return 0;
     }
   }
+
+  bool TextureUtils::IsBlockCompressed(TextureFormat format)
+  {
+    return GetBlockBytes(format) != 0;
+  }
+
+  uint32_t TextureUtils::GetBlockBytes(TextureFormat format)
+  {
+    switch (format)
+    {
+      case TextureFormat::BC1:
+      case TextureFormat::BC4:
+        return 8;
+      case TextureFormat::BC5:
+      case TextureFormat::BC7:
+        return 16;
+      default:
+        return 0;
+    }
+  }
 }  // namespace Rain
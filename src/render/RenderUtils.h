@@ -20,7 +20,12 @@ namespace Rain {
     Int2,
     Int3,
     Int4,
-    Bool
+    Bool,
+    // Packed vertex formats, decoded to float or uint by the vertex fetch
+    Half2,
+    Snorm16x2,
+    Unorm16x4,
+    Uint8x4
   };
 
   static uint32_t ShaderDataTypeSize(ShaderDataType type) {
@@ -47,6 +52,14 @@ namespace Rain {
         return 4 * 4;
       case ShaderDataType::Bool:
         return 1;
+      case ShaderDataType::Half2:
+        return 2 * 2;
+      case ShaderDataType::Snorm16x2:
+        return 2 * 2;
+      case ShaderDataType::Unorm16x4:
+        return 2 * 4;
+      case ShaderDataType::Uint8x4:
+        return 4;
       case ShaderDataType::None:
         break;
     }
@@ -79,6 +92,11 @@ namespace Rain {
         return 4 * 4;
       case ShaderDataType::Bool:
         return 1;
+      case ShaderDataType::Half2:
+      case ShaderDataType::Snorm16x2:
+      case ShaderDataType::Unorm16x4:
+      case ShaderDataType::Uint8x4:
+        return 4;
       case ShaderDataType::None:
         break;
     }
@@ -130,6 +148,12 @@ namespace Rain {
           return 4;
         case ShaderDataType::Bool:
           return 1;
+        case ShaderDataType::Half2:
+        case ShaderDataType::Snorm16x2:
+          return 2;
+        case ShaderDataType::Unorm16x4:
+        case ShaderDataType::Uint8x4:
+          return 4;
         case ShaderDataType::None:
           break;
       }
@@ -294,5 +318,8 @@ namespace Rain {
   class TextureUtils {
    public:
     static uint32_t GetBytesPerPixel(TextureFormat format);
+    static bool IsBlockCompressed(TextureFormat format);
+    // Bytes per 4x4 block of a block compressed format
+    static uint32_t GetBlockBytes(TextureFormat format);
   };
 }  // namespace Rain
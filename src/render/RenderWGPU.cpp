@@ -1,4 +1,5 @@
 #include "RenderWGPU.h"
+#include <algorithm>
 #include <memory>
 #include "Application.h"
 #include "Mesh.h"
@@ -8,6 +9,7 @@
 #include "core/Ref.h"
 #include "debug/Profiler.h"
 #include "render/ShaderManager.h"
+#include "render/UploadRing.h"
 #include "webgpu/webgpu.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -45,6 +47,13 @@ namespace Rain
 
   static WGPURendererData* s_Data = nullptr;
 
+  // Meshes share geometry arena pages, so most draws find their buffers already bound
+  static void BindGeometry(const Ref<RenderPass>& pass, const Ref<GPUBuffer>& vertexBuffer, const Ref<GPUBuffer>& indexBuffer)
+  {
+    pass->SetVertexBuffer(0, vertexBuffer->Buffer, 0, vertexBuffer->Size);
+    pass->SetIndexBuffer(indexBuffer->Buffer, WGPUIndexFormat_Uint32, 0, indexBuffer->Size);
+  }
+
   struct ComputeDispatchInfo
   {
     uint32_t workgroupsX;
@@ -98,48 +107,69 @@ namespace Rain
 
   void RenderWGPU::ComputeMip(Texture2D* input)
   {
+    // Fallback for textures that were not cooked with a mip chain
     auto dir = RESOURCE_DIR "/shaders/ComputeMip.wgsl";
     static Ref<Shader> computeShader = ShaderManager::LoadShader("SH_Compute", dir);
+    static bool reloadRegistered = false;
+    if (!reloadRegistered)
+    {
+      // A reloaded shader gets a new module, the cached pipeline is rebuilt on the next call
+      Render::RegisterShaderDependency(computeShader, [this]()
+                                       {
+        if (m_MipPipeline)
+        {
+          wgpuComputePipelineRelease(m_MipPipeline);
+          wgpuPipelineLayoutRelease(m_MipPipelineLayout);
+          m_MipPipeline = nullptr;
+          m_MipPipelineLayout = nullptr;
+        } });
+      reloadRegistered = true;
+    }
+
     auto device = RenderContext::GetDevice();
 
-    std::vector<WGPUBindGroupLayout> bindGroupLayouts;
-    for (const auto& [_, layout] : computeShader->GetReflectionInfo().LayoutDescriptors)
+    WGPUBindGroupLayout bindGroupLayout = computeShader->GetReflectionInfo().LayoutDescriptors.begin()->second;
+
+    // The pipeline only depends on the shader, build it once
+    if (!m_MipPipeline)
     {
-      bindGroupLayouts.push_back(layout);
+      WGPUPipelineLayoutDescriptor layoutDesc = {};
+      layoutDesc.bindGroupLayoutCount = 1;
+      layoutDesc.bindGroupLayouts = &bindGroupLayout;
+      m_MipPipelineLayout = wgpuDeviceCreatePipelineLayout(device, &layoutDesc);
+
+      WGPUComputePipelineDescriptor computePipelineDesc = {};
+      computePipelineDesc.compute.constantCount = 0;
+      computePipelineDesc.compute.constants = nullptr;
+      computePipelineDesc.compute.entryPoint = RenderUtils::MakeLabel("computeMipMap");
+      computePipelineDesc.compute.module = computeShader->GetNativeShaderModule();
+      computePipelineDesc.layout = m_MipPipelineLayout;
+      m_MipPipeline = wgpuDeviceCreateComputePipeline(device, &computePipelineDesc);
     }
 
-    WGPUPipelineLayoutDescriptor layoutDesc = {};
-    layoutDesc.bindGroupLayoutCount = bindGroupLayouts.size();
-    layoutDesc.bindGroupLayouts = bindGroupLayouts.data();
-    WGPUPipelineLayout pipelineLayout = wgpuDeviceCreatePipelineLayout(device, &layoutDesc);
-
-    WGPUComputePipelineDescriptor computePipelineDesc = {};
-    computePipelineDesc.compute.constantCount = 0;
-    computePipelineDesc.compute.constants = nullptr;
-    computePipelineDesc.compute.entryPoint = RenderUtils::MakeLabel("computeMipMap");
-    computePipelineDesc.compute.module = computeShader->GetNativeShaderModule();
-    computePipelineDesc.layout = pipelineLayout;
-    WGPUComputePipeline pipeline = wgpuDeviceCreateComputePipeline(device, &computePipelineDesc);
+    const uint32_t mipCount = RenderUtils::CalculateMipCount(input->GetSpec().Width, input->GetSpec().Height);
+    std::vector<WGPUBindGroup> bindGroups;
+    bindGroups.reserve(mipCount);
 
-    int mipCount = RenderUtils::CalculateMipCount(input->GetSpec().Width, input->GetSpec().Height);
+    // Every level is a dispatch in one compute pass, dispatches are ordered so each level
+    // reads the one written before it. One submit for the whole chain.
+    auto encoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
+    WGPUComputePassDescriptor computePassDesc = {};
+    WGPUComputePassEncoder computePass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+    wgpuComputePassEncoderSetPipeline(computePass, m_MipPipeline);
 
     for (uint32_t mipLevel = 1; mipLevel < mipCount; ++mipLevel)
     {
-      auto encoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
-
-      WGPUComputePassDescriptor computePassDesc = {};
-      WGPUComputePassEncoder computePass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
-      wgpuComputePassEncoderSetPipeline(computePass, pipeline);
-
       WGPUBindGroupEntry bindGroupEntries[2] = {
           {.binding = 0, .textureView = input->GetReadableView(mipLevel - 1)},
           {.binding = 1, .textureView = input->GetWriteableView(mipLevel)}};
 
       WGPUBindGroupDescriptor bindGroupDesc = {};
-      bindGroupDesc.layout = bindGroupLayouts[0];
+      bindGroupDesc.layout = bindGroupLayout;
       bindGroupDesc.entryCount = 2;
       bindGroupDesc.entries = bindGroupEntries;
       WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDesc);
+      bindGroups.push_back(bindGroup);
 
       const uint32_t workgroupSize = 32;
       const uint32_t workgroupsX = (std::max(input->GetSpec().Width >> mipLevel, (uint32_t)1) + workgroupSize - 1) / workgroupSize;
@@ -147,19 +177,22 @@ namespace Rain
 
       wgpuComputePassEncoderSetBindGroup(computePass, 0, bindGroup, 0, nullptr);
       wgpuComputePassEncoderDispatchWorkgroups(computePass, workgroupsX, workgroupsY, 1);
-      wgpuComputePassEncoderEnd(computePass);
+    }
 
-      WGPUCommandBufferDescriptor cmdBufferDesc = {};
-      WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(encoder, &cmdBufferDesc);
-      wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
+    wgpuComputePassEncoderEnd(computePass);
 
+    WGPUCommandBufferDescriptor cmdBufferDesc = {};
+    WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(encoder, &cmdBufferDesc);
+    UploadRing::Flush();
+    wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
+
+    for (WGPUBindGroup bindGroup : bindGroups)
+    {
       wgpuBindGroupRelease(bindGroup);
-      wgpuCommandEncoderRelease(encoder);
-      wgpuCommandBufferRelease(commandBuffer);
     }
-
-    wgpuPipelineLayoutRelease(pipelineLayout);
-    wgpuComputePipelineRelease(pipeline);
+    wgpuComputePassEncoderRelease(computePass);
+    wgpuCommandEncoderRelease(encoder);
+    wgpuCommandBufferRelease(commandBuffer);
   }
 
   void RenderWGPU::ComputeMipCube(TextureCube* input)
@@ -222,6 +255,7 @@ namespace Rain
       }
 
       auto commandBuffer = wgpuCommandEncoderFinish(encoder, nullptr);
+      UploadRing::Flush();
       wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
 
       wgpuBindGroupRelease(bindGroup);
@@ -340,6 +374,7 @@ namespace Rain
       }
 
       const auto commandBuffer = wgpuCommandEncoderFinish(encoder, nullptr);
+      UploadRing::Flush();
       wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
 
       wgpuBindGroupRelease(bindGroup);
@@ -400,6 +435,7 @@ namespace Rain
     }
 
     auto commandBuffer = wgpuCommandEncoderFinish(encoder, nullptr);
+    UploadRing::Flush();
     wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
 
     // Cleanup WebGPU resources
@@ -477,14 +513,13 @@ namespace Rain
     }
 
     const WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(commandBuffer->GetNativeEncoder(), &passDesc);
-    const Ref<BindingManager> bindManager = pass->GetBindManager();
+    pass->SetRenderPassEncoder(renderPass);
 
+    const Ref<BindingManager> bindManager = pass->GetBindManager();
     for (const auto& [index, bindGroup] : bindManager->GetBindGroups())
     {
-      wgpuRenderPassEncoderSetBindGroup(renderPass, index, bindGroup, 0, 0);
+      pass->SetBindGroup(index, bindGroup);
     }
-
-    pass->SetRenderPassEncoder(renderPass);
   }
 
   void RenderWGPU::EndRenderPass(Ref<RenderPass> pass)
@@ -508,95 +543,59 @@ namespace Rain
                               WGPURenderPipeline pipeline,
                               Ref<MeshSource> mesh,
                               uint32_t submeshIndex,
+                              uint32_t lod,
                               Ref<MaterialTable> materialTable,
                               Ref<GPUBuffer> transformBuffer,
-                              uint32_t transformOffset,
+                              uint32_t firstInstance,
                               uint32_t instanceCount)
   {
     const WGPURenderPassEncoder nativeRenderPassEncoder = renderPass->GetRenderPassEncoder();
 
-    wgpuRenderPassEncoderSetPipeline(nativeRenderPassEncoder, pipeline);
-
-    wgpuRenderPassEncoderSetVertexBuffer(nativeRenderPassEncoder,
-                                         0,
-                                         mesh->GetVertexBuffer()->Buffer,
-                                         0,
-                                         mesh->GetVertexBuffer()->Size);
-
-    wgpuRenderPassEncoderSetIndexBuffer(nativeRenderPassEncoder,
-                                        mesh->GetIndexBuffer()->Buffer,
-                                        WGPUIndexFormat_Uint32,
-                                        0,
-                                        mesh->GetIndexBuffer()->Size);
-
-    wgpuRenderPassEncoderSetVertexBuffer(nativeRenderPassEncoder,
-                                         1,
-                                         transformBuffer->Buffer,
-                                         transformOffset,
-                                         transformBuffer->Size - transformOffset);
+    renderPass->SetPipeline(pipeline);
+    BindGeometry(renderPass, mesh->GetVertexBuffer(), mesh->GetIndexBuffer());
+    renderPass->SetVertexBuffer(1, transformBuffer->Buffer, 0, transformBuffer->Size);
 
     const auto& subMesh = mesh->m_SubMeshes[submeshIndex];
     auto material = materialTable->HasMaterial(subMesh.MaterialIndex) ? materialTable->GetMaterial(subMesh.MaterialIndex) : mesh->Materials->GetMaterial(subMesh.MaterialIndex);
 
-    wgpuRenderPassEncoderSetBindGroup(nativeRenderPassEncoder, 1, material->GetBinding(1), 0, 0);
-    wgpuRenderPassEncoderDrawIndexed(nativeRenderPassEncoder, subMesh.IndexCount, instanceCount, subMesh.BaseIndex, subMesh.BaseVertex, 0);
+    renderPass->SetBindGroup(1, material->GetBinding(1));
+    const SubMeshLod& range = subMesh.Lods[std::min(lod, subMesh.LodCount - 1)];
+    wgpuRenderPassEncoderDrawIndexed(nativeRenderPassEncoder, range.IndexCount, instanceCount, subMesh.ArenaIndexOffset + range.BaseIndex, subMesh.ArenaBaseVertex, firstInstance);
   }
 
   void RenderWGPU::RenderSkeletalMesh(Ref<RenderPass> renderPass,
                                       WGPURenderPipeline pipeline,
                                       Ref<MeshSource> mesh,
                                       uint32_t submeshIndex,
+                                      uint32_t lod,
                                       Ref<MaterialTable> materialTable,
                                       Ref<GPUBuffer> transformBuffer,
+                                      uint32_t firstInstance,
                                       uint32_t instanceCount)
   {
     const WGPURenderPassEncoder nativeRenderPassEncoder = renderPass->GetRenderPassEncoder();
 
-    wgpuRenderPassEncoderSetPipeline(nativeRenderPassEncoder, pipeline);
+    renderPass->SetPipeline(pipeline);
 
     // Use skeletal vertex buffer instead of regular vertex buffer
-    wgpuRenderPassEncoderSetVertexBuffer(nativeRenderPassEncoder,
-                                         0,
-                                         mesh->GetSkeletalVertexBuffer()->Buffer,
-                                         0,
-                                         mesh->GetSkeletalVertexBuffer()->Size);
-
-    wgpuRenderPassEncoderSetIndexBuffer(nativeRenderPassEncoder,
-                                        mesh->GetIndexBuffer()->Buffer,
-                                        WGPUIndexFormat_Uint32,
-                                        0,
-                                        mesh->GetIndexBuffer()->Size);
-
-    wgpuRenderPassEncoderSetVertexBuffer(nativeRenderPassEncoder,
-                                         1,
-                                         transformBuffer->Buffer,
-                                         0,
-                                         transformBuffer->Size);
+    BindGeometry(renderPass, mesh->GetSkeletalVertexBuffer(), mesh->GetIndexBuffer());
+    renderPass->SetVertexBuffer(1, transformBuffer->Buffer, 0, transformBuffer->Size);
 
     const auto& subMesh = mesh->m_SubMeshes[submeshIndex];
 
     auto material = materialTable->HasMaterial(subMesh.MaterialIndex) ? materialTable->GetMaterial(subMesh.MaterialIndex) : mesh->Materials->GetMaterial(subMesh.MaterialIndex);
-    wgpuRenderPassEncoderSetBindGroup(nativeRenderPassEncoder, 1, material->GetBinding(1), 0, 0);
+    renderPass->SetBindGroup(1, material->GetBinding(1));
 
-    wgpuRenderPassEncoderDrawIndexed(nativeRenderPassEncoder, subMesh.IndexCount, instanceCount, subMesh.BaseIndex, subMesh.BaseVertex, 0);
+    const SubMeshLod& range = subMesh.Lods[std::min(lod, subMesh.LodCount - 1)];
+    wgpuRenderPassEncoderDrawIndexed(nativeRenderPassEncoder, range.IndexCount, instanceCount, subMesh.ArenaIndexOffset + range.BaseIndex, subMesh.ArenaSkeletalBaseVertex, firstInstance);
   }
 
   void RenderWGPU::SubmitFullscreenQuad(Ref<RenderPass> renderPass, WGPURenderPipeline pipeline)
   {
     const auto nativeRenderPassEncoder = renderPass->GetRenderPassEncoder();
 
-    wgpuRenderPassEncoderSetPipeline(nativeRenderPassEncoder, pipeline);
-    wgpuRenderPassEncoderSetVertexBuffer(nativeRenderPassEncoder,
-                                         0,
-                                         s_Data->QuadVertexBuffer->Buffer,
-                                         0,
-                                         s_Data->QuadVertexBuffer->Size);
-
-    wgpuRenderPassEncoderSetIndexBuffer(nativeRenderPassEncoder,
-                                        s_Data->QuadIndexBuffer->Buffer,
-                                        WGPUIndexFormat_Uint32,
-                                        0,
-                                        s_Data->QuadIndexBuffer->Size);
+    renderPass->SetPipeline(pipeline);
+    BindGeometry(renderPass, s_Data->QuadVertexBuffer, s_Data->QuadIndexBuffer);
     wgpuRenderPassEncoderDrawIndexed(nativeRenderPassEncoder, 6, 1, 0, 0, 0);
   }
 
@@ -622,6 +621,7 @@ namespace Rain
     WGPUCommandBufferDescriptor cmdBufferDescriptor = {.nextInChain = nullptr, .label = "Command Buffer"};
     WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(nativeCommandEncoder, &cmdBufferDescriptor);
 
+    UploadRing::Flush();
     wgpuQueueSubmit(m_Queue, 1, &commandBuffer);
     wgpuCommandBufferRelease(commandBuffer);
     wgpuCommandEncoderRelease(nativeCommandEncoder);
@@ -675,6 +675,7 @@ namespace Rain
       wgpuComputePassEncoderEnd(computePass);
     }
     auto commandBuffer = wgpuCommandEncoderFinish(encoder, nullptr);
+    UploadRing::Flush();
     wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
 
     wgpuBindGroupRelease(bindGroup);
@@ -853,10 +854,19 @@ namespace Rain
 
     std::vector<WGPUFeatureName> requiredFeatures = {
         WGPUFeatureName_TimestampQuery,
-        WGPUFeatureName_TextureCompressionBC,
         WGPUFeatureName_Float32Filterable,
         WGPUFeatureName_DepthClipControl};
 
+    // Optional, cooked BC textures fall back to RGBA8 when the device lacks it
+    if (wgpuAdapterHasFeature(m_Adapter, WGPUFeatureName_TextureCompressionBC))
+    {
+      requiredFeatures.push_back(WGPUFeatureName_TextureCompressionBC);
+    }
+    else
+    {
+      RN_LOG("Adapter has no BC texture compression, textures stay uncompressed");
+    }
+
 #ifndef __EMSCRIPTEN__
     WGPULimits* requiredLimits = ZERO_ALLOC(WGPULimits);
     requiredLimits->minUniformBufferOffsetAlignment = 256;
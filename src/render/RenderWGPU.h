@@ -29,17 +29,20 @@ namespace Rain
                             WGPURenderPipeline pipeline,
                             Ref<MeshSource> mesh,
                             uint32_t submeshIndex,
+                            uint32_t lod,
                             Ref<MaterialTable> material,
                             Ref<GPUBuffer> transformBuffer,
-                            uint32_t transformOffset,
+                            uint32_t firstInstance,
                             uint32_t instanceCount) override;
 
     virtual void RenderSkeletalMesh(Ref<RenderPass> renderPass,
                                     WGPURenderPipeline pipeline,
                                     Ref<MeshSource> mesh,
                                     uint32_t submeshIndex,
+                                    uint32_t lod,
                                     Ref<MaterialTable> materialTable,
                                     Ref<GPUBuffer> transformBuffer,
+                                    uint32_t firstInstance,
                                     uint32_t instanceCount) override;
 
     virtual void SubmitFullscreenQuad(Ref<RenderPass> renderPass, WGPURenderPipeline pipeline) override;
@@ -88,6 +91,10 @@ namespace Rain
 
     WGPUColor m_ClearColor = WGPUColor{0, 0, 0, 1};
 
+    // Cached by ComputeMip
+    WGPUPipelineLayout m_MipPipelineLayout = nullptr;
+    WGPUComputePipeline m_MipPipeline = nullptr;
+
     friend class RenderContext;
   };
 }  // namespace Rain
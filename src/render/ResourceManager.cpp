@@ -1,12 +1,20 @@
 #include "ResourceManager.h"
 #include <stb_image.h>
 #include <stb_image_resize2.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 #include "core/Assert.h"
+#include "core/JobSystem.h"
 #include "core/Log.h"
 #include "debug/Profiler.h"
 #include "render/RenderContext.h"
+#include "render/TextureStreamer.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -19,12 +27,40 @@
 #endif
 
 #include "render/Render.h"
+#include "render/TextureImporter.h"
 
 namespace Rain {
   std::unordered_map<std::string, std::shared_ptr<Texture2D>> Rain::ResourceManager::_loadedTextures;
   std::unordered_map<std::string, std::shared_ptr<TextureCube>> Rain::ResourceManager::_loadedTexturesCube;
 
   std::unordered_map<AssetHandle, Ref<MeshSource>> Rain::ResourceManager::m_LoadedMeshSources;
+  std::unordered_map<std::string, AssetFuture<Texture2D>> Rain::ResourceManager::m_LoadingTextures;
+
+  namespace {
+    struct PendingUpload {
+      uint64_t Size = 0;
+      std::function<void()> Upload;
+    };
+
+    std::mutex s_UploadMutex;
+    std::deque<PendingUpload> s_Uploads;
+    uint64_t s_UploadBudget = 32ull * 1024 * 1024;
+    std::atomic<uint32_t> s_PendingLoads{0};
+
+    void QueueUpload(uint64_t size, std::function<void()> upload) {
+      std::lock_guard<std::mutex> lock(s_UploadMutex);
+      s_Uploads.push_back({size, std::move(upload)});
+    }
+
+    // Without workers (web build) nothing would ever pick the job up, so decode inline
+    void RunDecode(JobFunction decode) {
+      if (JobSystem::GetWorkerCount() == 0) {
+        decode();
+      } else {
+        JobSystem::Run(std::move(decode));
+      }
+    }
+  }  // namespace
 
   void WriteTexture2(void* pixelData, const WGPUTexture& target, uint32_t width, uint32_t height, uint32_t targetMip) {
     // Ref<RenderContext> renderContext = Render::Instance->GetRenderContext();
@@ -180,6 +216,176 @@ namespace Rain {
     return texture;
   }
 
+  void Rain::ResourceManager::LoadTextures(const std::vector<TextureLoadRequest>& requests) {
+    RN_PROFILE_FUNC;
+
+    std::unordered_set<std::string> queued;
+    std::vector<const TextureLoadRequest*> pending;
+    for (const TextureLoadRequest& request : requests) {
+      if (!IsTextureExist(request.Id) && queued.insert(request.Id).second) {
+        pending.push_back(&request);
+      }
+    }
+
+    struct DecodedTexture {
+      TextureProps Props;
+      Buffer Image;
+      std::vector<TextureMipLevel> MipLevels;
+    };
+
+    // Decoded pixels are uploaded one batch at a time and non-streamed textures drop them once
+    // on the GPU, so a material set with dozens of 4K maps never holds all of them in memory.
+    // Streamed textures keep their chain for later mip upgrades.
+    const uint32_t batchSize = 2 * (JobSystem::GetWorkerCount() + 1);
+    const bool allowBlockCompression = RenderContext::HasFeature(WGPUFeatureName_TextureCompressionBC);
+    std::vector<DecodedTexture> decoded;
+
+    for (size_t batchBegin = 0; batchBegin < pending.size(); batchBegin += batchSize) {
+      const uint32_t count = (uint32_t)std::min<size_t>(batchSize, pending.size() - batchBegin);
+      decoded.clear();
+      decoded.resize(count);
+
+      JobSystem::ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+          const TextureLoadRequest& request = *pending[batchBegin + i];
+          TextureProps& props = decoded[i].Props;
+          props = request.Props;
+          props.DebugName = request.Id;
+          props.CreateSampler = true;
+          decoded[i].Image = TextureImporter::ImportFileToBuffer(request.Path, props, allowBlockCompression, decoded[i].MipLevels);
+        }
+      });
+
+      for (uint32_t i = 0; i < count; i++) {
+        const TextureLoadRequest& request = *pending[batchBegin + i];
+        if (!decoded[i].Image) {
+          RN_LOG_ERR("Texture {} failed to load from {}", request.Id, request.Path);
+          continue;
+        }
+
+        auto texture = Texture2D::CreateFromImage(decoded[i].Props, decoded[i].Image, std::move(decoded[i].MipLevels));
+        if (decoded[i].Props.Stream) {
+          TextureStreamer::Register(texture);
+        }
+        _loadedTextures[request.Id] = texture;
+        RN_LOG("Texture {} loaded from {}", request.Id, request.Path);
+      }
+    }
+  }
+
+  AssetFuture<Texture2D> Rain::ResourceManager::LoadTextureAsync(std::string id, std::string path, const TextureProps& props) {
+    RN_ASSERT(JobSystem::IsMainThread(), "LoadTextureAsync must be called on the main thread");
+
+    if (auto loaded = _loadedTextures.find(id); loaded != _loadedTextures.end()) {
+      auto future = CreateRef<AsyncAsset<Texture2D>>(path);
+      future->Resolve(loaded->second);
+      return future;
+    }
+
+    if (auto loading = m_LoadingTextures.find(id); loading != m_LoadingTextures.end()) {
+      return loading->second;
+    }
+
+    auto future = CreateRef<AsyncAsset<Texture2D>>(path, Render::Get()->GetWhiteTexture());
+    m_LoadingTextures[id] = future;
+    s_PendingLoads++;
+
+    TextureProps textureProp = props;
+    textureProp.DebugName = id;
+    textureProp.CreateSampler = true;
+    const bool allowBlockCompression = RenderContext::HasFeature(WGPUFeatureName_TextureCompressionBC);
+
+    RunDecode([id, path, textureProp, allowBlockCompression, future]() mutable {
+      std::vector<TextureMipLevel> mipLevels;
+      Buffer image = TextureImporter::ImportFileToBuffer(path, textureProp, allowBlockCompression, mipLevels);
+
+      QueueUpload(image.Size, [id, path, textureProp, future, image, mipLevels = std::move(mipLevels)]() mutable {
+        m_LoadingTextures.erase(id);
+        s_PendingLoads--;
+
+        if (!image) {
+          RN_LOG_ERR("Texture {} failed to load from {}", id, path);
+          future->Fail();
+          return;
+        }
+
+        // A synchronous load of the same id may have finished first
+        auto& texture = _loadedTextures[id];
+        if (!texture) {
+          texture = Texture2D::CreateFromImage(textureProp, image, mipLevels);
+          if (textureProp.Stream) {
+            TextureStreamer::Register(texture);
+          }
+          RN_LOG("Texture {} streamed from {}", id, path);
+        } else {
+          // Buffer does not own its memory, the decoded copy is ours to drop
+          image.Release();
+        }
+        future->Resolve(texture);
+      });
+    });
+
+    return future;
+  }
+
+  AssetFuture<MeshSource> Rain::ResourceManager::LoadMeshSourceAsync(std::string path) {
+    RN_ASSERT(JobSystem::IsMainThread(), "LoadMeshSourceAsync must be called on the main thread");
+
+    auto future = CreateRef<AsyncAsset<MeshSource>>(path);
+    auto meshSource = CreateRef<MeshSource>(path, true);
+    s_PendingLoads++;
+
+    RunDecode([meshSource, future]() {
+      const bool decoded = meshSource->Decode();
+
+      QueueUpload(meshSource->GetUploadSize(), [meshSource, future, decoded]() {
+        s_PendingLoads--;
+
+        if (!decoded) {
+          RN_LOG_ERR("Mesh failed to load from {}", future->GetPath());
+          future->Fail();
+          return;
+        }
+
+        meshSource->Upload();
+        m_LoadedMeshSources[meshSource->Id] = meshSource;
+        future->Resolve(meshSource);
+      });
+    });
+
+    return future;
+  }
+
+  void Rain::ResourceManager::ProcessUploads() {
+    RN_PROFILE_FUNC;
+
+    uint64_t uploadedBytes = 0;
+    while (true) {
+      PendingUpload upload;
+      {
+        std::lock_guard<std::mutex> lock(s_UploadMutex);
+        if (s_Uploads.empty() || (uploadedBytes > 0 && uploadedBytes + s_Uploads.front().Size > s_UploadBudget)) {
+          break;
+        }
+
+        upload = std::move(s_Uploads.front());
+        s_Uploads.pop_front();
+      }
+
+      // Runs unlocked, uploads may start new loads (a mesh requesting its textures)
+      upload.Upload();
+      uploadedBytes += upload.Size;
+    }
+  }
+
+  void Rain::ResourceManager::SetUploadBudget(uint64_t bytesPerFrame) {
+    s_UploadBudget = bytesPerFrame;
+  }
+
+  uint32_t Rain::ResourceManager::GetPendingLoadCount() {
+    return s_PendingLoads.load();
+  }
+
   std::shared_ptr<Texture2D> Rain::ResourceManager::GetTexture(std::string id) {
     if (_loadedTextures.find(id) == _loadedTextures.end()) {
       std::cout << "GetTexture for id " << id << " does not exist" << std::endl;
@@ -3,12 +3,19 @@
 #include <string>
 #include <unordered_map>
 #include "core/UUID.h"
+#include "render/AsyncAsset.h"
 #include "render/Mesh.h"
 #include "render/Texture.h"
 
 namespace Rain {
   typedef UUID AssetHandle;
 
+  struct TextureLoadRequest {
+    std::string Id;
+    std::string Path;
+    TextureProps Props;
+  };
+
   class ResourceManager {
    public:
     static std::shared_ptr<Texture2D> LoadTexture(std::string id, std::string path);
@@ -18,6 +25,19 @@ namespace Rain {
     static Ref<MeshSource> GetMeshSource(UUID handle);
     static Ref<MeshSource> LoadMeshSource(std::string path);
 
+    // Decodes every request whose id is not loaded yet in parallel, then creates the GPU textures
+    static void LoadTextures(const std::vector<TextureLoadRequest>& requests);
+
+    // Decode runs on a worker and the GPU upload on the main thread within the frame budget.
+    // Loading an id twice returns the same handle, a loaded id returns a resolved one.
+    static AssetFuture<Texture2D> LoadTextureAsync(std::string id, std::string path, const TextureProps& props);
+    static AssetFuture<MeshSource> LoadMeshSourceAsync(std::string path);
+
+    // Called once per frame. Runs queued uploads until the byte budget is spent, always at least one.
+    static void ProcessUploads();
+    static void SetUploadBudget(uint64_t bytesPerFrame);
+    static uint32_t GetPendingLoadCount();
+
     static std::shared_ptr<Texture2D> GetTexture(std::string id);
     static bool IsTextureExist(std::string id);
 
@@ -25,5 +45,6 @@ namespace Rain {
     static std::unordered_map<std::string, std::shared_ptr<Texture2D>> _loadedTextures;
     static std::unordered_map<std::string, std::shared_ptr<TextureCube>> _loadedTexturesCube;
     static std::unordered_map<AssetHandle, Ref<MeshSource>> m_LoadedMeshSources;
+    static std::unordered_map<std::string, AssetFuture<Texture2D>> m_LoadingTextures;
   };
 }  // namespace Rain
@@ -73,5 +73,6 @@ namespace Rain
   void Sampler::Release()
   {
     wgpuSamplerRelease(*m_Sampler);  // TODO better do
+    m_Generation++;
   }
 }  // namespace Rain
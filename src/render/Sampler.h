@@ -43,6 +43,8 @@ namespace Rain
     Sampler() {};
 
     Ref<WGPUSampler> GetNativeSampler() { return m_Sampler; }
+    // Bumped when the native sampler is released
+    uint32_t GetGeneration() const { return m_Generation; }
     static Ref<Sampler> Create(SamplerProps props);
     static SamplerProps GetDefaultProps(std::string name = "", float lodMinClamp = 0.0f, float lodMaxClamp = 80.0f)
     {
@@ -64,5 +66,6 @@ namespace Rain
 
    private:
     Ref<WGPUSampler> m_Sampler;
+    uint32_t m_Generation = 0;
   };
 }  // namespace Rain
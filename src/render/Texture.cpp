@@ -1,8 +1,10 @@
 #include "Texture.h"
+#include <algorithm>
 #include "render/Render.h"
 #include "render/RenderContext.h"
 #include "render/RenderUtils.h"
 #include "render/TextureImporter.h"
+#include "render/UploadRing.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -37,6 +39,11 @@ namespace Rain
     return textureRef;
   }
 
+  Ref<Texture2D> Texture2D::CreateFromImage(const TextureProps& props, Buffer imageData, std::vector<TextureMipLevel> mipLevels)
+  {
+    return CreateRef<Texture2D>(props, imageData, std::move(mipLevels));
+  }
+
   Texture2D::Texture2D(const TextureProps& props)
       : m_TextureProps(props)
   {
@@ -48,6 +55,81 @@ namespace Rain
     CreateFromFile(props, path);
   }
 
+  Texture2D::Texture2D(const TextureProps& props, Buffer imageData, std::vector<TextureMipLevel> mipLevels)
+      : m_TextureProps(props), m_ImageData(imageData), m_MipLevels(std::move(mipLevels))
+  {
+    // Streamed textures start with the mip tail only, the streamer raises them on demand
+    if (m_TextureProps.Stream)
+    {
+      m_ResidentMip = GetMipTailStart();
+    }
+    Invalidate();
+    ReleaseUploadedPixels();
+  }
+
+  uint32_t Texture2D::GetMipTailStart() const
+  {
+    if (m_MipLevels.empty())
+    {
+      return 0;
+    }
+
+    // Block compressed textures need a top level that is a whole number of blocks
+    const bool blockCompressed = TextureUtils::IsBlockCompressed(m_TextureProps.Format);
+    uint32_t mip = 0;
+    while (mip + 1 < m_MipLevels.size())
+    {
+      const uint32_t width = std::max(1u, m_TextureProps.Width >> mip);
+      const uint32_t height = std::max(1u, m_TextureProps.Height >> mip);
+      const uint32_t nextWidth = std::max(1u, width >> 1);
+      const uint32_t nextHeight = std::max(1u, height >> 1);
+      if (std::max(width, height) <= MipTailSize || (blockCompressed && (nextWidth % 4 != 0 || nextHeight % 4 != 0)))
+      {
+        break;
+      }
+      mip++;
+    }
+    return mip;
+  }
+
+  uint64_t Texture2D::GetResidentSize(uint32_t firstMip) const
+  {
+    uint64_t size = 0;
+    for (uint32_t mip = firstMip; mip < m_MipLevels.size(); mip++)
+    {
+      size += m_MipLevels[mip].Size;
+    }
+    return size;
+  }
+
+  void Texture2D::SetResidentMip(uint32_t firstMip)
+  {
+    firstMip = std::min(firstMip, GetMipTailStart());
+    if (!IsStreamable() || firstMip == m_ResidentMip)
+    {
+      return;
+    }
+
+    WGPUTexture previousTexture = TextureBuffer;
+    std::vector<WGPUTextureView> previousViews = std::move(m_ReadViews);
+    m_ReadViews.clear();
+    m_WriteViews.clear();
+    TextureBuffer = NULL;
+
+    m_ResidentMip = firstMip;
+    Invalidate();
+
+    // Bind groups still holding the old view keep it alive until they are rebuilt
+    for (WGPUTextureView view : previousViews)
+    {
+      wgpuTextureViewRelease(view);
+    }
+    if (previousTexture)
+    {
+      wgpuTextureRelease(previousTexture);
+    }
+  }
+
   void Texture2D::Resize(uint width, uint height)
   {
     m_TextureProps.Width = width;
@@ -67,8 +149,10 @@ namespace Rain
     if (m_TextureProps.CreateSampler)
     {
       Sampler->Release();
+      Sampler = nullptr;
     }
     m_ReadViews.clear();
+    m_Generation++;
   }
 
   void Texture2D::Invalidate()
@@ -83,8 +167,16 @@ namespace Rain
       m_ReadViews.clear();
     }
 
+    // A cooked chain is uploaded level by level, only raw images run the compute mip pass
+    const bool hasCookedMips = !m_MipLevels.empty();
+    const bool generateMips = m_TextureProps.GenerateMips && !hasCookedMips;
+
     uint32_t mipCount = 1;
-    if (m_TextureProps.GenerateMips)
+    if (hasCookedMips)
+    {
+      mipCount = (uint32_t)m_MipLevels.size() - m_ResidentMip;
+    }
+    else if (generateMips)
     {
       mipCount = RenderUtils::CalculateMipCount(m_TextureProps.Width, m_TextureProps.Height);
     }
@@ -95,7 +187,11 @@ namespace Rain
     textureDesc.nextInChain = nullptr;
     textureDesc.label = RenderUtils::MakeLabel(m_TextureProps.DebugName);
 
-    if (m_TextureProps.GenerateMips)
+    if (hasCookedMips)
+    {
+      textureDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst;
+    }
+    else if (generateMips)
     {
       textureDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_StorageBinding | WGPUTextureUsage_CopySrc | WGPUTextureUsage_CopyDst;
     }
@@ -105,15 +201,15 @@ namespace Rain
     }
 
     textureDesc.dimension = WGPUTextureDimension_2D;
-    textureDesc.size.width = m_TextureProps.Width;
-    textureDesc.size.height = m_TextureProps.Height;
+    textureDesc.size.width = std::max(1u, m_TextureProps.Width >> m_ResidentMip);
+    textureDesc.size.height = std::max(1u, m_TextureProps.Height >> m_ResidentMip);
     textureDesc.size.depthOrArrayLayers = m_TextureProps.layers;
     textureDesc.sampleCount = m_TextureProps.MultiSample;
     textureDesc.format = RenderTypeUtils::ToRenderType(m_TextureProps.Format);
     textureDesc.mipLevelCount = mipCount;
     textureDesc.sampleCount = m_TextureProps.MultiSample;
 
-    if (m_TextureProps.CreateSampler)
+    if (m_TextureProps.CreateSampler && !Sampler)
     {
       std::string samplerName = "S_" + m_TextureProps.DebugName;
       SamplerProps samplerProps = {
@@ -141,7 +237,18 @@ namespace Rain
       }
     }
 
-    if (m_ImageData.GetSize() > 0)
+    if (hasCookedMips && m_ImageData)
+    {
+      // Smallest level first, so the texture is usable at low resolution as early as possible
+      for (uint32_t mip = mipCount; mip-- > 0;)
+      {
+        const uint32_t level = mip + m_ResidentMip;
+        const uint32_t mipWidth = std::max(1u, m_TextureProps.Width >> level);
+        const uint32_t mipHeight = std::max(1u, m_TextureProps.Height >> level);
+        WriteTexture((const uint8_t*)m_ImageData.Data + m_MipLevels[level].Offset, TextureBuffer, mipWidth, mipHeight, mip, 0, m_TextureProps.Format);
+      }
+    }
+    else if (m_ImageData.GetSize() > 0)
     {
       WriteTexture(m_ImageData.Data, TextureBuffer, m_TextureProps.Width, m_TextureProps.Height, 0, 0, m_TextureProps.Format);
     }
@@ -173,7 +280,20 @@ namespace Rain
     }
 
     // Create individual views based on texture type
-    if (m_TextureProps.GenerateMips)
+    if (hasCookedMips)
+    {
+      // Cooked chains are only sampled, one view covering every level
+      viewDesc.dimension = WGPUTextureViewDimension_2D;
+      viewDesc.baseArrayLayer = 0;
+      viewDesc.arrayLayerCount = 1;
+      viewDesc.baseMipLevel = 0;
+      viewDesc.mipLevelCount = mipCount;
+
+      WGPUTextureView view = wgpuTextureCreateView(TextureBuffer, &viewDesc);
+      m_ReadViews.push_back(view);
+      m_WriteViews.push_back(view);
+    }
+    else if (generateMips)
     {
       // For mipmapped textures: create a view for each mip level
       for (uint32_t mip = 0; mip < mipCount; mip++)
@@ -218,8 +338,9 @@ namespace Rain
       m_ReadViews.push_back(view);
       m_WriteViews.push_back(view);
     }
+    m_Generation++;
 
-    if (m_TextureProps.GenerateMips)
+    if (generateMips)
     {
       auto* Renderer = Render::Get();
       if (Renderer)
@@ -236,8 +357,20 @@ namespace Rain
       std::cerr << "Texture file not found: " << path << std::endl;
       return;
     }
-    m_ImageData = TextureImporter::ImportFileToBuffer(path, m_TextureProps.Format, m_TextureProps.Width, m_TextureProps.Height);
+    // Mipped textures get their chain from the cooker, no compute pass at load
+    const bool allowBlockCompression = RenderContext::HasFeature(WGPUFeatureName_TextureCompressionBC);
+    m_ImageData = TextureImporter::ImportFileToBuffer(path, m_TextureProps, allowBlockCompression, m_MipLevels);
     Invalidate();
+    ReleaseUploadedPixels();
+  }
+
+  void Texture2D::ReleaseUploadedPixels()
+  {
+    // Only streamed textures upload from their pixels again, the rest live on the GPU alone
+    if (!m_TextureProps.Stream)
+    {
+      m_ImageData.Release();
+    }
   }
 
   TextureCube::TextureCube(const TextureProps& props, const std::filesystem::path (&path)[6])
@@ -342,6 +475,7 @@ namespace Rain
       arrayViewDesc.mipLevelCount = 1;
       m_WriteViews.push_back(wgpuTextureCreateView(m_TextureBuffer, &arrayViewDesc));
     }
+    m_Generation++;
   }
 
   void WriteTexture(const void* pixelData, WGPUTexture target, uint32_t width, uint32_t height, uint32_t targetMip, uint32_t targetLayer, TextureFormat format)
@@ -358,84 +492,34 @@ namespace Rain
       return;
     }
 
-    uint32_t bytesPerPixel = TextureUtils::GetBytesPerPixel(format);
-    if (bytesPerPixel == 0)
-    {
-      RN_LOG_ERR("WriteTexture: Unsupported format {}", (int)format);
-      return;
-    }
-
-    auto* Renderer = Render::Get();
-    if (Renderer == nullptr)
+    // Block compressed data is laid out in rows of 4x4 blocks, the copy covers whole blocks
+    const bool blockCompressed = TextureUtils::IsBlockCompressed(format);
+    uint32_t unalignedBytesPerRow = 0;
+    uint32_t rowCount = height;
+    if (blockCompressed)
     {
-      return;
+      unalignedBytesPerRow = ((width + 3) / 4) * TextureUtils::GetBlockBytes(format);
+      rowCount = (height + 3) / 4;
+      width = (width + 3) & ~3u;
+      height = (height + 3) & ~3u;
     }
-
-    Ref<RenderContext> renderContext = Renderer->GetRenderContext();
-
-    if (renderContext == nullptr)
+    else
     {
-      return;
+      uint32_t bytesPerPixel = TextureUtils::GetBytesPerPixel(format);
+      if (bytesPerPixel == 0)
+      {
+        RN_LOG_ERR("WriteTexture: Unsupported format {}", (int)format);
+        return;
+      }
+      unalignedBytesPerRow = bytesPerPixel * width;
     }
 
-    const Ref<WGPUQueue> queue = renderContext->GetQueue();
-    if (!queue)
+    if (Render::Get() == nullptr || !RenderContext::IsReady())
     {
-      RN_LOG_ERR("WriteTexture: Invalid render queue");
       return;
     }
 
-    WGPUOrigin3D targetOrigin = {0, 0, targetLayer};
-
-#ifdef __EMSCRIPTEN__
-    WGPUImageCopyTexture dest = {
-#else
-    WGPUTexelCopyTextureInfo dest = {
-#endif
-      .texture = target,
-      .mipLevel = targetMip,
-      .origin = targetOrigin,
-      .aspect = WGPUTextureAspect_All
-    };
-
-    uint32_t unalignedBytesPerRow = bytesPerPixel * width;
-    uint32_t alignedBytesPerRow = (unalignedBytesPerRow + 255) & ~255;  // Align to 256 bytes
-
-#ifdef __EMSCRIPTEN__
-    WGPUTextureDataLayout textureLayout = {
-#else
-    WGPUTexelCopyBufferLayout textureLayout = {
-#endif
-      .offset = 0,
-      .bytesPerRow = alignedBytesPerRow,
-      .rowsPerImage = height
-    };
-
-    WGPUExtent3D textureSize = {
-        .width = width,
-        .height = height,
-        .depthOrArrayLayers = 1};
-
-    if (unalignedBytesPerRow != alignedBytesPerRow)
-    {
-      size_t alignedDataSize = alignedBytesPerRow * height;
-      std::vector<uint8_t> alignedData(alignedDataSize, 0);
-
-      const uint8_t* srcData = static_cast<const uint8_t*>(pixelData);
-      for (uint32_t y = 0; y < height; y++)
-      {
-        memcpy(
-            alignedData.data() + y * alignedBytesPerRow,
-            srcData + y * unalignedBytesPerRow,
-            unalignedBytesPerRow);
-      }
-
-      wgpuQueueWriteTexture(*queue, &dest, alignedData.data(), alignedDataSize, &textureLayout, &textureSize);
-    }
-    else
-    {
-      size_t dataSize = alignedBytesPerRow * height;
-      wgpuQueueWriteTexture(*queue, &dest, pixelData, dataSize, &textureLayout, &textureSize);
-    }
+    // Staged through the upload ring, which repacks rows to the copy pitch
+    UploadRing::WriteTexture(target, targetMip, targetLayer, width, height, pixelData, unalignedBytesPerRow, rowCount);
   }
 }  // namespace Rain
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 #include "core/Buffer.h"
 #include "core/UUID.h"
 #include "render/Sampler.h"
@@ -16,9 +17,30 @@ namespace Rain
     RGBA16F,
     RGBA32F,
     Depth24Plus,
+    BC1,  // RGB, 4 bpp
+    BC4,  // R, 4 bpp
+    BC5,  // RG, 8 bpp
+    BC7,  // RGBA, 8 bpp
     Undefined
   };
 
+  // Block compression a texture is cooked with, picked from how a material samples it
+  enum class TextureCompression
+  {
+    None,
+    Color,   // BC7
+    Normal,  // BC5, the shader rebuilds Z from XY
+    Mask,    // BC1, packed RGB masks such as metallic-roughness
+    Single   // BC4
+  };
+
+  // One level of a precomputed mip chain inside the texture's image buffer
+  struct TextureMipLevel
+  {
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+  };
+
   enum TextureType
   {
     TextureDim2D,
@@ -37,6 +59,8 @@ namespace Rain
 
     bool GenerateMips = false;
     bool CreateSampler = false;
+    TextureCompression Compression = TextureCompression::None;
+    bool Stream = false;  // Residency managed by the TextureStreamer, needs a cooked mip chain
     uint32_t layers = 1;
 
     std::string DebugName;
@@ -57,6 +81,12 @@ namespace Rain
     virtual WGPUTextureView GetView() = 0;
     virtual WGPUTextureView GetReadableView(int layer = 0) = 0;
     virtual WGPUTextureView GetWriteableView(int layer = 0) = 0;
+
+    // Bumped whenever the views are recreated, bind groups holding them compare against it
+    uint32_t GetGeneration() const { return m_Generation; }
+
+   protected:
+    uint32_t m_Generation = 0;
   };
 
   class Texture2D : public Texture
@@ -70,6 +100,9 @@ namespace Rain
 
     static Ref<Texture2D> Create(const TextureProps& props);
     static Ref<Texture2D> Create(const TextureProps& props, const std::filesystem::path& path);
+    // Takes ownership of pixels decoded off the main thread, props carry their format and size.
+    // With mipLevels the buffer holds the whole chain and no mips are generated on the GPU.
+    static Ref<Texture2D> CreateFromImage(const TextureProps& props, Buffer imageData, std::vector<TextureMipLevel> mipLevels = {});
 
     void Resize(uint width, uint height);
     void Release();
@@ -77,6 +110,7 @@ namespace Rain
     Texture2D();
     Texture2D(const TextureProps& props);
     Texture2D(const TextureProps& props, const std::filesystem::path& path);
+    Texture2D(const TextureProps& props, Buffer imageData, std::vector<TextureMipLevel> mipLevels);
 
     const int GetViewCount() { return m_ReadViews.size(); }
     WGPUTextureView GetView() override { return m_View; }
@@ -94,6 +128,17 @@ namespace Rain
 
     const TextureProps& GetSpec() { return m_TextureProps; }
 
+    // Streaming: the GPU texture holds the cooked levels from the resident mip down, the full
+    // chain stays in the image buffer. Levels up to MipTailSize are always resident.
+    static constexpr uint32_t MipTailSize = 64;
+    bool IsStreamable() const { return !m_MipLevels.empty(); }
+    uint32_t GetCookedMipCount() const { return (uint32_t)m_MipLevels.size(); }
+    uint32_t GetResidentMip() const { return m_ResidentMip; }
+    uint32_t GetMipTailStart() const;
+    uint64_t GetResidentSize(uint32_t firstMip) const;
+    // Recreates the GPU texture with the levels from firstMip down, bindings pick up the new view
+    void SetResidentMip(uint32_t firstMip);
+
     WGPUTextureView m_View;
     ;
     std::vector<WGPUTextureView> m_ReadViews;
@@ -104,9 +149,12 @@ namespace Rain
    private:
     TextureProps m_TextureProps;
     Buffer m_ImageData;
+    std::vector<TextureMipLevel> m_MipLevels;
+    uint32_t m_ResidentMip = 0;
 
     void CreateFromFile(const TextureProps& props, const std::filesystem::path& path);
     void Invalidate();
+    void ReleaseUploadedPixels();
   };
 
   class TextureCube : public Texture
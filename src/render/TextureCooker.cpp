@@ -0,0 +1,201 @@
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "core/DerivedDataCache.h"
+#include "render/BlockCompression.h"
+#include "render/RenderUtils.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr size_t kLevelAlignment = 16;
+
+    // Mips below 4x4 are padded to a whole block by repeating the edge texels
+    const uint8_t* PadToBlocks(const uint8_t* src, uint32_t width, uint32_t height, uint32_t paddedWidth, uint32_t paddedHeight, std::vector<uint8_t>& scratch)
+    {
+      if (width == paddedWidth && height == paddedHeight)
+      {
+        return src;
+      }
+
+      scratch.resize((size_t)paddedWidth * paddedHeight * 4);
+      for (uint32_t y = 0; y < paddedHeight; y++)
+      {
+        const uint32_t sy = std::min(y, height - 1);
+        for (uint32_t x = 0; x < paddedWidth; x++)
+        {
+          const uint32_t sx = std::min(x, width - 1);
+          std::memcpy(&scratch[((size_t)y * paddedWidth + x) * 4], &src[((size_t)sy * width + sx) * 4], 4);
+        }
+      }
+      return scratch.data();
+    }
+  }  // namespace
+
+  TextureFormat TextureCooker::GetCookedFormat(TextureFormat sourceFormat, uint32_t width, uint32_t height, const TextureCookSettings& settings)
+  {
+    // HDR stays float, BC6H is not cooked
+    if (sourceFormat != TextureFormat::RGBA8)
+    {
+      return sourceFormat;
+    }
+
+    if (!settings.BlockCompress || !CanBlockCompress(width, height))
+    {
+      return TextureFormat::RGBA8;
+    }
+
+    switch (settings.Compression)
+    {
+      case TextureCompression::Color:
+        return TextureFormat::BC7;
+      case TextureCompression::Normal:
+        return TextureFormat::BC5;
+      case TextureCompression::Mask:
+        return TextureFormat::BC1;
+      case TextureCompression::Single:
+        return TextureFormat::BC4;
+      default:
+        return TextureFormat::RGBA8;
+    }
+  }
+
+  MipFilter TextureCooker::GetMipFilter(TextureCompression compression)
+  {
+    switch (compression)
+    {
+      case TextureCompression::Color:
+        return MipFilter::SRGB;
+      case TextureCompression::Normal:
+        return MipFilter::Normal;
+      default:
+        return MipFilter::Linear;
+    }
+  }
+
+  bool TextureCooker::CanBlockCompress(uint32_t width, uint32_t height)
+  {
+    return width > 0 && height > 0 && width % 4 == 0 && height % 4 == 0;
+  }
+
+  std::string TextureCooker::GetCacheKey(uint64_t sourceHash, const TextureCookSettings& settings)
+  {
+    ContentHasher hasher(sourceHash);
+    hasher.UpdateValue((uint32_t)settings.Compression);
+    hasher.UpdateValue((uint32_t)settings.BlockCompress);
+    hasher.UpdateValue((uint32_t)sizeof(RTexHeader));
+    return DerivedDataCache::MakeKey("texture-mips", RTexHeader::CurrentVersion, hasher.Finish());
+  }
+
+  bool TextureCooker::Cook(const void* pixels, uint32_t width, uint32_t height, TextureFormat sourceFormat, const TextureCookSettings& settings, std::vector<uint8_t>& outBlob)
+  {
+    if (width == 0 || height == 0 || (sourceFormat != TextureFormat::RGBA8 && sourceFormat != TextureFormat::RGBA32F))
+    {
+      return false;
+    }
+
+    const TextureFormat format = GetCookedFormat(sourceFormat, width, height, settings);
+    const MipFilter filter = GetMipFilter(settings.Compression);
+    const size_t texelSize = sourceFormat == TextureFormat::RGBA32F ? 4 * sizeof(float) : 4;
+
+    RTexHeader header;
+    header.Format = (uint32_t)format;
+    header.Width = width;
+    header.Height = height;
+    header.MipCount = std::min(RenderUtils::CalculateMipCount(width, height), RTexHeader::MaxMipLevels);
+
+    // The whole chain is built first, it is written tail first below. Level 0 is the source itself.
+    std::vector<std::vector<uint8_t>> levels(header.MipCount);
+    auto levelData = [&](uint32_t mip)
+    { return mip == 0 ? (const uint8_t*)pixels : levels[mip].data(); };
+    auto levelBytes = [&](uint32_t mip)
+    { return (size_t)MipGenerator::GetLevelSize(width, mip) * MipGenerator::GetLevelSize(height, mip) * texelSize; };
+
+    for (uint32_t mip = 1; mip < header.MipCount; mip++)
+    {
+      const uint32_t srcWidth = MipGenerator::GetLevelSize(width, mip - 1);
+      const uint32_t srcHeight = MipGenerator::GetLevelSize(height, mip - 1);
+      levels[mip].resize(levelBytes(mip));
+
+      if (sourceFormat == TextureFormat::RGBA32F)
+      {
+        MipGenerator::DownsampleRGBA32F((const float*)levelData(mip - 1), srcWidth, srcHeight, (float*)levels[mip].data());
+      }
+      else
+      {
+        MipGenerator::DownsampleRGBA8(levelData(mip - 1), srcWidth, srcHeight, filter, levels[mip].data());
+      }
+    }
+
+    outBlob.assign(sizeof(RTexHeader), 0);
+    std::vector<uint8_t> padded;
+
+    for (uint32_t mip = header.MipCount; mip-- > 0;)
+    {
+      const uint32_t levelWidth = MipGenerator::GetLevelSize(width, mip);
+      const uint32_t levelHeight = MipGenerator::GetLevelSize(height, mip);
+      const uint64_t offset = (outBlob.size() + kLevelAlignment - 1) & ~(uint64_t)(kLevelAlignment - 1);
+
+      if (TextureUtils::IsBlockCompressed(format))
+      {
+        const uint32_t paddedWidth = (levelWidth + 3) & ~3u;
+        const uint32_t paddedHeight = (levelHeight + 3) & ~3u;
+        const uint64_t size = BlockCompression::GetCompressedSize(paddedWidth, paddedHeight, format);
+
+        outBlob.resize(offset + size);
+        const uint8_t* source = PadToBlocks(levelData(mip), levelWidth, levelHeight, paddedWidth, paddedHeight, padded);
+        BlockCompression::CompressImage(source, paddedWidth, paddedHeight, format, outBlob.data() + offset);
+        header.Levels[mip] = {offset, size};
+      }
+      else
+      {
+        const uint64_t size = levelBytes(mip);
+        outBlob.resize(offset + size);
+        std::memcpy(outBlob.data() + offset, levelData(mip), size);
+        header.Levels[mip] = {offset, size};
+      }
+    }
+
+    std::memcpy(outBlob.data(), &header, sizeof(header));
+    return true;
+  }
+
+  bool TextureCooker::Parse(const uint8_t* data, size_t size, CookedTexture& outTexture)
+  {
+    if (size < sizeof(RTexHeader))
+    {
+      return false;
+    }
+
+    RTexHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.Magic != RTexHeader::FileMagic || header.Version != RTexHeader::CurrentVersion || header.MipCount == 0 ||
+        header.MipCount > RTexHeader::MaxMipLevels || header.Format >= (uint32_t)TextureFormat::Undefined)
+    {
+      return false;
+    }
+
+    // Tail first, the smallest level sits at the lowest offset
+    const uint64_t base = header.Levels[header.MipCount - 1].Offset;
+    outTexture.MipLevels.clear();
+    for (uint32_t mip = 0; mip < header.MipCount; mip++)
+    {
+      const TextureMipLevel& level = header.Levels[mip];
+      if (level.Offset < base || level.Offset + level.Size > size)
+      {
+        return false;
+      }
+      outTexture.MipLevels.push_back({level.Offset - base, level.Size});
+    }
+
+    outTexture.Format = (TextureFormat)header.Format;
+    outTexture.Width = header.Width;
+    outTexture.Height = header.Height;
+    outTexture.Data = data + base;
+    outTexture.DataSize = size - base;
+    return true;
+  }
+}  // namespace Rain
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render/MipGenerator.h"
+#include "render/Texture.h"
+
+namespace Rain
+{
+  // Cooked texture layout, modelled on KTX2: this header with its level index followed by every
+  // mip level in its GPU format, 16-byte aligned. Levels are stored tail first (smallest mip at
+  // the lowest offset), so the low-resolution part of the chain can be read without the top mips.
+  struct RTexHeader
+  {
+    static constexpr uint32_t FileMagic = 0x58455452;  // "RTEX"
+    static constexpr uint32_t CurrentVersion = 2;
+    static constexpr uint32_t MaxMipLevels = 16;
+
+    uint32_t Magic = FileMagic;
+    uint32_t Version = CurrentVersion;
+    uint32_t Format = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t MipCount = 0;
+    TextureMipLevel Levels[MaxMipLevels] = {};
+  };
+
+  // Parsed cooked texture. Data aliases the blob and starts at the smallest level, level offsets
+  // are relative to it and indexed largest first.
+  struct CookedTexture
+  {
+    TextureFormat Format = TextureFormat::Undefined;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    const uint8_t* Data = nullptr;
+    uint64_t DataSize = 0;
+    std::vector<TextureMipLevel> MipLevels;
+  };
+
+  struct TextureCookSettings
+  {
+    TextureCompression Compression = TextureCompression::None;  // Picks the block format and mip filter
+    bool BlockCompress = true;                                   // Off on devices without BC support
+  };
+
+  // Builds the full mip chain of a decoded image on the CPU and stores every level in its GPU
+  // format: block compressed when the settings allow it, RGBA8 or RGBA32F (HDR) otherwise.
+  // Blobs are stored in the DerivedDataCache under GetCacheKey.
+  class TextureCooker
+  {
+   public:
+    // sourceFormat is the decoded format, RGBA8 or RGBA32F
+    static TextureFormat GetCookedFormat(TextureFormat sourceFormat, uint32_t width, uint32_t height, const TextureCookSettings& settings);
+    static MipFilter GetMipFilter(TextureCompression compression);
+
+    // Block formats need a base level that is a whole number of blocks
+    static bool CanBlockCompress(uint32_t width, uint32_t height);
+
+    static std::string GetCacheKey(uint64_t sourceHash, const TextureCookSettings& settings);
+
+    static bool Cook(const void* pixels, uint32_t width, uint32_t height, TextureFormat sourceFormat, const TextureCookSettings& settings, std::vector<uint8_t>& outBlob);
+
+    static bool Parse(const uint8_t* data, size_t size, CookedTexture& outTexture);
+  };
+}  // namespace Rain
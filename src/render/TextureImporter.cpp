@@ -11,27 +11,161 @@
 #endif
 
 #include <stb_image.h>
+#include <cstring>
+#include <vector>
+#include "core/DerivedDataCache.h"
+#include "core/Log.h"
+#include "io/MappedFile.h"
 
 namespace Rain {
+  namespace {
+    // Bump when the decoded payload changes (layout, channel count, color handling)
+    constexpr uint32_t kTextureCacheVersion = 1;
+
+    struct CachedTextureHeader {
+      uint32_t Format = 0;
+      uint32_t Width = 0;
+      uint32_t Height = 0;
+      uint32_t Reserved = 0;
+    };
+  }  // namespace
+
   Buffer TextureImporter::ImportFileToBuffer(const std::filesystem::path& path, TextureFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight) {
     Buffer imageBuffer;
     std::string pathStr = path.string();
 
+    // The file is read once, the same bytes feed the cache key and a decode on a miss
+    MappedFile source;
+    if (!source.Open(pathStr)) {
+      RN_LOG_ERR("TextureImporter: cannot open {}", pathStr);
+      return imageBuffer;
+    }
+
+    ContentHasher hasher;
+    hasher.Update(source.GetData(), source.GetSize());
+    const std::string cacheKey = DerivedDataCache::MakeKey("texture", kTextureCacheVersion, hasher.Finish());
+
+    MappedFile entry;
+    const uint8_t* cached = nullptr;
+    size_t cachedSize = 0;
+    if (DerivedDataCache::GetMapped(cacheKey, entry, cached, cachedSize) && cachedSize >= sizeof(CachedTextureHeader)) {
+      CachedTextureHeader header;
+      std::memcpy(&header, cached, sizeof(header));
+
+      imageBuffer = Buffer::Copy(cached + sizeof(header), cachedSize - sizeof(header));
+      outFormat = (TextureFormat)header.Format;
+      outWidth = header.Width;
+      outHeight = header.Height;
+      return imageBuffer;
+    }
+
     int width, height, channels;
+    const int sourceSize = (int)source.GetSize();
+    const bool isHdr = stbi_is_hdr_from_memory(source.GetData(), sourceSize);
 
-    if (stbi_is_hdr(pathStr.c_str())) {
-      imageBuffer.Data = (byte*)stbi_loadf(pathStr.c_str(), &width, &height, &channels, 4);
-      imageBuffer.Size = width * height * 4 * sizeof(float);
-      outFormat = TextureFormat::RGBA32F;
-    } else {
-      imageBuffer.Data = stbi_load(pathStr.c_str(), &width, &height, &channels, 4 /* force RGBA */);
-      imageBuffer.Size = width * height * 4;
-      outFormat = TextureFormat::RGBA8;
+    void* pixels = isHdr ? (void*)stbi_loadf_from_memory(source.GetData(), sourceSize, &width, &height, &channels, 4)
+                         : (void*)stbi_load_from_memory(source.GetData(), sourceSize, &width, &height, &channels, 4 /* force RGBA */);
+    if (!pixels) {
+      RN_LOG_ERR("TextureImporter: failed to decode {}: {}", pathStr, stbi_failure_reason());
+      return imageBuffer;
     }
 
+    // stb allocates with malloc, callers release the Buffer with delete[], same as a cache hit
+    outFormat = isHdr ? TextureFormat::RGBA32F : TextureFormat::RGBA8;
+    imageBuffer = Buffer::Copy(pixels, (uint64_t)width * height * 4 * (isHdr ? sizeof(float) : 1));
+    stbi_image_free(pixels);
+
     outWidth = width;
     outHeight = height;
 
+    if (DerivedDataCache::IsEnabled()) {
+      CachedTextureHeader header;
+      header.Format = (uint32_t)outFormat;
+      header.Width = outWidth;
+      header.Height = outHeight;
+
+      std::vector<uint8_t> payload(sizeof(header) + imageBuffer.Size);
+      std::memcpy(payload.data(), &header, sizeof(header));
+      std::memcpy(payload.data() + sizeof(header), imageBuffer.Data, imageBuffer.Size);
+      DerivedDataCache::Put(cacheKey, payload.data(), payload.size());
+    }
+
     return imageBuffer;
   }
+
+  Buffer TextureImporter::ImportFileToBuffer(const std::filesystem::path& path, const TextureCookSettings& settings, TextureFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight, std::vector<TextureMipLevel>& outMips) {
+    outMips.clear();
+
+    std::string pathStr = path.string();
+    MappedFile source;
+    if (!source.Open(pathStr)) {
+      RN_LOG_ERR("TextureImporter: cannot open {}", pathStr);
+      return Buffer();
+    }
+
+    ContentHasher hasher;
+    hasher.Update(source.GetData(), source.GetSize());
+    const std::string cacheKey = TextureCooker::GetCacheKey(hasher.Finish(), settings);
+
+    auto fromCooked = [&](const uint8_t* data, size_t size) {
+      CookedTexture cooked;
+      if (!TextureCooker::Parse(data, size, cooked)) {
+        return Buffer();
+      }
+      outFormat = cooked.Format;
+      outWidth = cooked.Width;
+      outHeight = cooked.Height;
+      outMips = std::move(cooked.MipLevels);
+      return Buffer::Copy(cooked.Data, cooked.DataSize);
+    };
+
+    MappedFile entry;
+    const uint8_t* cached = nullptr;
+    size_t cachedSize = 0;
+    if (DerivedDataCache::GetMapped(cacheKey, entry, cached, cachedSize)) {
+      Buffer imageBuffer = fromCooked(cached, cachedSize);
+      if (imageBuffer.Data) {
+        return imageBuffer;
+      }
+    }
+
+    int width, height, channels;
+    const int sourceSize = (int)source.GetSize();
+    const bool isHdr = stbi_is_hdr_from_memory(source.GetData(), sourceSize);
+
+    void* pixels = isHdr ? (void*)stbi_loadf_from_memory(source.GetData(), sourceSize, &width, &height, &channels, 4)
+                         : (void*)stbi_load_from_memory(source.GetData(), sourceSize, &width, &height, &channels, 4 /* force RGBA */);
+    if (!pixels) {
+      RN_LOG_ERR("TextureImporter: failed to decode {}: {}", pathStr, stbi_failure_reason());
+      return Buffer();
+    }
+
+    const TextureFormat sourceFormat = isHdr ? TextureFormat::RGBA32F : TextureFormat::RGBA8;
+    if (settings.BlockCompress && settings.Compression != TextureCompression::None && !isHdr && !TextureCooker::CanBlockCompress(width, height)) {
+      RN_LOG("TextureImporter: {} is {}x{}, not a multiple of 4, keeping it uncompressed", pathStr, width, height);
+    }
+
+    std::vector<uint8_t> blob;
+    const bool cooked = TextureCooker::Cook(pixels, width, height, sourceFormat, settings, blob);
+    stbi_image_free(pixels);
+    if (!cooked) {
+      RN_LOG_ERR("TextureImporter: failed to cook {}", pathStr);
+      return Buffer();
+    }
+
+    DerivedDataCache::Put(cacheKey, blob.data(), blob.size());
+    return fromCooked(blob.data(), blob.size());
+  }
+
+  Buffer TextureImporter::ImportFileToBuffer(const std::filesystem::path& path, TextureProps& props, bool allowBlockCompression, std::vector<TextureMipLevel>& outMips) {
+    outMips.clear();
+    if (!props.GenerateMips && props.Compression == TextureCompression::None) {
+      return ImportFileToBuffer(path, props.Format, props.Width, props.Height);
+    }
+
+    TextureCookSettings settings;
+    settings.Compression = props.Compression;
+    settings.BlockCompress = allowBlockCompression;
+    return ImportFileToBuffer(path, settings, props.Format, props.Width, props.Height, outMips);
+  }
 }  // namespace Rain
@@ -1,12 +1,20 @@
 #pragma once
 #include <filesystem>
+#include <vector>
 #include "core/Buffer.h"
 #include "render/Texture.h"
+#include "render/TextureCooker.h"
 
 namespace Rain {
   class TextureImporter {
    public:
     static Buffer ImportFileToBuffer(const std::filesystem::path& path, TextureFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight);
+    // Cooks the whole mip chain on the CPU, block compressed when the settings allow it. The
+    // buffer holds every level, outMips indexes them.
+    static Buffer ImportFileToBuffer(const std::filesystem::path& path, const TextureCookSettings& settings, TextureFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight, std::vector<TextureMipLevel>& outMips);
+    // Cooks textures that want mips or compression, imports only the base level otherwise.
+    // props receives the format and size.
+    static Buffer ImportFileToBuffer(const std::filesystem::path& path, TextureProps& props, bool allowBlockCompression, std::vector<TextureMipLevel>& outMips);
     static Buffer ImportFileToBufferExp(const std::filesystem::path& path, TextureFormat& outFormat, uint32_t& outWidth, uint32_t& outHeight);
   };
 }  // namespace Rain
@@ -0,0 +1,278 @@
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+#include "core/Assert.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "debug/Profiler.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint64_t kDefaultBudget = 1024ull * 1024 * 1024;
+    constexpr uint64_t kDefaultUploadBudget = 32ull * 1024 * 1024;
+    constexpr uint32_t kNotRequested = UINT32_MAX;
+
+    struct StreamedTexture
+    {
+      std::weak_ptr<Texture2D> Texture;
+      Texture2D* Key = nullptr;
+      uint32_t RequestedMip = kNotRequested;  // Lowest level asked for since the last Update
+      uint32_t WantedMip = 0;                 // Latest request, kept while the texture is not drawn
+      uint64_t LastUsedFrame = 0;
+    };
+
+    struct StreamerState
+    {
+      std::vector<StreamedTexture> Textures;
+      std::unordered_map<Texture2D*, uint32_t> Slots;
+      uint64_t Budget = kDefaultBudget;
+      uint64_t UploadBudget = kDefaultUploadBudget;
+      uint64_t Frame = 0;
+      uint64_t ResidentBytes = 0;
+      TextureStreamingStats Stats;
+    };
+
+    StreamerState s_Streamer;
+
+    // Frees at least bytesNeeded. Textures resident above what they ask for are trimmed first,
+    // then textures not drawn this frame drop to their tail, least recently used first.
+    uint64_t Evict(uint64_t bytesNeeded, uint32_t keepIndex)
+    {
+      struct Candidate
+      {
+        uint32_t Index;
+        bool OverResident;
+      };
+
+      std::vector<Candidate> candidates;
+      for (uint32_t i = 0; i < s_Streamer.Textures.size(); i++)
+      {
+        const StreamedTexture& entry = s_Streamer.Textures[i];
+        Ref<Texture2D> texture = entry.Texture.lock();
+        if (i == keepIndex || !texture)
+        {
+          continue;
+        }
+
+        if (texture->GetResidentMip() < entry.WantedMip)
+        {
+          candidates.push_back({i, true});
+        }
+        else if (entry.LastUsedFrame < s_Streamer.Frame && texture->GetResidentMip() < texture->GetMipTailStart())
+        {
+          candidates.push_back({i, false});
+        }
+      }
+
+      std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+                {
+        if (a.OverResident != b.OverResident)
+        {
+          return a.OverResident;
+        }
+        return s_Streamer.Textures[a.Index].LastUsedFrame < s_Streamer.Textures[b.Index].LastUsedFrame; });
+
+      uint64_t freed = 0;
+      for (const Candidate& candidate : candidates)
+      {
+        if (freed >= bytesNeeded)
+        {
+          break;
+        }
+
+        const StreamedTexture& entry = s_Streamer.Textures[candidate.Index];
+        Ref<Texture2D> texture = entry.Texture.lock();
+        const uint32_t target = candidate.OverResident ? entry.WantedMip : texture->GetMipTailStart();
+        const uint64_t before = texture->GetResidentSize(texture->GetResidentMip());
+
+        texture->SetResidentMip(target);
+        freed += before - texture->GetResidentSize(texture->GetResidentMip());
+        s_Streamer.Stats.Evictions++;
+      }
+
+      s_Streamer.ResidentBytes -= std::min(freed, s_Streamer.ResidentBytes);
+      return freed;
+    }
+  }  // namespace
+
+  void TextureStreamer::Init(uint64_t budgetBytes)
+  {
+    if (budgetBytes == 0)
+    {
+      const char* envBudget = std::getenv("RAIN_TEXTURE_BUDGET_MB");
+      budgetBytes = envBudget ? std::strtoull(envBudget, nullptr, 10) * 1024 * 1024 : kDefaultBudget;
+    }
+
+    s_Streamer.Budget = budgetBytes;
+    RN_LOG("TextureStreamer: {} MB budget", budgetBytes / (1024 * 1024));
+  }
+
+  void TextureStreamer::Shutdown()
+  {
+    s_Streamer.Textures.clear();
+    s_Streamer.Slots.clear();
+    s_Streamer.ResidentBytes = 0;
+  }
+
+  void TextureStreamer::SetBudget(uint64_t budgetBytes)
+  {
+    s_Streamer.Budget = budgetBytes;
+  }
+
+  void TextureStreamer::SetUploadBudget(uint64_t bytesPerFrame)
+  {
+    s_Streamer.UploadBudget = bytesPerFrame;
+  }
+
+  void TextureStreamer::Register(const Ref<Texture2D>& texture)
+  {
+    RN_ASSERT(JobSystem::IsMainThread(), "TextureStreamer::Register must be called on the main thread");
+    if (!texture || !texture->IsStreamable() || s_Streamer.Slots.count(texture.get()))
+    {
+      return;
+    }
+
+    StreamedTexture entry;
+    entry.Texture = texture;
+    entry.Key = texture.get();
+    entry.WantedMip = texture->GetResidentMip();
+    entry.LastUsedFrame = s_Streamer.Frame;
+
+    s_Streamer.Slots[entry.Key] = (uint32_t)s_Streamer.Textures.size();
+    s_Streamer.Textures.push_back(entry);
+    s_Streamer.ResidentBytes += texture->GetResidentSize(texture->GetResidentMip());
+  }
+
+  void TextureStreamer::RequestScreenSize(Texture2D* texture, float screenSize)
+  {
+    const float textureSize = (float)std::max(texture->GetWidth(), texture->GetHeight());
+    const float ratio = textureSize / std::max(screenSize, 1.0f);
+    RequestMip(texture, ratio <= 1.0f ? 0 : (uint32_t)std::floor(std::log2(ratio)));
+  }
+
+  void TextureStreamer::RequestMip(Texture2D* texture, uint32_t mip)
+  {
+    auto slot = s_Streamer.Slots.find(texture);
+    if (slot == s_Streamer.Slots.end())
+    {
+      return;
+    }
+
+    StreamedTexture& entry = s_Streamer.Textures[slot->second];
+    entry.RequestedMip = std::min(entry.RequestedMip, mip);
+    entry.LastUsedFrame = s_Streamer.Frame;
+  }
+
+  void TextureStreamer::Update()
+  {
+    RN_PROFILE_FUNC;
+    TextureStreamingStats& stats = s_Streamer.Stats;
+    stats.Upgrades = 0;
+    stats.Evictions = 0;
+    stats.RequestedBytes = 0;
+
+    // Drop textures that were released, recount residency and fold in this frame's requests
+    s_Streamer.ResidentBytes = 0;
+    std::vector<uint32_t> upgrades;
+    for (uint32_t i = 0; i < s_Streamer.Textures.size();)
+    {
+      StreamedTexture& entry = s_Streamer.Textures[i];
+      Ref<Texture2D> texture = entry.Texture.lock();
+      if (!texture)
+      {
+        s_Streamer.Slots.erase(entry.Key);
+        if (i + 1 < s_Streamer.Textures.size())
+        {
+          entry = s_Streamer.Textures.back();
+          s_Streamer.Slots[entry.Key] = i;
+        }
+        s_Streamer.Textures.pop_back();
+        continue;
+      }
+
+      if (entry.RequestedMip != kNotRequested)
+      {
+        entry.WantedMip = std::min(entry.RequestedMip, texture->GetMipTailStart());
+        entry.RequestedMip = kNotRequested;
+      }
+
+      s_Streamer.ResidentBytes += texture->GetResidentSize(texture->GetResidentMip());
+      stats.RequestedBytes += texture->GetResidentSize(entry.WantedMip);
+      // Only textures drawn last frame are raised, evicted ones wait until they are seen again
+      if (entry.WantedMip < texture->GetResidentMip() && entry.LastUsedFrame == s_Streamer.Frame)
+      {
+        upgrades.push_back(i);
+      }
+      i++;
+    }
+
+    // Textures furthest from what they ask for first
+    std::sort(upgrades.begin(), upgrades.end(), [](uint32_t a, uint32_t b)
+              {
+      const StreamedTexture& entryA = s_Streamer.Textures[a];
+      const StreamedTexture& entryB = s_Streamer.Textures[b];
+      return entryA.Key->GetResidentMip() - entryA.WantedMip > entryB.Key->GetResidentMip() - entryB.WantedMip; });
+
+    uint64_t uploaded = 0;
+    uint32_t pending = 0;
+    for (uint32_t index : upgrades)
+    {
+      const StreamedTexture& entry = s_Streamer.Textures[index];
+      Ref<Texture2D> texture = entry.Texture.lock();
+      const uint64_t residentSize = texture->GetResidentSize(texture->GetResidentMip());
+
+      if (stats.Upgrades > 0 && uploaded >= s_Streamer.UploadBudget)
+      {
+        pending++;
+        continue;
+      }
+
+      const uint64_t wantedSize = texture->GetResidentSize(entry.WantedMip);
+      if (s_Streamer.ResidentBytes + wantedSize - residentSize > s_Streamer.Budget)
+      {
+        Evict(s_Streamer.ResidentBytes + wantedSize - residentSize - s_Streamer.Budget, index);
+      }
+
+      // Step down from the wanted level until the chain fits what the budget has left
+      uint32_t target = entry.WantedMip;
+      while (target < texture->GetResidentMip() && s_Streamer.ResidentBytes + texture->GetResidentSize(target) - residentSize > s_Streamer.Budget)
+      {
+        target++;
+      }
+
+      if (target >= texture->GetResidentMip())
+      {
+        pending++;
+        continue;
+      }
+
+      texture->SetResidentMip(target);
+      const uint64_t newSize = texture->GetResidentSize(target);
+      s_Streamer.ResidentBytes += newSize - residentSize;
+      uploaded += newSize;
+      stats.Upgrades++;
+    }
+
+    // A lowered budget is enforced even when nothing was requested
+    if (s_Streamer.ResidentBytes > s_Streamer.Budget)
+    {
+      Evict(s_Streamer.ResidentBytes - s_Streamer.Budget, UINT32_MAX);
+    }
+
+    stats.StreamedTextures = (uint32_t)s_Streamer.Textures.size();
+    stats.ResidentBytes = s_Streamer.ResidentBytes;
+    stats.BudgetBytes = s_Streamer.Budget;
+    stats.PendingUpgrades = pending;
+    s_Streamer.Frame++;
+  }
+
+  const TextureStreamingStats& TextureStreamer::GetStats()
+  {
+    return s_Streamer.Stats;
+  }
+}  // namespace Rain
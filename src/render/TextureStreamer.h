@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include "core/Ref.h"
+#include "render/Texture.h"
+
+namespace Rain
+{
+  struct TextureStreamingStats
+  {
+    uint32_t StreamedTextures = 0;
+    uint64_t ResidentBytes = 0;
+    uint64_t RequestedBytes = 0;  // Residency the latest requests ask for, may exceed the budget
+    uint64_t BudgetBytes = 0;
+    uint32_t PendingUpgrades = 0;
+    uint32_t Upgrades = 0;  // Last frame
+    uint32_t Evictions = 0;  // Last frame
+  };
+
+  // Per-mip residency for textures loaded with TextureProps::Stream. Textures start with their mip
+  // tail, draw submission requests the level that matches their screen size, and Update raises
+  // requested textures and drops the top mips of the least recently used ones to stay in budget.
+  class TextureStreamer
+  {
+   public:
+    // budgetBytes 0 reads RAIN_TEXTURE_BUDGET_MB, 1 GB by default
+    static void Init(uint64_t budgetBytes = 0);
+    static void Shutdown();
+
+    static void SetBudget(uint64_t budgetBytes);
+    static void SetUploadBudget(uint64_t bytesPerFrame);
+
+    static void Register(const Ref<Texture2D>& texture);
+
+    // screenSize is the projected size of the surface in pixels, the texture is assumed to span it once
+    static void RequestScreenSize(Texture2D* texture, float screenSize);
+    static void RequestMip(Texture2D* texture, uint32_t mip);
+
+    // Once per frame on the main thread
+    static void Update();
+
+    static const TextureStreamingStats& GetStats();
+  };
+}  // namespace Rain
@@ -0,0 +1,344 @@
+#include "UploadRing.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "core/Assert.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include "debug/Profiler.h"
+#include "render/RenderContext.h"
+#include "render/RenderUtils.h"
+
+namespace Rain
+{
+  namespace
+  {
+    constexpr uint32_t kMaxIdleChunks = 8;
+    constexpr uint64_t kBufferCopyAlignment = 4;
+    constexpr uint64_t kTextureCopyAlignment = 256;  // Row pitch of a buffer to texture copy
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+      return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+#ifndef __EMSCRIPTEN__
+    enum class StagingState : uint8_t
+    {
+      Released,
+      Mapped,     // Idle in the pool
+      Recording,  // Holds copies of the open encoder
+      Mapping     // Submitted, waiting for MapAsync
+    };
+
+    struct StagingBuffer
+    {
+      WGPUBuffer Buffer = nullptr;
+      uint64_t Size = 0;
+      uint64_t Used = 0;
+      uint8_t* Mapped = nullptr;
+      StagingState State = StagingState::Released;
+    };
+
+    struct RingState
+    {
+      std::vector<StagingBuffer> Buffers;  // Released entries keep their slot, indices are map callback userdata
+      std::vector<uint32_t> Recording;
+      uint32_t Current = UINT32_MAX;  // Chunk taking new writes
+      WGPUCommandEncoder Encoder = nullptr;
+      uint32_t Epoch = 1;  // Bumped by Shutdown so late map callbacks are ignored
+      UploadRingStats Frame;
+      UploadRingStats Stats;
+    };
+#else
+    struct RingState
+    {
+      UploadRingStats Frame;
+      UploadRingStats Stats;
+    };
+#endif
+
+    RingState s_Ring;
+
+#ifndef __EMSCRIPTEN__
+    uint32_t CreateStaging(uint64_t size)
+    {
+      uint32_t index = 0;
+      while (index < s_Ring.Buffers.size() && s_Ring.Buffers[index].State != StagingState::Released)
+      {
+        index++;
+      }
+      if (index == s_Ring.Buffers.size())
+      {
+        s_Ring.Buffers.emplace_back();
+      }
+
+      WGPUBufferDescriptor bufferDesc = {};
+      bufferDesc.label = RenderUtils::MakeLabel("upload_ring_staging");
+      bufferDesc.usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc;
+      bufferDesc.size = size;
+      bufferDesc.mappedAtCreation = true;
+
+      StagingBuffer& staging = s_Ring.Buffers[index];
+      staging.Buffer = wgpuDeviceCreateBuffer(RenderContext::GetDevice(), &bufferDesc);
+      staging.Size = size;
+      staging.Used = 0;
+      staging.Mapped = static_cast<uint8_t*>(wgpuBufferGetMappedRange(staging.Buffer, 0, size));
+      staging.State = StagingState::Mapped;
+      return index;
+    }
+
+    void ReleaseStaging(uint32_t index)
+    {
+      wgpuBufferRelease(s_Ring.Buffers[index].Buffer);
+      s_Ring.Buffers[index] = StagingBuffer();
+    }
+
+    void OnStagingMapped(WGPUMapAsyncStatus status, WGPUStringView message, void* userdata1, void* userdata2)
+    {
+      if ((uint32_t)(uintptr_t)userdata2 != s_Ring.Epoch)
+      {
+        return;
+      }
+
+      const uint32_t index = (uint32_t)(uintptr_t)userdata1;
+      StagingBuffer& staging = s_Ring.Buffers[index];
+      if (status != WGPUMapAsyncStatus_Success)
+      {
+        RN_LOG_ERR("UploadRing: staging buffer map failed: {}", std::string(message.data, message.length));
+        ReleaseStaging(index);
+        return;
+      }
+
+      // Dedicated buffers of large writes and chunks beyond a burst are not kept around
+      const uint32_t idleChunks = (uint32_t)std::count_if(s_Ring.Buffers.begin(), s_Ring.Buffers.end(), [](const StagingBuffer& buffer)
+                                                          { return buffer.State == StagingState::Mapped; });
+      if (staging.Size > UploadRing::ChunkSize || idleChunks >= kMaxIdleChunks)
+      {
+        ReleaseStaging(index);
+        return;
+      }
+
+      staging.Mapped = static_cast<uint8_t*>(wgpuBufferGetMappedRange(staging.Buffer, 0, staging.Size));
+      staging.Used = 0;
+      staging.State = StagingState::Mapped;
+    }
+
+    // Returns the offset of size bytes in the staging buffer outIndex
+    uint64_t Allocate(uint64_t size, uint64_t alignment, uint32_t& outIndex)
+    {
+      if (s_Ring.Current != UINT32_MAX)
+      {
+        StagingBuffer& current = s_Ring.Buffers[s_Ring.Current];
+        const uint64_t offset = AlignUp(current.Used, alignment);
+        if (offset + size <= current.Size)
+        {
+          current.Used = offset + size;
+          outIndex = s_Ring.Current;
+          return offset;
+        }
+      }
+
+      uint32_t index = UINT32_MAX;
+      for (uint32_t i = 0; i < s_Ring.Buffers.size(); i++)
+      {
+        if (s_Ring.Buffers[i].State == StagingState::Mapped && s_Ring.Buffers[i].Size >= size)
+        {
+          index = i;
+          break;
+        }
+      }
+      if (index == UINT32_MAX)
+      {
+        index = CreateStaging(std::max(UploadRing::ChunkSize, AlignUp(size, kBufferCopyAlignment)));
+      }
+
+      StagingBuffer& staging = s_Ring.Buffers[index];
+      staging.State = StagingState::Recording;
+      staging.Used = size;
+      s_Ring.Recording.push_back(index);
+
+      // A write bigger than a chunk gets a buffer of its own and leaves the current chunk alone
+      if (staging.Size <= UploadRing::ChunkSize)
+      {
+        s_Ring.Current = index;
+      }
+
+      outIndex = index;
+      return 0;
+    }
+
+    WGPUCommandEncoder GetEncoder()
+    {
+      if (s_Ring.Encoder == nullptr)
+      {
+        WGPUCommandEncoderDescriptor encoderDesc = {};
+        encoderDesc.label = RenderUtils::MakeLabel("UploadRing");
+        s_Ring.Encoder = wgpuDeviceCreateCommandEncoder(RenderContext::GetDevice(), &encoderDesc);
+      }
+      return s_Ring.Encoder;
+    }
+#endif
+  }  // namespace
+
+  void UploadRing::Shutdown()
+  {
+#ifndef __EMSCRIPTEN__
+    if (s_Ring.Encoder)
+    {
+      wgpuCommandEncoderRelease(s_Ring.Encoder);
+    }
+    for (const StagingBuffer& staging : s_Ring.Buffers)
+    {
+      if (staging.Buffer)
+      {
+        wgpuBufferRelease(staging.Buffer);
+      }
+    }
+
+    const uint32_t epoch = s_Ring.Epoch + 1;
+    s_Ring = RingState();
+    s_Ring.Epoch = epoch;
+#else
+    s_Ring = RingState();
+#endif
+  }
+
+  void UploadRing::BeginFrame()
+  {
+    s_Ring.Stats = s_Ring.Frame;
+    s_Ring.Frame = UploadRingStats();
+
+#ifndef __EMSCRIPTEN__
+    for (const StagingBuffer& staging : s_Ring.Buffers)
+    {
+      if (staging.Buffer)
+      {
+        s_Ring.Stats.StagingBuffers++;
+        s_Ring.Stats.StagingBytes += staging.Size;
+      }
+    }
+#endif
+  }
+
+  void UploadRing::WriteBuffer(WGPUBuffer target, uint64_t offset, const void* data, uint64_t size)
+  {
+    RN_ASSERT(JobSystem::IsMainThread(), "UploadRing::WriteBuffer must be called on the main thread");
+    RN_ASSERT(offset % kBufferCopyAlignment == 0 && size % kBufferCopyAlignment == 0, "UploadRing: buffer writes must be 4 byte aligned");
+    if (size == 0)
+    {
+      return;
+    }
+
+#ifndef __EMSCRIPTEN__
+    uint32_t index;
+    const uint64_t stagingOffset = Allocate(size, kBufferCopyAlignment, index);
+    const StagingBuffer& staging = s_Ring.Buffers[index];
+
+    std::memcpy(staging.Mapped + stagingOffset, data, size);
+    wgpuCommandEncoderCopyBufferToBuffer(GetEncoder(), staging.Buffer, stagingOffset, target, offset, size);
+#else
+    wgpuQueueWriteBuffer(*RenderContext::GetQueue(), target, offset, data, size);
+#endif
+
+    s_Ring.Frame.BytesUploaded += size;
+    s_Ring.Frame.Copies++;
+  }
+
+  void UploadRing::WriteTexture(WGPUTexture target, uint32_t mip, uint32_t layer, uint32_t width, uint32_t height, const void* data, uint32_t bytesPerRow, uint32_t rowCount)
+  {
+    RN_ASSERT(JobSystem::IsMainThread(), "UploadRing::WriteTexture must be called on the main thread");
+    const uint64_t dataSize = (uint64_t)bytesPerRow * rowCount;
+    const WGPUExtent3D copySize = {.width = width, .height = height, .depthOrArrayLayers = 1};
+
+#ifndef __EMSCRIPTEN__
+    const uint32_t pitch = (uint32_t)AlignUp(bytesPerRow, kTextureCopyAlignment);
+    uint32_t index;
+    const uint64_t stagingOffset = Allocate((uint64_t)pitch * rowCount, kTextureCopyAlignment, index);
+    const StagingBuffer& staging = s_Ring.Buffers[index];
+
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    if (pitch == bytesPerRow)
+    {
+      std::memcpy(staging.Mapped + stagingOffset, source, dataSize);
+    }
+    else
+    {
+      for (uint32_t row = 0; row < rowCount; row++)
+      {
+        std::memcpy(staging.Mapped + stagingOffset + (uint64_t)row * pitch, source + (uint64_t)row * bytesPerRow, bytesPerRow);
+      }
+    }
+
+    const WGPUTexelCopyBufferInfo copySource = {
+        .layout = {.offset = stagingOffset, .bytesPerRow = pitch, .rowsPerImage = rowCount},
+        .buffer = staging.Buffer};
+    const WGPUTexelCopyTextureInfo copyDest = {
+        .texture = target,
+        .mipLevel = mip,
+        .origin = {0, 0, layer},
+        .aspect = WGPUTextureAspect_All};
+    wgpuCommandEncoderCopyBufferToTexture(GetEncoder(), &copySource, &copyDest, &copySize);
+#else
+    const WGPUImageCopyTexture copyDest = {
+        .texture = target,
+        .mipLevel = mip,
+        .origin = {0, 0, layer},
+        .aspect = WGPUTextureAspect_All};
+    const WGPUTextureDataLayout layout = {.offset = 0, .bytesPerRow = bytesPerRow, .rowsPerImage = rowCount};
+    wgpuQueueWriteTexture(*RenderContext::GetQueue(), &copyDest, data, dataSize, &layout, &copySize);
+#endif
+
+    s_Ring.Frame.BytesUploaded += dataSize;
+    s_Ring.Frame.Copies++;
+  }
+
+  void UploadRing::Flush()
+  {
+#ifndef __EMSCRIPTEN__
+    if (s_Ring.Encoder == nullptr)
+    {
+      return;
+    }
+
+    RN_PROFILE_FUNC;
+    for (uint32_t index : s_Ring.Recording)
+    {
+      wgpuBufferUnmap(s_Ring.Buffers[index].Buffer);
+      s_Ring.Buffers[index].Mapped = nullptr;
+    }
+
+    WGPUCommandBufferDescriptor cmdBufferDescriptor = {};
+    cmdBufferDescriptor.label = RenderUtils::MakeLabel("UploadRing");
+    WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(s_Ring.Encoder, &cmdBufferDescriptor);
+    wgpuQueueSubmit(*RenderContext::GetQueue(), 1, &commandBuffer);
+    wgpuCommandBufferRelease(commandBuffer);
+    wgpuCommandEncoderRelease(s_Ring.Encoder);
+    s_Ring.Encoder = nullptr;
+
+    // The map completes once the copies above have run, the buffer is then free to refill
+    for (uint32_t index : s_Ring.Recording)
+    {
+      StagingBuffer& staging = s_Ring.Buffers[index];
+      staging.State = StagingState::Mapping;
+
+      WGPUBufferMapCallbackInfo callbackInfo = {};
+      callbackInfo.mode = WGPUCallbackMode_AllowProcessEvents;
+      callbackInfo.callback = &OnStagingMapped;
+      callbackInfo.userdata1 = (void*)(uintptr_t)index;
+      callbackInfo.userdata2 = (void*)(uintptr_t)s_Ring.Epoch;
+      wgpuBufferMapAsync(staging.Buffer, WGPUMapMode_Write, 0, staging.Size, callbackInfo);
+    }
+
+    s_Ring.Recording.clear();
+    s_Ring.Current = UINT32_MAX;
+    s_Ring.Frame.Submits++;
+#endif
+  }
+
+  const UploadRingStats& UploadRing::GetStats()
+  {
+    return s_Ring.Stats;
+  }
+}  // namespace Rain
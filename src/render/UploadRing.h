@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <webgpu/webgpu.h>
+
+namespace Rain
+{
+  struct UploadRingStats
+  {
+    uint64_t BytesUploaded = 0;  // Last frame
+    uint32_t Copies = 0;         // Last frame
+    uint32_t Submits = 0;        // Last frame, command buffers holding the copies
+    uint32_t StagingBuffers = 0;
+    uint64_t StagingBytes = 0;
+  };
+
+  // Staging for every CPU to GPU write. Data is copied into mapped MapWrite buffers and recorded
+  // as buffer/texture copies on one encoder, which Flush submits ahead of any work that reads it.
+  // A submitted staging buffer is mapped again with MapAsync and returns to the pool once the
+  // map completes, which is after the GPU finished the copies. Writes keep queue write ordering
+  // as long as Flush runs before every queue submit.
+  // Emscripten builds write through the queue directly.
+  class UploadRing
+  {
+   public:
+    static constexpr uint64_t ChunkSize = 4ull * 1024 * 1024;
+
+    static void Shutdown();
+
+    // Once per frame on the main thread, publishes the previous frame's stats
+    static void BeginFrame();
+
+    // Offset and size must be multiples of 4, same as a queue write
+    static void WriteBuffer(WGPUBuffer target, uint64_t offset, const void* data, uint64_t size);
+
+    // rowCount rows of bytesPerRow bytes (block rows for compressed formats), width and height
+    // cover whole blocks. Rows are repacked to the 256 byte pitch a buffer copy needs.
+    static void WriteTexture(WGPUTexture target, uint32_t mip, uint32_t layer, uint32_t width, uint32_t height, const void* data, uint32_t bytesPerRow, uint32_t rowCount);
+
+    // Submits the copies recorded so far
+    static void Flush();
+
+    static const UploadRingStats& GetStats();
+  };
+}  // namespace Rain
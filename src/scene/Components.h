@@ -102,6 +102,30 @@ namespace Rain {
     }
   };
 
+  // World matrix cached by Scene::UpdateWorldTransforms. The local TRS it was built from is
+  // kept alongside, so edits made directly on TransformComponent are picked up without a setter.
+  struct WorldTransformComponent {
+    glm::mat4 Transform = glm::mat4(1.0f);
+    glm::vec3 LocalTranslation = {0.0f, 0.0f, 0.0f};
+    glm::vec3 LocalScale = {1.0f, 1.0f, 1.0f};
+    glm::quat LocalRotation = {1.0f, 0.0f, 0.0f, 0.0f};
+
+    // Set on creation and reparenting
+    bool Dirty = true;
+    // Recomputed during the current pass, children read it to follow their parent
+    bool Changed = false;
+
+    bool Matches(const TransformComponent& local) const {
+      return LocalTranslation == local.Translation && LocalRotation == local.Rotation && LocalScale == local.Scale;
+    }
+
+    void Capture(const TransformComponent& local) {
+      LocalTranslation = local.Translation;
+      LocalRotation = local.Rotation;
+      LocalScale = local.Scale;
+    }
+  };
+
   enum EBodyType {
     Dynamic,
     Static
@@ -163,16 +187,6 @@ namespace Rain {
     float Mass = 4000.0f;
   };
 
-  struct RelationshipComponent {
-    UUID ParentHandle = 0;
-    std::vector<UUID> Children;
-
-    RelationshipComponent() = default;
-    RelationshipComponent(const RelationshipComponent& other) = default;
-    RelationshipComponent(UUID parent)
-        : ParentHandle(parent) {}
-  };
-
   struct CameraComponent {
     enum class Type { None = -1,
                       Perspective,
@@ -193,6 +207,7 @@ namespace Rain {
     Ref<MaterialTable> Materials = CreateRef<MaterialTable>();
     uint64_t MeshSourceId = -1;
     uint32_t SubMeshId = -1;
+    uint32_t Lod = 0;  // Level selected last frame, runtime only
 
     MeshComponent(uint64_t meshSourceId = -1, uint32_t subMeshId = -1, uint32_t materialId = -1)
         : SubMeshId(subMeshId), MeshSourceId(meshSourceId) {}
@@ -202,8 +217,14 @@ namespace Rain {
     float Intensity = 0.0f;
   };
 
+  // Lives on the root entity of an animated mesh hierarchy
   struct AnimatorComponent {
     Ref<OzzAnimator> Animator;
     bool Playing = true;
   };
+
+  // Submesh entities skin against the palette of the root's animator
+  struct SkinnedMeshComponent {
+    UUID AnimatorEntity = 0;
+  };
 }  // namespace Rain
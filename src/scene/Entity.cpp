@@ -7,6 +7,12 @@ namespace Rain {
   }
 
   Entity Entity::GetParent() const {
-    return m_Scene->TryGetEntityWithUUID(GetParentUUID());
+    flecs::entity parent = m_Entity.parent();
+    return parent ? Entity(parent, m_Scene) : Entity();
+  }
+
+  UUID Entity::GetParentUUID() const {
+    Entity parent = GetParent();
+    return parent ? parent.GetUUID() : UUID(0);
   }
 }  // namespace Rain
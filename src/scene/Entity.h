@@ -1,8 +1,6 @@
 #pragma once
 
 #include <flecs.h>
-#include <algorithm>
-#include <vector>
 #include "Components.h"
 #include "core/UUID.h"
 
@@ -59,53 +57,35 @@ namespace Rain
     }
 
     Entity GetParent() const;
-    UUID GetChild(int index) { return Children()[index]; }
-
-    bool RemoveChild(Entity child)
-    {
-      UUID childId = child.GetUUID();
-      std::vector<UUID>& children = Children();
-      auto it = std::find(children.begin(), children.end(), childId);
-      if (it != children.end())
-      {
-        children.erase(it);
-        return true;
-      }
-
-      return false;
-    }
+    UUID GetParentUUID() const;
 
+    // Parenting is a flecs ChildOf pair, so children live in their parent's archetype group
+    // and destroying the parent destroys the whole subtree
     void SetParent(Entity parent)
     {
-      Entity currentParent = GetParent();
-
-      if (currentParent == parent)
+      if (parent)
       {
-        return;
+        m_Entity.child_of(parent.m_Entity);
       }
-
-      if (currentParent)
+      else
       {
-        currentParent.RemoveChild(*this);
+        m_Entity.remove(flecs::ChildOf, flecs::Wildcard);
       }
 
-      SetParentUUID(parent.GetUUID());
+      GetComponent<WorldTransformComponent>().Dirty = true;
+    }
 
-      if (parent)
-      {
-        auto& parentChildren = parent.Children();
-        UUID uuid = GetUUID();
-        if (std::find(parentChildren.begin(), parentChildren.end(), uuid) == parentChildren.end())
-        {
-          parentChildren.emplace_back(GetUUID());
-        }
-      }
+    template <typename Func>
+    void EachChild(Func&& func) const
+    {
+      m_Entity.children([&](flecs::entity child)
+                        { func(Entity(child, m_Scene)); });
     }
 
+    uint32_t GetChildCount() const { return (uint32_t)m_Entity.world().count(flecs::ChildOf, m_Entity); }
+    bool HasChildren() const { return GetChildCount() > 0; }
+
     const std::string Name() const { return HasComponent<TagComponent>() ? GetComponent<TagComponent>().Tag : NoName; }
-    void SetParentUUID(UUID parent) { GetComponent<RelationshipComponent>().ParentHandle = parent; }
-    std::vector<UUID>& Children() { return GetComponent<RelationshipComponent>().Children; }
-    UUID GetParentUUID() const { return GetComponent<RelationshipComponent>().ParentHandle; }
     UUID GetUUID() const { return GetComponent<IDComponent>().ID; }
 
     TransformComponent& Transform() { return GetComponent<TransformComponent>(); }
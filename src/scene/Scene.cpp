@@ -4,12 +4,15 @@
 #include "Entity.h"
 #include "SceneRenderer.h"
 #include "animation/OzzAnimator.h"
+#include "core/JobSystem.h"
 #include "debug/Profiler.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "imgui.h"
 #include "io/cursor.h"
 #include "render/ResourceManager.h"
 
+#include <algorithm>
+
 // #include "ImGuizmo.h"
 
 // Jolt includes
@@ -18,7 +21,19 @@ namespace Rain
   Scene* Scene::Instance = nullptr;
 
   Scene::Scene(std::string sceneName)
-      : m_Name(sceneName) {}
+      : m_Name(sceneName)
+  {
+    m_WorldTransformQuery = m_World.query_builder<const TransformComponent, const WorldTransformComponent, WorldTransformComponent>()
+                                .term_at(1)
+                                .parent()
+                                .cascade()
+                                .optional()
+                                .build();
+
+    m_RootQuery = m_World.query_builder<IDComponent>()
+                      .without(flecs::ChildOf, flecs::Wildcard)
+                      .build();
+  }
 
   Entity Scene::CreateEntity(std::string name)
   {
@@ -35,10 +50,6 @@ namespace Rain
     auto camera = CreateEntity("MainCamera");
     camera.AddComponent<CameraComponent>();
 
-    auto testModel = Rain::ResourceManager::LoadMeshSource(RESOURCE_DIR "/test2/untitled.gltf");
-    auto boxModel = Rain::ResourceManager::LoadMeshSource(RESOURCE_DIR "/box.gltf");
-    auto weaponModel = Rain::ResourceManager::LoadMeshSource(RESOURCE_DIR "/assault_rifle_pbr/scene.gltf");
-
     Entity modelEntity = CreateEntity("bump");
     Entity floorEntity = CreateEntity("box");
     Entity weaponEntity = CreateEntity("weapon");
@@ -54,9 +65,10 @@ namespace Rain
     weaponEntity.Transform().Scale = glm::vec3(3.0f);
     weaponEntity.Transform().SetRotationEuler(glm::radians(glm::vec3(-90.0, 0.0, 0.0)));
 
-    BuildMeshEntityHierarchy(modelEntity, testModel);
-    BuildMeshEntityHierarchy(floorEntity, boxModel);
-    BuildMeshEntityHierarchy(weaponEntity, weaponModel);
+    // The models load in parallel in the background, each entity gets its hierarchy once ready
+    LoadMeshEntityAsync(modelEntity, RESOURCE_DIR "/test2/untitled.gltf");
+    LoadMeshEntityAsync(floorEntity, RESOURCE_DIR "/box.gltf");
+    LoadMeshEntityAsync(weaponEntity, RESOURCE_DIR "/assault_rifle_pbr/scene.gltf");
 
     Entity light = CreateEntity("DirectionalLight");
     light.Transform().Translation = glm::vec3(0, 15, 0);
@@ -71,12 +83,12 @@ namespace Rain
     uint32_t entityHandle = entity;
 
     entity.AddComponent<TransformComponent>();
+    entity.AddComponent<WorldTransformComponent>();
     if (!name.empty())
     {
       TagComponent& tagComponent = entity.AddComponent<TagComponent>();
       tagComponent.Tag = name;
     }
-    entity.AddComponent<RelationshipComponent>();
     IDComponent& idComponent = entity.AddComponent<IDComponent>();
     idComponent.ID = {};
 
@@ -91,6 +103,20 @@ namespace Rain
     return entity;
   }
 
+  void Scene::DestroyEntity(Entity entity)
+  {
+    // flecs deletes ChildOf children with their parent, only the UUID lookup needs the subtree
+    std::vector<Entity> subtree = {entity};
+    for (size_t i = 0; i < subtree.size(); i++)
+    {
+      m_EntityMap.erase(subtree[i].GetUUID());
+      subtree[i].EachChild([&subtree](Entity child)
+                           { subtree.push_back(child); });
+    }
+
+    entity.m_Entity.destruct();
+  }
+
   Entity Scene::TryGetEntityWithUUID(UUID id) const
   {
     if (const auto iter = m_EntityMap.find(id); iter != m_EntityMap.end())
@@ -136,15 +162,35 @@ namespace Rain
 
     // Update all animators
     float dt = Application::Get()->GetDeltaTime();
-    m_World.query<AnimatorComponent>().each([dt](AnimatorComponent& ac)
+    UpdateAnimators(dt, ++m_FrameIndex);
+
+    m_PhysicsScene->Update(1.0f / 60.0);
+    UpdateWorldTransforms();
+    Cursor::Update();
+  }
+
+  void Scene::UpdateAnimators(float dt, uint64_t frameIndex)
+  {
+    RN_PROFILE_FUNC;
+    m_AnimatorUpdateList.clear();
+    m_World.query<AnimatorComponent>().each([this](AnimatorComponent& ac)
                                             {
       if (ac.Playing && ac.Animator)
       {
-        ac.Animator->Update(dt);
+        m_AnimatorUpdateList.push_back(ac.Animator.get());
       } });
 
-    m_PhysicsScene->Update(1.0f / 60.0);
-    Cursor::Update();
+    // The frame stamp is not thread safe, so a shared animator must only be scheduled once
+    std::sort(m_AnimatorUpdateList.begin(), m_AnimatorUpdateList.end());
+    m_AnimatorUpdateList.erase(std::unique(m_AnimatorUpdateList.begin(), m_AnimatorUpdateList.end()), m_AnimatorUpdateList.end());
+
+    // Joined inside ParallelFor so every palette is final before SceneRenderer::BeginScene
+    JobSystem::ParallelFor((uint32_t)m_AnimatorUpdateList.size(), 4, [this, dt, frameIndex](uint32_t begin, uint32_t end)
+                           {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        m_AnimatorUpdateList[i]->Update(dt, frameIndex);
+      } });
   }
 
   glm::mat4 Scene::EditTransform(glm::mat4& matrix)
@@ -170,6 +216,9 @@ namespace Rain
     RN_PROFILE_FUNC;
     renderer->SetScene(this);
 
+    // Picks up transforms edited since OnUpdate (editor panels, gizmo)
+    UpdateWorldTransforms();
+
     auto far = 400.0f;
     Entity cameraEntity = GetMainCameraEntity();
     Camera& camera = cameraEntity.GetComponent<CameraComponent>();
@@ -183,22 +232,23 @@ namespace Rain
     camera.SetPerspectiveProjectionMatrix(glm::radians(55.0f), w, h, 0.10f, far);
     renderer->BeginScene({cameraViewMatrix, camera.GetProjectionMatrix(), 10.0f, far});
 
-    static flecs::query<TransformComponent, MeshComponent> drawNodeQuery = m_World.query<TransformComponent, MeshComponent>();
-    drawNodeQuery.each([&](flecs::entity entity, TransformComponent& transform, MeshComponent& meshComponent)
+    static flecs::query<WorldTransformComponent, MeshComponent> drawNodeQuery = m_World.query<WorldTransformComponent, MeshComponent>();
+    drawNodeQuery.each([&](flecs::entity entity, WorldTransformComponent& worldTransform, MeshComponent& meshComponent)
                        {
-      Entity e = Entity(entity, this);
       Ref<MeshSource> meshSource = Rain::ResourceManager::GetMeshSource(meshComponent.MeshSourceId);
-      glm::mat4 entityTransform = GetWorldSpaceTransformMatrix(e);
 
-      // Check if this entity has an animator component
+      // Skinned submeshes use the animator owned by their hierarchy root
       Ref<OzzAnimator> animator = nullptr;
-      if (entity.has<AnimatorComponent>())
+      if (entity.has<SkinnedMeshComponent>())
       {
-      auto animComp = entity.get<AnimatorComponent>();
-      animator = animComp.Animator;
+        Entity animatorEntity = TryGetEntityWithUUID(entity.get<SkinnedMeshComponent>().AnimatorEntity);
+        if (animatorEntity && animatorEntity.HasComponent<AnimatorComponent>())
+        {
+          animator = animatorEntity.GetComponent<AnimatorComponent>().Animator;
+        }
       }
 
-      renderer->SubmitMesh(meshSource, meshComponent.SubMeshId, meshComponent.Materials, entityTransform, animator); });
+      renderer->SubmitMesh(meshSource, meshComponent.SubMeshId, meshComponent.Materials, worldTransform.Transform, animator, &meshComponent.Lod); });
 
     Entity lightEntity = TryGetEntityWithUUID(entityIdDir);
     const auto lightTransform = lightEntity.GetComponent<TransformComponent>();
@@ -210,6 +260,18 @@ namespace Rain
     renderer->EndScene();
   }
 
+  void Scene::LoadMeshEntityAsync(Entity parent, const std::string& path)
+  {
+    std::weak_ptr<bool> sceneAlive = m_LifetimeToken;
+    Rain::ResourceManager::LoadMeshSourceAsync(path)->Then([this, sceneAlive, parent](Ref<MeshSource> mesh)
+                                                           {
+      // The scene, or just the entity, may have been destroyed while the mesh was loading
+      if (!sceneAlive.expired() && parent)
+      {
+        BuildMeshEntityHierarchy(parent, mesh);
+      } });
+  }
+
   void Scene::BuildMeshEntityHierarchy(Entity parent, Ref<MeshSource> mesh)
   {
     const std::vector<Ref<MeshNode>> nodes = mesh->GetNodes();
@@ -233,6 +295,14 @@ namespace Rain
       }
     }
 
+    // One animator per hierarchy, owned by the root
+    if (animator)
+    {
+      AnimatorComponent& animComp = parent.AddComponent<AnimatorComponent>();
+      animComp.Animator = animator;
+      animComp.Playing = true;
+    }
+
     for (const Ref<MeshNode> node : mesh->GetNodes())
     {
       if (node->IsRoot() && mesh->m_SubMeshes[node->SubMeshId].VertexCount == 0)
@@ -247,32 +317,43 @@ namespace Rain
 
       nodeEntity.Transform().SetTransform(node->LocalTransform);
 
-      // Attach animator to all mesh entities so animation works for all submeshes
       if (animator)
       {
-        AnimatorComponent& animComp = nodeEntity.AddComponent<AnimatorComponent>();
-        animComp.Animator = animator;
-        animComp.Playing = true;
+        nodeEntity.AddComponent<SkinnedMeshComponent>().AnimatorEntity = parent.GetUUID();
       }
     }
   }
 
   glm::mat4 Scene::GetWorldSpaceTransformMatrix(Entity entity)
   {
-    glm::mat4 transform = glm::identity<glm::mat4>();
-
-    Entity parent = TryGetEntityWithUUID(entity.GetParentUUID());
-    if (parent)
+    // Entities created or reparented since the last update have no valid cache yet
+    if (entity.GetComponent<WorldTransformComponent>().Dirty)
     {
-      transform = GetWorldSpaceTransformMatrix(parent);
+      UpdateWorldTransforms();
     }
 
-    return transform * entity.GetComponent<TransformComponent>().GetTransform();
+    return entity.GetComponent<WorldTransformComponent>().Transform;
+  }
+
+  void Scene::UpdateWorldTransforms()
+  {
+    RN_PROFILE_FUNC;
+    m_WorldTransformQuery.each([](const TransformComponent& local, const WorldTransformComponent* parent, WorldTransformComponent& world)
+                               {
+      world.Changed = world.Dirty || (parent && parent->Changed) || !world.Matches(local);
+      if (!world.Changed)
+      {
+        return;
+      }
+
+      world.Capture(local);
+      world.Dirty = false;
+      world.Transform = parent ? parent->Transform * local.GetTransform() : local.GetTransform(); });
   }
 
   void Scene::ConvertToLocalSpace(Entity entity)
   {
-    Entity parent = TryGetEntityWithUUID(entity.GetParentUUID());
+    Entity parent = entity.GetParent();
 
     if (!parent)
     {
@@ -13,6 +13,7 @@ namespace Rain
 {
 
   class SceneRenderer;
+  class OzzAnimator;
 
   struct LightInfo
   {
@@ -27,6 +28,7 @@ namespace Rain
 
     Entity CreateEntity(std::string name);
     Entity CreateChildEntity(Entity parent, std::string name);
+    void DestroyEntity(Entity entity);
 
     void Init();
 
@@ -34,11 +36,14 @@ namespace Rain
     void OnRender(Ref<SceneRenderer> renderer, const glm::mat4& editorViewMatrix = glm::mat4(0.0f));
 
     void BuildMeshEntityHierarchy(Entity parent, Ref<MeshSource> mesh);
+    void LoadMeshEntityAsync(Entity parent, const std::string& path);
     Entity TryGetEntityWithUUID(UUID id) const;
+    // Returns the cached world matrix as of the last UpdateWorldTransforms
     glm::mat4 GetWorldSpaceTransformMatrix(Entity entity);
     TransformComponent GetWorldSpaceTransform(Entity entity);
     glm::mat4 EditTransform(glm::mat4& matrix);
     void ConvertToLocalSpace(Entity entity);
+    void UpdateWorldTransforms();
     Entity GetMainCameraEntity();
 
     std::pair<glm::vec3, glm::vec3> CastRay(Entity& cameraEntity, float mx, float my);
@@ -48,6 +53,13 @@ namespace Rain
     std::unique_ptr<Camera> m_SceneCamera;
     static Scene* Instance;
 
+    template <typename Func>
+    void EachRootEntity(Func&& func)
+    {
+      m_RootQuery.each([this, &func](flecs::entity e, IDComponent&)
+                       { func(Entity(e, this)); });
+    }
+
     template <typename... Components>
     std::vector<Entity> GetAllEntitiesWithComponent()  // Debug purposes
     {
@@ -58,10 +70,23 @@ namespace Rain
     }
 
    private:
+    void UpdateAnimators(float dt, uint64_t frameIndex);
+
     std::unordered_map<UUID, Entity> m_EntityMap;
     flecs::world m_World;
     std::string m_Name;
     Ref<PhysicsScene> m_PhysicsScene;
+    // Expires with the scene, async load callbacks hold a weak_ptr to it instead of trusting this
+    Ref<bool> m_LifetimeToken = CreateRef<bool>(true);
+    uint64_t m_FrameIndex = 0;
+
+    // Animators are gathered on the main thread and evaluated on the job system
+    std::vector<OzzAnimator*> m_AnimatorUpdateList;
+
+    // Cascade over ChildOf visits parents before their children, breadth first
+    flecs::query<const TransformComponent, const WorldTransformComponent, WorldTransformComponent> m_WorldTransformQuery;
+    flecs::query<IDComponent> m_RootQuery;
+
     friend class Entity;
   };
 }  // namespace Rain
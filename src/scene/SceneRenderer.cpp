@@ -1,4 +1,5 @@
 #include "SceneRenderer.h"
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <memory>
 #include "Application.h"
@@ -7,14 +8,17 @@
 #include "backends/imgui_impl_wgpu.h"
 #include "imgui.h"
 
+#include "core/RadixSort.h"
 #include "debug/Profiler.h"
 #include "io/filesystem.h"
 #include "io/keyboard.h"
 #include "render/CommandEncoder.h"
 #include "render/Framebuffer.h"
+#include "render/MaterialConstants.h"
 #include "render/Render.h"
 #include "render/ResourceManager.h"
 #include "render/ShaderManager.h"
+#include "render/TextureStreamer.h"
 
 namespace Rain
 {
@@ -28,6 +32,9 @@ namespace Rain
   };
   float m_ScaleShadowCascadesToOrigin = 0.0f;
 
+  // Relative band around the LOD pixel error that an instance must cross before it switches level
+  constexpr float kLodHysteresis = 0.25f;
+
   void CalculateCascades(CascadeData* cascades, const SceneCamera& sceneCamera, glm::vec3 lightDirection)
   {
     float scaleToOrigin = m_ScaleShadowCascadesToOrigin;
@@ -170,43 +177,55 @@ namespace Rain
     }
   }
 
-  void SceneRenderer::SubmitMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator)
+  void SceneRenderer::SubmitMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator, uint32_t* lodState)
   {
     // Route skeletal meshes to the skeletal draw list
     if (meshSource->HasSkeleton())
     {
-      SubmitSkeletalMesh(meshSource, submeshIndex, materialTable, transform, animator);
+      SubmitSkeletalMesh(meshSource, submeshIndex, materialTable, transform, animator, lodState);
       return;
     }
 
     const auto& submesh = meshSource->m_SubMeshes[submeshIndex];
     const auto materialHandle = materialTable->HasMaterial(submesh.MaterialIndex) ? materialTable->GetMaterial(submesh.MaterialIndex) : meshSource->Materials->GetMaterial(submesh.MaterialIndex);
 
-    MeshKey meshKey = {meshSource->Id, materialHandle->Id, submeshIndex};
-
-    auto& transformStorage = m_MeshTransformMap[meshKey].Transforms.emplace_back();
-
-    transformStorage.MRow[0] = {transform[0][0], transform[1][0], transform[2][0], transform[3][0]};
-    transformStorage.MRow[1] = {transform[0][1], transform[1][1], transform[2][1], transform[3][1]};
-    transformStorage.MRow[2] = {transform[0][2], transform[1][2], transform[2][2], transform[3][2]};
-
-    auto& drawCommand = m_DrawList[meshKey];
-
-    drawCommand.Mesh = meshSource;
-    drawCommand.SubmeshIndex = submeshIndex;
-    drawCommand.Materials = materialTable;
-    drawCommand.InstanceCount++;
+    auto& submission = m_MeshSubmissions.emplace_back();
+    submission.Mesh = meshSource;
+    submission.SubmeshIndex = submeshIndex;
+    submission.Materials = materialTable;
+    submission.MaterialHandle = materialHandle->Id;
+    submission.MaterialInstance = materialHandle.get();
+
+    submission.Transform.MRow[0] = {transform[0][0], transform[1][0], transform[2][0], transform[3][0]};
+    submission.Transform.MRow[1] = {transform[0][1], transform[1][1], transform[2][1], transform[3][1]};
+    submission.Transform.MRow[2] = {transform[0][2], transform[1][2], transform[2][2], transform[3][2]};
+    submission.Transform.PositionOffset = glm::vec4(submesh.GetPositionOffset(), 0.0f);
+    submission.Transform.PositionScale = submesh.GetPositionScale();
+    submission.Transform.MaterialIndex = materialHandle->GetConstantsIndex();
+
+    glm::vec3 worldCenter, worldExtents;
+    Math::TransformBounds(transform, submesh.BoundingBox.GetCenter(), submesh.BoundingBox.GetExtents(), worldCenter, worldExtents);
+    m_SubmissionBounds.Push(worldCenter, worldExtents);
+    submission.Lod = SelectLod(submesh, GetScreenSize(worldCenter, worldExtents), lodState);
   }
 
-  void SceneRenderer::SubmitSkeletalMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator)
+  void SceneRenderer::SubmitSkeletalMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator, uint32_t* lodState)
   {
-    SkeletalDrawCommand cmd;
+    const auto& submesh = meshSource->m_SubMeshes[submeshIndex];
+    const auto materialHandle = materialTable->HasMaterial(submesh.MaterialIndex) ? materialTable->GetMaterial(submesh.MaterialIndex) : meshSource->Materials->GetMaterial(submesh.MaterialIndex);
+
+    auto& cmd = m_SkeletalSubmissions.emplace_back();
     cmd.Mesh = meshSource;
     cmd.SubmeshIndex = submeshIndex;
     cmd.Materials = materialTable;
+    cmd.MaterialHandle = materialHandle->Id;
+    cmd.MaterialInstance = materialHandle.get();
     cmd.Transform = transform;
     cmd.Animator = animator;
-    m_SkeletalDrawList.push_back(cmd);
+
+    glm::vec3 worldCenter, worldExtents;
+    Math::TransformBounds(transform, submesh.BoundingBox.GetCenter(), submesh.BoundingBox.GetExtents(), worldCenter, worldExtents);
+    cmd.Lod = SelectLod(submesh, GetScreenSize(worldCenter, worldExtents), lodState);
   }
   std::vector<std::function<void(std::string fileName)>> callbacks;
 
@@ -221,25 +240,27 @@ namespace Rain
     }
 
     m_CommandBuffer = CreateRef<CommandBuffer>();
-    m_TransformBuffer = GPUAllocator::GAlloc("scene_global_transform", WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex, 1024 * sizeof(TransformVertexData));
+    m_TransformArena = GPUFrameArena::Create("scene_global_transform", WGPUBufferUsage_Vertex, 1024 * sizeof(TransformVertexData));
     m_SceneUniform = {};
 
     // clang-format off
-	VertexBufferLayout vertexLayout = {80, {
-			{0, ShaderDataType::Float3, "position", 0},
-			{1, ShaderDataType::Float3, "normal", 16},
-			{2, ShaderDataType::Float2, "uv", 32},
-			{3, ShaderDataType::Float3, "tangent", 48},
-			{4, ShaderDataType::Float3, "bitangent", 60}}};
+	VertexBufferLayout vertexLayout = {sizeof(PackedVertex), {
+			{0, ShaderDataType::Unorm16x4, "position", 0},
+			{1, ShaderDataType::Snorm16x2, "normal", 8},
+			{2, ShaderDataType::Half2, "uv", 16},
+			{3, ShaderDataType::Snorm16x2, "tangent", 12}}};
 
 	VertexBufferLayout vertexLayoutQuad = {32, {
 			{0, ShaderDataType::Float3, "position", 0},
 			{1, ShaderDataType::Float2, "uv", 16}}};
 
-  VertexBufferLayout instanceLayout = {48, {
+  VertexBufferLayout instanceLayout = {sizeof(TransformVertexData), {
       {5, ShaderDataType::Float4, "a_MRow0", 0},
       {6, ShaderDataType::Float4, "a_MRow1", 16},
-      {7, ShaderDataType::Float4, "a_MRow2", 32}}};
+      {7, ShaderDataType::Float4, "a_MRow2", 32},
+      {8, ShaderDataType::Float4, "a_PositionOffset", 48},
+      {9, ShaderDataType::Float3, "a_PositionScale", 64},
+      {10, ShaderDataType::Int, "a_MaterialIndex", 76}}};
     // clang-format on
 
     const Ref<Shader> pbrShader = ShaderManager::LoadShader("SH_DefaultBasicBatch", RESOURCE_DIR "/shaders/pbr.wgsl");
@@ -450,26 +471,26 @@ namespace Rain
                          RN_LOG("Shader {} reloaded", filePath); });
 
     // clang-format off
-    VertexBufferLayout skeletalVertexLayout = {112, {
-        {0, ShaderDataType::Float3, "position", 0},
-        {1, ShaderDataType::Float3, "normal", 16},
-        {2, ShaderDataType::Float2, "uv", 32},
-        {3, ShaderDataType::Float3, "tangent", 48},
-        {4, ShaderDataType::Float3, "bitangent", 64},
-        {5, ShaderDataType::Int4, "boneIndices", 80},
-        {6, ShaderDataType::Float4, "boneWeights", 96}}};
-
-    VertexBufferLayout skeletalInstanceLayout = {48, {
+    VertexBufferLayout skeletalVertexLayout = {sizeof(PackedSkeletalVertex), {
+        {0, ShaderDataType::Unorm16x4, "position", 0},
+        {1, ShaderDataType::Snorm16x2, "normal", 8},
+        {2, ShaderDataType::Half2, "uv", 16},
+        {3, ShaderDataType::Snorm16x2, "tangent", 12},
+        {5, ShaderDataType::Uint8x4, "boneIndices", 20},
+        {6, ShaderDataType::Unorm16x4, "boneWeights", 24}}};
+
+    VertexBufferLayout skeletalInstanceLayout = {sizeof(SkeletalInstanceData), {
         {7, ShaderDataType::Float4, "a_MRow0", 0},
         {8, ShaderDataType::Float4, "a_MRow1", 16},
-        {9, ShaderDataType::Float4, "a_MRow2", 32}}};
+        {9, ShaderDataType::Float4, "a_MRow2", 32},
+        {10, ShaderDataType::Int, "a_BoneOffset", 48},
+        {11, ShaderDataType::Float4, "a_PositionOffset", 64},
+        {12, ShaderDataType::Float4, "a_PositionScale", 80},
+        {13, ShaderDataType::Int, "a_MaterialIndex", 52}}};
     // clang-format on
 
-    m_BoneMatricesBuffer = GPUAllocator::GAlloc("bone_matrices", WGPUBufferUsage_CopyDst | WGPUBufferUsage_Storage, 128 * sizeof(glm::mat4));
-    m_SkeletalTransformBuffer = GPUAllocator::GAlloc("skeletal_transform", WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex, 16 * sizeof(TransformVertexData));
-
-    std::vector<glm::mat4> identityBones(128, glm::mat4(1.0f));
-    m_BoneMatricesBuffer->SetData(identityBones.data(), 128 * sizeof(glm::mat4));
+    m_BonePaletteArena = GPUFrameArena::Create("bone_palette", WGPUBufferUsage_Storage, 16 * 128 * sizeof(glm::mat4));
+    m_SkeletalInstanceArena = GPUFrameArena::Create("skeletal_transform", WGPUBufferUsage_Vertex, 64 * sizeof(SkeletalInstanceData));
 
     FramebufferSpec skeletalFboSpec;
     skeletalFboSpec.ColorFormats = {TextureFormat::BRGBA8};
@@ -497,7 +518,7 @@ namespace Rain
 
     m_SkeletalPass = RenderPass::Create(skeletalPassSpec);
     m_SkeletalPass->Set("u_Scene", m_SceneUniformBuffer);
-    m_SkeletalPass->Set("u_BoneMatrices", m_BoneMatricesBuffer);
+    m_SkeletalPass->Set("u_BoneMatrices", m_BonePaletteArena->GetBuffer());
     m_SkeletalPass->Set("u_ShadowMap", m_ShadowPass[0]->GetDepthOutput());
     m_SkeletalPass->Set("u_ShadowSampler", m_ShadowSampler);
     m_SkeletalPass->Set("u_ShadowData", m_ShadowUniformBuffer);
@@ -541,7 +562,7 @@ namespace Rain
 
       m_SkeletalShadowPass[i] = RenderPass::Create(skeletalShadowPassSpec);
       m_SkeletalShadowPass[i]->Set("u_ShadowData", m_ShadowUniformBuffer);
-      m_SkeletalShadowPass[i]->Set("u_BoneMatrices", m_BoneMatricesBuffer);
+      m_SkeletalShadowPass[i]->Set("u_BoneMatrices", m_BonePaletteArena->GetBuffer());
       m_SkeletalShadowPass[i]->Bake();
     }
 
@@ -578,23 +599,308 @@ namespace Rain
     // auto renderContext = m_Renderer->GetRenderContext();
   }
 
-  void SceneRenderer::PreRender()
+  void SceneRenderer::CullSubmissions()
   {
     RN_PROFILE_FUNC;
-    static TransformVertexData* submeshTransforms = (TransformVertexData*)malloc(1024 * sizeof(TransformVertexData));
+    m_SubmissionVisibility.resize(m_MeshSubmissions.size());
+
+    const uint32_t visibleCount = Math::CullBoundingBoxes(m_CameraFrustum, m_SubmissionBounds, m_SubmissionVisibility.data());
+
+    m_Stats.SubmittedInstances = (uint32_t)m_MeshSubmissions.size();
+    m_Stats.CulledInstances = m_Stats.SubmittedInstances - visibleCount;
+
+    // Bounds of everything submitted, to size the caster extension below
+    glm::vec3 sceneMin(0.0f), sceneMax(0.0f);
+    for (uint32_t i = 0; i < m_SubmissionBounds.Size(); i++)
+    {
+      const glm::vec3 center = {m_SubmissionBounds.CenterX[i], m_SubmissionBounds.CenterY[i], m_SubmissionBounds.CenterZ[i]};
+      const glm::vec3 extents = {m_SubmissionBounds.ExtentX[i], m_SubmissionBounds.ExtentY[i], m_SubmissionBounds.ExtentZ[i]};
+      sceneMin = i == 0 ? center - extents : glm::min(sceneMin, center - extents);
+      sceneMax = i == 0 ? center + extents : glm::max(sceneMax, center + extents);
+    }
+    const glm::vec3 sceneCenter = (sceneMin + sceneMax) * 0.5f;
+    const glm::vec3 sceneExtents = (sceneMax - sceneMin) * 0.5f;
+
+    for (uint32_t i = 0; i < m_NumOfCascades; i++)
+    {
+      // Casters between the light and a cascade still throw shadows into it, so its near plane
+      // is pushed toward the light just far enough to take in the furthest point of the scene
+      Frustum casterFrustum = m_CascadeFrustums[i];
+      glm::vec4& nearPlane = casterFrustum.Planes[4];
+      const float sceneNearDistance = glm::dot(glm::vec3(nearPlane), sceneCenter) + nearPlane.w - glm::dot(glm::abs(glm::vec3(nearPlane)), sceneExtents);
+      nearPlane.w += std::max(0.0f, -sceneNearDistance);
+
+      m_CascadeVisibility[i].resize(m_MeshSubmissions.size());
+      m_Stats.ShadowCasters[i] = Math::CullBoundingBoxes(casterFrustum, m_SubmissionBounds, m_CascadeVisibility[i].data());
+    }
+  }
+
+  static uint64_t FoldBits(uint64_t value, uint32_t bits)
+  {
+    uint64_t folded = 0;
+    for (uint32_t shift = 0; shift < 64; shift += bits)
+    {
+      folded ^= value >> shift;
+    }
+
+    return folded & ((1ull << bits) - 1);
+  }
+
+  // Key collisions only split a batch, they never merge different draws; see IsSameBatch
+  static uint64_t MakeSortKey(uint32_t pipeline, uint64_t material, uint64_t mesh, uint32_t lod, uint32_t submeshIndex, uint32_t depthBucket)
+  {
+    return ((uint64_t)(pipeline & 0xF) << 60) |
+           (FoldBits(material, 20) << 40) |
+           (FoldBits(mesh, 17) << 23) |
+           ((uint64_t)(lod & 0x7) << 20) |
+           ((uint64_t)(submeshIndex & 0xFF) << 12) |
+           (uint64_t)(depthBucket & 0xFFF);
+  }
+
+  static bool IsSameBatch(const MeshSubmission& a, const MeshSubmission& b)
+  {
+    return a.Mesh->Id == b.Mesh->Id && a.SubmeshIndex == b.SubmeshIndex && a.Lod == b.Lod && a.MaterialHandle == b.MaterialHandle;
+  }
+
+  void SceneRenderer::BuildDrawList()
+  {
+    RN_PROFILE_FUNC;
+    const glm::vec3 cameraPosition = m_SceneUniform.CameraPosition;
+
+    for (uint32_t i = 0; i < (uint32_t)m_MeshSubmissions.size(); i++)
+    {
+      const auto& submission = m_MeshSubmissions[i];
+      const uint64_t stateKey = MakeSortKey(0, submission.MaterialHandle, submission.Mesh->Id, submission.Lod, submission.SubmeshIndex, 0);
+
+      if (m_SubmissionVisibility[i])
+      {
+        // Front to back inside a batch
+        const glm::vec3 center = {m_SubmissionBounds.CenterX[i], m_SubmissionBounds.CenterY[i], m_SubmissionBounds.CenterZ[i]};
+        const float depth = glm::clamp(glm::length(center - cameraPosition) / m_CameraFar, 0.0f, 1.0f);
+        m_DrawList.Packets.push_back({stateKey | (uint32_t)(depth * 4095.0f), i});
+
+        const glm::vec3 extents = {m_SubmissionBounds.ExtentX[i], m_SubmissionBounds.ExtentY[i], m_SubmissionBounds.ExtentZ[i]};
+        RequestTextureResidency(submission.MaterialInstance, center, extents);
+      }
+
+      for (uint32_t cascade = 0; cascade < m_NumOfCascades; cascade++)
+      {
+        if (m_CascadeVisibility[cascade][i])
+        {
+          m_ShadowDrawList[cascade].Packets.push_back({stateKey, i});
+        }
+      }
+    }
+
+    SortAndBatch(m_DrawList);
+    for (uint32_t i = 0; i < m_NumOfCascades; i++)
+    {
+      SortAndBatch(m_ShadowDrawList[i]);
+    }
+
+    m_Stats.Triangles = 0;
+    for (const auto& batch : m_DrawList.Batches)
+    {
+      const auto& submission = m_MeshSubmissions[batch.SubmissionIndex];
+      const auto& submesh = submission.Mesh->m_SubMeshes[submission.SubmeshIndex];
+      m_Stats.Triangles += (uint64_t)submesh.Lods[submission.Lod].IndexCount / 3 * batch.InstanceCount;
+    }
+  }
+
+  void SceneRenderer::SortAndBatch(DrawList& drawList)
+  {
+    RadixSort(drawList.Packets, m_SortScratch);
+
+    const uint32_t arenaOffset = m_TransformArena->Allocate((uint32_t)drawList.Packets.size() * sizeof(TransformVertexData));
+    auto* transforms = (TransformVertexData*)m_TransformArena->GetData(arenaOffset);
+    uint32_t instanceOffset = arenaOffset / sizeof(TransformVertexData);
+
+    for (const auto& packet : drawList.Packets)
+    {
+      const auto& submission = m_MeshSubmissions[packet.SubmissionIndex];
+
+      if (drawList.Batches.empty() || !IsSameBatch(m_MeshSubmissions[drawList.Batches.back().SubmissionIndex], submission))
+      {
+        drawList.Batches.push_back({packet.SubmissionIndex, instanceOffset, 0});
+      }
+
+      *transforms++ = submission.Transform;
+      instanceOffset++;
+      drawList.Batches.back().InstanceCount++;
+    }
+  }
+
+  uint32_t SceneRenderer::WriteBonePalette(const SkeletalDrawCommand& cmd)
+  {
+    const auto& skeletonMatrices = cmd.Mesh->GetSkeleton()->BoneMatrices;
+    const auto& boneMatrices = cmd.Animator ? cmd.Animator->GetBoneMatrices() : skeletonMatrices;
+    const uint32_t boneCount = (uint32_t)std::max(boneMatrices.size(), skeletonMatrices.size());
+
+    const uint32_t byteOffset = m_BonePaletteArena->Allocate(boneCount * sizeof(glm::mat4));
+    auto* palette = (glm::mat4*)m_BonePaletteArena->GetData(byteOffset);
+    for (uint32_t i = 0; i < boneCount; i++)
+    {
+      palette[i] = i < boneMatrices.size() ? boneMatrices[i] : glm::mat4(1.0f);
+    }
+
+    return byteOffset / sizeof(glm::mat4);
+  }
+
+  void SceneRenderer::WriteBonePalettes()
+  {
+    // Submeshes of one character share an animator (or a static skeleton), sorting groups them
+    // so each palette is written once. Both vectors keep their capacity across frames.
+    std::sort(m_BonePaletteSources.begin(), m_BonePaletteSources.end(), [](const BonePaletteSource& a, const BonePaletteSource& b)
+              { return a.Source != b.Source ? std::less<const void*>()(a.Source, b.Source) : a.SubmissionIndex < b.SubmissionIndex; });
+    m_BonePaletteOffsets.resize(m_SkeletalSubmissions.size());
+
+    const void* previousSource = nullptr;
+    uint32_t paletteOffset = 0;
+    for (const auto& entry : m_BonePaletteSources)
+    {
+      if (entry.Source != previousSource)
+      {
+        paletteOffset = WriteBonePalette(m_SkeletalSubmissions[entry.SubmissionIndex]);
+        previousSource = entry.Source;
+      }
+      m_BonePaletteOffsets[entry.SubmissionIndex] = paletteOffset;
+    }
+  }
+
+  void SceneRenderer::BuildSkeletalDrawList()
+  {
+    RN_PROFILE_FUNC;
+    for (uint32_t i = 0; i < (uint32_t)m_SkeletalSubmissions.size(); i++)
+    {
+      const auto& cmd = m_SkeletalSubmissions[i];
+      if (!cmd.Mesh->HasSkeleton())
+      {
+        continue;
+      }
+
+      m_SkeletalDrawList.Packets.push_back({MakeSortKey(1, cmd.MaterialHandle, cmd.Mesh->Id, cmd.Lod, cmd.SubmeshIndex, 0), i});
+      m_BonePaletteSources.push_back({cmd.Animator ? (const void*)cmd.Animator.get() : (const void*)cmd.Mesh->GetSkeleton().get(), i});
+
+      const auto& submesh = cmd.Mesh->m_SubMeshes[cmd.SubmeshIndex];
+      glm::vec3 worldCenter, worldExtents;
+      Math::TransformBounds(cmd.Transform, submesh.BoundingBox.GetCenter(), submesh.BoundingBox.GetExtents(), worldCenter, worldExtents);
+      RequestTextureResidency(cmd.MaterialInstance, worldCenter, worldExtents);
+    }
+
+    RadixSort(m_SkeletalDrawList.Packets, m_SortScratch);
+    WriteBonePalettes();
+
+    const uint32_t arenaOffset = m_SkeletalInstanceArena->Allocate((uint32_t)m_SkeletalDrawList.Packets.size() * sizeof(SkeletalInstanceData));
+    auto* instances = (SkeletalInstanceData*)m_SkeletalInstanceArena->GetData(arenaOffset);
+    uint32_t instanceOffset = arenaOffset / sizeof(SkeletalInstanceData);
+
+    for (const auto& packet : m_SkeletalDrawList.Packets)
+    {
+      const auto& cmd = m_SkeletalSubmissions[packet.SubmissionIndex];
+
+      bool sameBatch = false;
+      if (!m_SkeletalDrawList.Batches.empty())
+      {
+        const auto& batchCmd = m_SkeletalSubmissions[m_SkeletalDrawList.Batches.back().SubmissionIndex];
+        sameBatch = batchCmd.Mesh->Id == cmd.Mesh->Id && batchCmd.SubmeshIndex == cmd.SubmeshIndex && batchCmd.Lod == cmd.Lod && batchCmd.MaterialHandle == cmd.MaterialHandle;
+      }
+
+      if (!sameBatch)
+      {
+        m_SkeletalDrawList.Batches.push_back({packet.SubmissionIndex, instanceOffset, 0});
+      }
 
-    uint32_t offset = 0;
-    for (auto& [key, transformData] : m_MeshTransformMap)
+      auto& instance = *instances++;
+      instance.MRow[0] = {cmd.Transform[0][0], cmd.Transform[1][0], cmd.Transform[2][0], cmd.Transform[3][0]};
+      instance.MRow[1] = {cmd.Transform[0][1], cmd.Transform[1][1], cmd.Transform[2][1], cmd.Transform[3][1]};
+      instance.MRow[2] = {cmd.Transform[0][2], cmd.Transform[1][2], cmd.Transform[2][2], cmd.Transform[3][2]};
+      instance.BoneOffset = m_BonePaletteOffsets[packet.SubmissionIndex];
+      instance.MaterialIndex = cmd.MaterialInstance->GetConstantsIndex();
+
+      const auto& submesh = cmd.Mesh->m_SubMeshes[cmd.SubmeshIndex];
+      instance.PositionOffset = glm::vec4(submesh.GetPositionOffset(), 0.0f);
+      instance.PositionScale = glm::vec4(submesh.GetPositionScale(), 0.0f);
+
+      instanceOffset++;
+      m_SkeletalDrawList.Batches.back().InstanceCount++;
+      m_Stats.Triangles += submesh.Lods[cmd.Lod].IndexCount / 3;
+    }
+
+    m_Stats.SkinnedInstances = (uint32_t)m_SkeletalDrawList.Packets.size();
+    m_Stats.SkinnedBatches = (uint32_t)m_SkeletalDrawList.Batches.size();
+  }
+
+  float SceneRenderer::GetScreenSize(const glm::vec3& center, const glm::vec3& extents) const
+  {
+    // Projected diameter of the bounding sphere in pixels
+    const float distance = std::max(glm::length(center - m_SceneUniform.CameraPosition), 0.01f);
+    return glm::length(extents) * m_ProjectionScale * (float)m_ViewportHeight / distance;
+  }
+
+  uint32_t SceneRenderer::SelectLod(const SubMesh& submesh, float screenSize, uint32_t* lodState)
+  {
+    // Level errors are relative to the bounding radius, half the screen size
+    const float radiusPixels = screenSize * 0.5f;
+    auto coarsest = [&](uint32_t lod, float maxError)
     {
-      transformData.TransformOffset = offset * sizeof(TransformVertexData);
-      for (const auto& transform : transformData.Transforms)
+      while (lod + 1 < submesh.LodCount && submesh.Lods[lod + 1].Error * radiusPixels <= maxError)
       {
-        submeshTransforms[offset] = (transform);
-        offset++;
+        lod++;
       }
+      return lod;
+    };
+
+    // Hysteresis: the current level is kept until its error grows past the widened threshold,
+    // and a coarser one is only taken once it fits a tightened one
+    uint32_t lod = 0;
+    const uint32_t current = lodState ? std::min(*lodState, submesh.LodCount - 1) : 0;
+    if (lodState && submesh.Lods[current].Error * radiusPixels <= m_LodPixelError * (1.0f + kLodHysteresis))
+    {
+      lod = coarsest(current, m_LodPixelError / (1.0f + kLodHysteresis));
+    }
+    else
+    {
+      lod = coarsest(0, m_LodPixelError);
     }
 
-    m_TransformBuffer->SetData(submeshTransforms, offset * sizeof(TransformVertexData));
+    if (lodState)
+    {
+      *lodState = lod;
+    }
+    m_Stats.LodInstances[lod]++;
+    return lod;
+  }
+
+  void SceneRenderer::RequestTextureResidency(const Material* material, const glm::vec3& center, const glm::vec3& extents)
+  {
+    // Without a target size every request would ask for the mip tail and evict resident levels
+    if (m_ViewportHeight == 0)
+    {
+      return;
+    }
+
+    // Pixels of the composite target, the same height LOD selection uses
+    const float screenSize = GetScreenSize(center, extents);
+
+    for (const auto& [_, texture] : material->GetTextures())
+    {
+      TextureStreamer::RequestScreenSize(texture.get(), screenSize);
+    }
+  }
+
+  void SceneRenderer::PreRender()
+  {
+    RN_PROFILE_FUNC;
+    m_TransformArena->Upload();
+    m_SkeletalInstanceArena->Upload();
+    m_BonePaletteArena->Upload();
+
+    // The palette buffer is replaced when it grows, the passes pick the new one up on Prepare
+    m_SkeletalPass->Set("u_BoneMatrices", m_BonePaletteArena->GetBuffer());
+    for (uint32_t i = 0; i < m_NumOfCascades; i++)
+    {
+      m_SkeletalShadowPass[i]->Set("u_BoneMatrices", m_BonePaletteArena->GetBuffer());
+    }
   }
 
   void SceneRenderer::SetScene(Scene* scene)
@@ -674,11 +980,31 @@ namespace Rain
   void SceneRenderer::BeginScene(const SceneCamera& camera)
   {
     RN_PROFILE_FUNC;
+    if (m_NeedResize)
+    {
+      m_SkyboxPass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
+      m_CompositePass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
+      // m_PpfxPass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
+      m_NeedResize = false;
+    }
+
+    // LOD and mip selection measure bounds in pixels of the target the scene is drawn to
+    const FramebufferSpec& targetSpec = m_CompositeFramebuffer->GetFrameBufferSpec();
+    m_ViewportWidth = targetSpec.Width;
+    m_ViewportHeight = targetSpec.Height;
+
     const glm::mat4 viewInverse = glm::inverse(camera.ViewMatrix);
     const glm::vec3 cameraPosition = viewInverse[3];
 
     m_SceneUniform.ViewProjection = camera.Projection * camera.ViewMatrix;
     m_SceneUniform.View = camera.ViewMatrix;
+    m_CameraFrustum = Frustum::FromViewProjection(m_SceneUniform.ViewProjection);
+    m_CameraFar = camera.Far;
+    m_ProjectionScale = camera.Projection[1][1];
+    std::fill(std::begin(m_Stats.LodInstances), std::end(m_Stats.LodInstances), 0u);
+    m_TransformArena->BeginFrame();
+    m_SkeletalInstanceArena->BeginFrame();
+    m_BonePaletteArena->BeginFrame();
     m_SceneUniform.LightDir = m_Scene->SceneLightInfo.LightDirection;
 
     m_SceneUniform.CameraPosition = cameraPosition;
@@ -697,16 +1023,14 @@ namespace Rain
 
     m_ShadowUniform.CascadeDistances = glm::vec4(data[0].SplitDepth, data[1].SplitDepth, data[2].SplitDepth, data[3].SplitDepth);
 
+    for (uint32_t i = 0; i < m_NumOfCascades; i++)
+    {
+      m_CascadeFrustums[i] = Frustum::FromViewProjection(data[i].ViewProj);
+    }
+
     m_SceneUniformBuffer->SetData(&m_SceneUniform, sizeof(SceneUniform));
     m_CameraUniformBuffer->SetData(&m_CameraData, sizeof(CameraData));
     m_ShadowUniformBuffer->SetData(&m_ShadowUniform, sizeof(ShadowUniform));
-    if (m_NeedResize)
-    {
-      m_SkyboxPass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
-      m_CompositePass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
-      // m_PpfxPass->GetTargetFrameBuffer()->Resize(m_ViewportWidth, m_ViewportHeight);
-      m_NeedResize = false;
-    }
 
     // JPH::DebugRenderer::sInstance = m_Renderer;
     if (SavedCam.Far != 400.0f)
@@ -725,11 +1049,20 @@ namespace Rain
 
     m_CommandBuffer->Begin();
 
+    m_Stats.StateCallsIssued = 0;
+    m_Stats.StateCallsSkipped = 0;
+    auto endPass = [this](const Ref<RenderPass>& pass)
+    {
+      m_Renderer->EndRenderPass(pass);
+      m_Stats.StateCallsIssued += pass->GetStateStats().Issued;
+      m_Stats.StateCallsSkipped += pass->GetStateStats().Skipped;
+    };
+
     {
       RN_PROFILE_FUNCN("Skybox Pass");
       m_Renderer->BeginRenderPass(m_SkyboxPass, m_CommandBuffer);
       m_Renderer->SubmitFullscreenQuad(m_SkyboxPass, m_SkyboxPipeline->GetPipeline());
-      m_Renderer->EndRenderPass(m_SkyboxPass);
+      endPass(m_SkyboxPass);
     }
 
     {
@@ -739,18 +1072,19 @@ namespace Rain
       {
         // Static mesh shadows
         m_Renderer->BeginRenderPass(m_ShadowPass[i], m_CommandBuffer);
-        for (auto& [mk, dc] : m_DrawList)
+        for (const auto& batch : m_ShadowDrawList[i].Batches)
         {
-          m_Renderer->RenderMesh(m_ShadowPass[i], m_ShadowPipeline[i]->GetPipeline(), dc.Mesh, dc.SubmeshIndex, dc.Materials, m_TransformBuffer, m_MeshTransformMap[mk].TransformOffset, dc.InstanceCount);
+          const auto& submission = m_MeshSubmissions[batch.SubmissionIndex];
+          m_Renderer->RenderMesh(m_ShadowPass[i], m_ShadowPipeline[i]->GetPipeline(), submission.Mesh, submission.SubmeshIndex, submission.Lod, submission.Materials, m_TransformArena->GetBuffer(), batch.InstanceOffset, batch.InstanceCount);
         }
-        m_Renderer->EndRenderPass(m_ShadowPass[i]);
+        endPass(m_ShadowPass[i]);
 
         // Skeletal mesh shadows
-        if (!m_SkeletalDrawList.empty())
+        if (!m_SkeletalDrawList.Batches.empty())
         {
           m_Renderer->BeginRenderPass(m_SkeletalShadowPass[i], m_CommandBuffer);
-          RenderSkeletalShadows(m_SkeletalShadowPass[i], i);
-          m_Renderer->EndRenderPass(m_SkeletalShadowPass[i]);
+          RenderSkeletalMeshes(m_SkeletalShadowPass[i], m_SkeletalShadowPipeline[i]->GetPipeline());
+          endPass(m_SkeletalShadowPass[i]);
         }
       }
     }
@@ -759,20 +1093,21 @@ namespace Rain
       RN_PROFILE_FUNCN("Geometry Pass");
 
       m_Renderer->BeginRenderPass(m_CompositePass, m_CommandBuffer);
-      for (auto& [mk, dc] : m_DrawList)
+      for (const auto& batch : m_DrawList.Batches)
       {
-        m_Renderer->RenderMesh(m_CompositePass, m_CompositePipeline->GetPipeline(), dc.Mesh, dc.SubmeshIndex, dc.Materials, m_TransformBuffer, m_MeshTransformMap[mk].TransformOffset, dc.InstanceCount);
+        const auto& submission = m_MeshSubmissions[batch.SubmissionIndex];
+        m_Renderer->RenderMesh(m_CompositePass, m_CompositePipeline->GetPipeline(), submission.Mesh, submission.SubmeshIndex, submission.Lod, submission.Materials, m_TransformArena->GetBuffer(), batch.InstanceOffset, batch.InstanceCount);
       }
-      m_Renderer->EndRenderPass(m_CompositePass);
+      endPass(m_CompositePass);
     }
 
     {
       RN_PROFILE_FUNCN("Skeletal Pass");
-      if (!m_SkeletalDrawList.empty())
+      if (!m_SkeletalDrawList.Batches.empty())
       {
         m_Renderer->BeginRenderPass(m_SkeletalPass, m_CommandBuffer);
-        RenderSkeletalMeshes(m_SkeletalPass);
-        m_Renderer->EndRenderPass(m_SkeletalPass);
+        RenderSkeletalMeshes(m_SkeletalPass, m_SkeletalPipeline->GetPipeline());
+        endPass(m_SkeletalPass);
       }
     }
 
@@ -780,102 +1115,31 @@ namespace Rain
       RN_PROFILE_FUNCN("PPFX Pass");
       m_Renderer->BeginRenderPass(m_PpfxPass, m_CommandBuffer);
       m_Renderer->SubmitFullscreenQuad(m_PpfxPass, m_PpfxPipeline->GetPipeline());
-      m_Renderer->EndRenderPass(m_PpfxPass);
+      endPass(m_PpfxPass);
     }
 
     m_CommandBuffer->End();
     m_CommandBuffer->Submit();
 
-    m_DrawList.clear();
-    m_MeshTransformMap.clear();
-    m_SkeletalDrawList.clear();
-  }
-
-  void SceneRenderer::RenderSkeletalMeshes(Ref<RenderPass> renderPass)
-  {
-    if (m_SkeletalDrawList.empty())
+    // clear() keeps capacity so the steady state frame does not allocate
+    m_DrawList.Clear();
+    for (uint32_t i = 0; i < m_NumOfCascades; i++)
     {
-      return;
-    }
-
-    for (auto& cmd : m_SkeletalDrawList)
-    {
-      if (!cmd.Mesh->HasSkeleton())
-      {
-        continue;
-      }
-
-      std::vector<glm::mat4> boneMatrices(128, glm::mat4(1.0f));
-
-      if (cmd.Animator)
-      {
-        const auto& animatedMatrices = cmd.Animator->GetBoneMatrices();
-        for (size_t i = 0; i < animatedMatrices.size() && i < 128; i++)
-        {
-          boneMatrices[i] = animatedMatrices[i];
-        }
-      }
-      else
-      {
-        // Fallback to static skeleton (existing behavior)
-        auto skeleton = cmd.Mesh->GetSkeleton();
-        for (size_t i = 0; i < skeleton->BoneMatrices.size() && i < 128; i++)
-        {
-          boneMatrices[i] = skeleton->BoneMatrices[i];
-        }
-      }
-
-      m_BoneMatricesBuffer->SetData(boneMatrices.data(), 128 * sizeof(glm::mat4));
-
-      TransformVertexData transformData;
-      transformData.MRow[0] = {cmd.Transform[0][0], cmd.Transform[1][0], cmd.Transform[2][0], cmd.Transform[3][0]};
-      transformData.MRow[1] = {cmd.Transform[0][1], cmd.Transform[1][1], cmd.Transform[2][1], cmd.Transform[3][1]};
-      transformData.MRow[2] = {cmd.Transform[0][2], cmd.Transform[1][2], cmd.Transform[2][2], cmd.Transform[3][2]};
-
-      m_SkeletalTransformBuffer->SetData(&transformData, sizeof(TransformVertexData));
-
-      m_Renderer->RenderSkeletalMesh(renderPass, m_SkeletalPipeline->GetPipeline(), cmd.Mesh, cmd.SubmeshIndex, cmd.Materials, m_SkeletalTransformBuffer, 1);
+      m_ShadowDrawList[i].Clear();
     }
+    m_MeshSubmissions.clear();
+    m_SubmissionBounds.Clear();
+    m_SkeletalDrawList.Clear();
+    m_SkeletalSubmissions.clear();
+    m_BonePaletteSources.clear();
   }
 
-  void SceneRenderer::RenderSkeletalShadows(Ref<RenderPass> renderPass, int cascadeIndex)
+  void SceneRenderer::RenderSkeletalMeshes(Ref<RenderPass> renderPass, WGPURenderPipeline pipeline)
   {
-    for (auto& cmd : m_SkeletalDrawList)
+    for (const auto& batch : m_SkeletalDrawList.Batches)
     {
-      if (!cmd.Mesh->HasSkeleton())
-      {
-        continue;
-      }
-
-      std::vector<glm::mat4> boneMatrices(128, glm::mat4(1.0f));
-
-      if (cmd.Animator)
-      {
-        const auto& animatedMatrices = cmd.Animator->GetBoneMatrices();
-        for (size_t i = 0; i < animatedMatrices.size() && i < 128; i++)
-        {
-          boneMatrices[i] = animatedMatrices[i];
-        }
-      }
-      else
-      {
-        auto skeleton = cmd.Mesh->GetSkeleton();
-        for (size_t i = 0; i < skeleton->BoneMatrices.size() && i < 128; i++)
-        {
-          boneMatrices[i] = skeleton->BoneMatrices[i];
-        }
-      }
-
-      m_BoneMatricesBuffer->SetData(boneMatrices.data(), 128 * sizeof(glm::mat4));
-
-      TransformVertexData transformData;
-      transformData.MRow[0] = {cmd.Transform[0][0], cmd.Transform[1][0], cmd.Transform[2][0], cmd.Transform[3][0]};
-      transformData.MRow[1] = {cmd.Transform[0][1], cmd.Transform[1][1], cmd.Transform[2][1], cmd.Transform[3][1]};
-      transformData.MRow[2] = {cmd.Transform[0][2], cmd.Transform[1][2], cmd.Transform[2][2], cmd.Transform[3][2]};
-
-      m_SkeletalTransformBuffer->SetData(&transformData, sizeof(TransformVertexData));
-
-      m_Renderer->RenderSkeletalMesh(renderPass, m_SkeletalShadowPipeline[cascadeIndex]->GetPipeline(), cmd.Mesh, cmd.SubmeshIndex, cmd.Materials, m_SkeletalTransformBuffer, 1);
+      const auto& cmd = m_SkeletalSubmissions[batch.SubmissionIndex];
+      m_Renderer->RenderSkeletalMesh(renderPass, pipeline, cmd.Mesh, cmd.SubmeshIndex, cmd.Lod, cmd.Materials, m_SkeletalInstanceArena->GetBuffer(), batch.InstanceOffset, batch.InstanceCount);
     }
   }
 
@@ -887,7 +1151,12 @@ namespace Rain
       return;
     }
 
+    CullSubmissions();
+    BuildDrawList();
+    BuildSkeletalDrawList();
     PreRender();
+    // Constants written since the last frame go up in one pass before any draw reads them
+    MaterialConstants::Flush();
     FlushDrawList();
   }
 }  // namespace Rain
@@ -1,7 +1,9 @@
 #pragma once
 #include "Scene.h"
+#include "Math/Frustum.h"
 #include "animation/OzzAnimator.h"
 #include "render/CommandBuffer.h"
+#include "render/GPUFrameArena.h"
 #include "render/Pipeline.h"
 #include "render/PipelineCompute.h"
 #include "render/Render.h"
@@ -10,82 +12,85 @@
 
 namespace Rain
 {
-  struct MeshKey
+  struct SkeletalDrawCommand
   {
-    UUID MeshHandle;
-    UUID MaterialHandle;
+    Ref<MeshSource> Mesh;
     uint32_t SubmeshIndex;
+    Ref<MaterialTable> Materials;
+    UUID MaterialHandle;
+    Material* MaterialInstance = nullptr;  // Owned by the material table, valid for the frame
+    glm::mat4 Transform;
+    Ref<OzzAnimator> Animator;
+    uint32_t Lod = 0;
+  };
 
-    MeshKey(UUID meshHandle, UUID materialHandle, uint32_t submeshIndex)
-        : MeshHandle(meshHandle), MaterialHandle(materialHandle), SubmeshIndex(submeshIndex)
-    {
-    }
+  struct TransformVertexData
+  {
+    glm::vec4 MRow[3];
+    glm::vec4 PositionOffset;  // Packed position decode of the submesh, see SubMesh::GetPositionScale
+    glm::vec3 PositionScale;
+    uint32_t MaterialIndex;  // Slot in MaterialConstants
+  };
 
-    bool operator<(const MeshKey& other) const
-    {
-      if (MeshHandle < other.MeshHandle)
-      {
-        return true;
-      }
-
-      if (MeshHandle > other.MeshHandle)
-      {
-        return false;
-      }
-
-      if (SubmeshIndex < other.SubmeshIndex)
-      {
-        return true;
-      }
-
-      if (SubmeshIndex > other.SubmeshIndex)
-      {
-        return false;
-      }
-
-      if (MaterialHandle < other.MaterialHandle)
-      {
-        return true;
-      }
-
-      if (MaterialHandle > other.MaterialHandle)
-      {
-        return false;
-      }
-
-      return false;
-    }
+  struct SkeletalInstanceData
+  {
+    glm::vec4 MRow[3];
+    uint32_t BoneOffset;  // First matrix of this instance in the frame bone palette
+    uint32_t MaterialIndex;
+    uint32_t _pad[2];
+    glm::vec4 PositionOffset;
+    glm::vec4 PositionScale;
   };
 
-  struct DrawCommand
+  struct MeshSubmission
   {
     Ref<MeshSource> Mesh;
     uint32_t SubmeshIndex;
     Ref<MaterialTable> Materials;
+    UUID MaterialHandle;
+    Material* MaterialInstance = nullptr;  // Owned by the material table, valid for the frame
+    TransformVertexData Transform;
+    uint32_t Lod = 0;
+  };
 
-    uint32_t InstanceCount = 0;
-    uint32_t InstanceOffset = 0;
-    bool IsSkeletal = false;
+  // Sort key layout, high to low: pipeline (4) | material (20) | mesh (17) | lod (3) | submesh (8) | depth bucket (12)
+  struct DrawPacket
+  {
+    uint64_t SortKey;
+    uint32_t SubmissionIndex;
   };
 
-  struct SkeletalDrawCommand
+  // A run of packets sharing mesh, submesh and material, drawn as one instanced call
+  struct DrawBatch
   {
-    Ref<MeshSource> Mesh;
-    uint32_t SubmeshIndex;
-    Ref<MaterialTable> Materials;
-    glm::mat4 Transform;
-    Ref<OzzAnimator> Animator;
+    uint32_t SubmissionIndex;
+    uint32_t InstanceOffset;
+    uint32_t InstanceCount;
   };
 
-  struct TransformVertexData
+  struct DrawList
   {
-    glm::vec4 MRow[3];
+    std::vector<DrawPacket> Packets;
+    std::vector<DrawBatch> Batches;
+
+    void Clear()
+    {
+      Packets.clear();
+      Batches.clear();
+    }
   };
 
-  struct TransformMapData
+  struct SceneRendererStats
   {
-    std::vector<TransformVertexData> Transforms;
-    uint32_t TransformOffset = 0;
+    uint32_t SubmittedInstances = 0;
+    uint32_t CulledInstances = 0;
+    uint32_t ShadowCasters[4] = {};
+    uint32_t SkinnedInstances = 0;
+    uint32_t SkinnedBatches = 0;
+    uint32_t LodInstances[SubMesh::MaxLodCount] = {};  // Submitted instances per selected level
+    uint64_t Triangles = 0;                             // Main pass, static and skinned
+    uint32_t StateCallsIssued = 0;                      // Encoder state calls over all passes
+    uint32_t StateCallsSkipped = 0;                     // Dropped as redundant by the pass state cache
   };
 
   struct SceneCamera
@@ -123,17 +128,28 @@ namespace Rain
     SceneRenderer() { instance = this; };
 
     void Init();
-    void SubmitMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator = nullptr);
-    void SubmitSkeletalMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator = nullptr);
+    // lodState keeps the level selected last frame for hysteresis, the caller stores it per instance
+    void SubmitMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator = nullptr, uint32_t* lodState = nullptr);
+    void SubmitSkeletalMesh(Ref<MeshSource> meshSource, uint32_t submeshIndex, Ref<MaterialTable> materialTable, glm::mat4& transform, Ref<OzzAnimator> animator = nullptr, uint32_t* lodState = nullptr);
     void BeginScene(const SceneCamera& camera);
     void EndScene();
     void SetScene(Scene* scene);
     void SetViewportSize(int height, int width);
     Ref<Texture2D> GetLastPassImage();
+    const SceneRendererStats& GetStats() const { return m_Stats; }
 
     static SceneRenderer* instance;
 
    private:
+    void CullSubmissions();
+    void BuildDrawList();
+    void SortAndBatch(DrawList& drawList);
+    void BuildSkeletalDrawList();
+    uint32_t WriteBonePalette(const SkeletalDrawCommand& cmd);
+    void WriteBonePalettes();
+    float GetScreenSize(const glm::vec3& center, const glm::vec3& extents) const;
+    uint32_t SelectLod(const SubMesh& submesh, float screenSize, uint32_t* lodState);
+    void RequestTextureResidency(const Material* material, const glm::vec3& center, const glm::vec3& extents);
     void PreRender();
     void FlushDrawList();
 
@@ -144,15 +160,30 @@ namespace Rain
     CameraData m_CameraData;
     Ref<GPUBuffer> m_CameraUniformBuffer;
 
-    Ref<GPUBuffer> m_TransformBuffer;
+    Ref<GPUFrameArena> m_TransformArena;
     Ref<GPUBuffer> m_SceneUniformBuffer;
     Ref<GPUBuffer> m_ShadowUniformBuffer;
 
     SceneUniform m_SceneUniform;
     ShadowUniform m_ShadowUniform;
 
-    std::map<MeshKey, DrawCommand> m_DrawList;
-    std::map<MeshKey, TransformMapData> m_MeshTransformMap;
+    DrawList m_DrawList;
+    // Per-cascade caster lists, each with its own instance ranges in m_TransformArena
+    DrawList m_ShadowDrawList[4];
+    std::vector<DrawPacket> m_SortScratch;
+    float m_CameraFar = 1.0f;
+    float m_ProjectionScale = 1.0f;  // Projection[1][1], 1 / tan(fovY / 2)
+    float m_LodPixelError = 1.0f;    // Largest simplification error a level may show on screen
+
+    // Culling
+    Frustum m_CameraFrustum;
+    Frustum m_CascadeFrustums[4];
+    std::vector<MeshSubmission> m_MeshSubmissions;
+    BoundingBoxStream m_SubmissionBounds;
+    std::vector<uint8_t> m_SubmissionVisibility;
+    std::vector<uint8_t> m_CascadeVisibility[4];
+
+    SceneRendererStats m_Stats;
 
     Ref<Texture2D> m_LitTexture;
     Ref<Texture2D> m_ShadowDepthTexture;
@@ -183,23 +214,31 @@ namespace Rain
     bool m_NeedResize = false;
     uint32_t m_NumOfCascades = 4;
 
-    uint32_t m_ViewportWidth;
-    uint32_t m_ViewportHeight;
+    // Size of the composite target, refreshed in BeginScene
+    uint32_t m_ViewportWidth = 0;
+    uint32_t m_ViewportHeight = 0;
 
     Ref<CommandBuffer> m_CommandBuffer;
 
     // Skeletal rendering
     Ref<RenderPipeline> m_SkeletalPipeline;
     Ref<RenderPass> m_SkeletalPass;
-    Ref<GPUBuffer> m_BoneMatricesBuffer;
-    Ref<GPUBuffer> m_SkeletalTransformBuffer;
-    std::vector<SkeletalDrawCommand> m_SkeletalDrawList;
+    Ref<GPUFrameArena> m_BonePaletteArena;
+    Ref<GPUFrameArena> m_SkeletalInstanceArena;
+    std::vector<SkeletalDrawCommand> m_SkeletalSubmissions;
+    DrawList m_SkeletalDrawList;
+    struct BonePaletteSource
+    {
+      const void* Source;  // Animator, or the skeleton of a mesh without one
+      uint32_t SubmissionIndex;
+    };
+    std::vector<BonePaletteSource> m_BonePaletteSources;
+    std::vector<uint32_t> m_BonePaletteOffsets;  // Palette start per skeletal submission
 
     // Skeletal shadow rendering
     Ref<RenderPipeline> m_SkeletalShadowPipeline[4];
     Ref<RenderPass> m_SkeletalShadowPass[4];
 
-    void RenderSkeletalMeshes(Ref<RenderPass> passEncoder);
-    void RenderSkeletalShadows(Ref<RenderPass> renderPass, int cascadeIndex);
+    void RenderSkeletalMeshes(Ref<RenderPass> renderPass, WGPURenderPipeline pipeline);
   };
 }  // namespace Rain
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "core/JobSystem.h"
+#include "core/Log.h"
+
+using namespace Rain;
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  template <typename Function>
+  double MeasureMs(uint32_t repetitions, Function&& function)
+  {
+    const auto start = Clock::now();
+    for (uint32_t i = 0; i < repetitions; i++)
+    {
+      function();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repetitions;
+  }
+
+  // Stand-in for an animator or transform update: a few hundred flops per item
+  float Work(uint32_t index)
+  {
+    float value = (float)index;
+    for (uint32_t i = 0; i < 64; i++)
+    {
+      value = std::sqrt(value * 1.0001f + (float)i);
+    }
+    return value;
+  }
+}  // namespace
+
+// Prints per-iteration times, argv[1] overrides the worker count (0 picks one per core)
+int main(int argc, char** argv)
+{
+  Log::Init();
+  JobSystem::Init(argc > 1 ? (uint32_t)std::atoi(argv[1]) : 0);
+
+  constexpr uint32_t itemCount = 1 << 16;
+  constexpr uint32_t repetitions = 20;
+  std::vector<float> results(itemCount);
+
+  const double serialMs = MeasureMs(repetitions, [&]()
+                                    {
+                                      for (uint32_t i = 0; i < itemCount; i++)
+                                      {
+                                        results[i] = Work(i);
+                                      } });
+  std::printf("serial loop            %8.3f ms\n", serialMs);
+
+  for (uint32_t batchSize : {16u, 64u, 256u, 1024u})
+  {
+    const double parallelMs = MeasureMs(repetitions, [&]()
+                                        { JobSystem::ParallelFor(itemCount, batchSize, [&](uint32_t begin, uint32_t end)
+                                                                 {
+                                                                   for (uint32_t i = begin; i < end; i++)
+                                                                   {
+                                                                     results[i] = Work(i);
+                                                                   } }); });
+    std::printf("ParallelFor batch %4u %8.3f ms  %.2fx\n", batchSize, parallelMs, serialMs / parallelMs);
+  }
+
+  // Scheduling overhead: empty jobs, so the time is all queueing, stealing and counters
+  constexpr uint32_t emptyJobs = 100000;
+  std::atomic<uint32_t> ran{0};
+  const double emptyMs = MeasureMs(1, [&]()
+                                   {
+                                     JobCounter counter;
+                                     for (uint32_t i = 0; i < emptyJobs; i++)
+                                     {
+                                       JobSystem::Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+                                     }
+                                     JobSystem::Wait(counter); });
+  std::printf("empty jobs             %8.3f us per job\n", emptyMs * 1000.0 / emptyJobs);
+
+  std::printf("%u workers\n", JobSystem::GetWorkerCount());
+  JobSystem::Shutdown();
+  return ran.load() == emptyJobs ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "core/JobSystem.h"
+
+using namespace Rain;
+
+namespace
+{
+  constexpr uint32_t kWorkerCount = 3;
+
+  // Long enough that a single thread cannot drain a queue before the others wake up
+  void SimulateWork()
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+
+  struct ThreadRecorder
+  {
+    std::mutex Mutex;
+    std::set<std::thread::id> Threads;
+
+    void Record()
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Threads.insert(std::this_thread::get_id());
+    }
+  };
+}  // namespace
+
+RN_TEST(CounterWaitsForEveryJob)
+{
+  JobSystem::Init(kWorkerCount);
+  RN_CHECK(JobSystem::GetWorkerCount() == kWorkerCount);
+  RN_CHECK(JobSystem::IsMainThread());
+
+  std::atomic<uint32_t> finished{0};
+  JobCounter counter;
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    JobSystem::Run([&finished]()
+                   {
+                     SimulateWork();
+                     finished.fetch_add(1); },
+                   &counter);
+  }
+  JobSystem::Wait(counter);
+
+  RN_CHECK(counter.IsDone());
+  RN_CHECK(finished.load() == 64);
+
+  // An empty counter is already done
+  JobCounter empty;
+  JobSystem::Wait(empty);
+  RN_CHECK(empty.IsDone());
+
+  JobSystem::Shutdown();
+}
+
+RN_TEST(WaitInsideJobRunsOtherJobs)
+{
+  JobSystem::Init(kWorkerCount);
+
+  // Every outer job waits on its own children, which only finishes if Wait keeps executing
+  std::atomic<uint32_t> children{0};
+  JobCounter outer;
+  for (uint32_t i = 0; i < 8; i++)
+  {
+    JobSystem::Run([&children]()
+                   {
+                     JobCounter inner;
+                     for (uint32_t j = 0; j < 16; j++)
+                     {
+                       JobSystem::Run([&children]() { children.fetch_add(1); }, &inner);
+                     }
+                     JobSystem::Wait(inner); },
+                   &outer);
+  }
+  JobSystem::Wait(outer);
+
+  RN_CHECK(children.load() == 8 * 16);
+  JobSystem::Shutdown();
+}
+
+RN_TEST(ParallelForCoversEveryIndexOnce)
+{
+  JobSystem::Init(kWorkerCount);
+
+  constexpr uint32_t count = 1000;
+  constexpr uint32_t batchSize = 7;
+  std::vector<std::atomic<uint32_t>> hits(count);
+  std::atomic<bool> batchTooLarge{false};
+  JobSystem::ParallelFor(count, batchSize, [&](uint32_t begin, uint32_t end)
+                         {
+                           if (end - begin > batchSize)
+                           {
+                             batchTooLarge = true;
+                           }
+                           for (uint32_t i = begin; i < end; i++)
+                           {
+                             hits[i].fetch_add(1);
+                           } });
+
+  bool everyIndexOnce = true;
+  for (const auto& hit : hits)
+  {
+    everyIndexOnce &= hit.load() == 1;
+  }
+  RN_CHECK(everyIndexOnce);
+  RN_CHECK(!batchTooLarge);
+
+  // Zero items schedules nothing, batch size 0 is treated as 1
+  std::atomic<uint32_t> calls{0};
+  JobSystem::ParallelFor(0, 4, [&](uint32_t, uint32_t) { calls.fetch_add(1); });
+  RN_CHECK(calls.load() == 0);
+  JobSystem::ParallelFor(5, 0, [&](uint32_t, uint32_t) { calls.fetch_add(1); });
+  RN_CHECK(calls.load() == 5);
+
+  // The counter overload returns right away and is finished by Wait
+  std::atomic<uint32_t> sum{0};
+  const ParallelForFunction accumulate = [&sum](uint32_t begin, uint32_t end)
+  {
+    for (uint32_t i = begin; i < end; i++)
+    {
+      sum.fetch_add(i);
+    }
+  };
+  JobCounter counter;
+  JobSystem::ParallelFor(100, 10, accumulate, counter);
+  JobSystem::Wait(counter);
+  RN_CHECK(sum.load() == 99 * 100 / 2);
+
+  JobSystem::Shutdown();
+}
+
+RN_TEST(IdleWorkersStealQueuedJobs)
+{
+  JobSystem::Init(kWorkerCount);
+
+  // Jobs pushed by the main thread land in its own queue, the workers only get them by stealing
+  ThreadRecorder fromMain;
+  JobCounter mainCounter;
+  for (uint32_t i = 0; i < 32; i++)
+  {
+    JobSystem::Run([&fromMain]()
+                   {
+                     SimulateWork();
+                     fromMain.Record(); },
+                   &mainCounter);
+  }
+  JobSystem::Wait(mainCounter);
+  RN_CHECK(fromMain.Threads.size() > 1);
+
+  // Children spawned inside a job go to that thread's queue and spread out the same way
+  ThreadRecorder fromJob;
+  std::thread::id spawner;
+  JobCounter children;
+  JobCounter parent;
+  JobSystem::Run([&]()
+                 {
+                   spawner = std::this_thread::get_id();
+                   for (uint32_t i = 0; i < 32; i++)
+                   {
+                     JobSystem::Run([&fromJob]()
+                                    {
+                                      SimulateWork();
+                                      fromJob.Record(); },
+                                    &children);
+                   } },
+                 &parent);
+  JobSystem::Wait(parent);
+  JobSystem::Wait(children);
+
+  fromJob.Threads.erase(spawner);
+  RN_CHECK(!fromJob.Threads.empty());
+
+  JobSystem::Shutdown();
+}
+
+RN_TEST(MainThreadJobsRunOnMainThread)
+{
+  JobSystem::Init(kWorkerCount);
+  const std::thread::id mainThread = std::this_thread::get_id();
+
+  // Queued from the main thread and drained explicitly, as the application does once per frame
+  bool ran = false;
+  JobSystem::RunOnMainThread([&ran]() { ran = true; });
+  RN_CHECK(!ran);
+  JobSystem::ProcessMainThreadJobs();
+  RN_CHECK(ran);
+
+  // Queued from jobs and drained while the main thread waits on their counter
+  std::atomic<uint32_t> offMain{0};
+  std::atomic<uint32_t> onMain{0};
+  std::atomic<uint32_t> wrongThread{0};
+  JobCounter counter;
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    JobSystem::Run([&, mainThread]()
+                   {
+                     SimulateWork();
+                     if (!JobSystem::IsMainThread())
+                     {
+                       offMain.fetch_add(1);
+                     }
+                     JobSystem::RunOnMainThread([&, mainThread]()
+                                                {
+                                                  if (std::this_thread::get_id() != mainThread || !JobSystem::IsMainThread())
+                                                  {
+                                                    wrongThread.fetch_add(1);
+                                                  }
+                                                  onMain.fetch_add(1); },
+                                                &counter); },
+                   &counter);
+  }
+  JobSystem::Wait(counter);
+
+  RN_CHECK(onMain.load() == 16);
+  RN_CHECK(wrongThread.load() == 0);
+  RN_CHECK(offMain.load() > 0);
+
+  JobSystem::Shutdown();
+}
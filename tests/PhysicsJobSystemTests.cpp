@@ -0,0 +1,89 @@
+#include <atomic>
+#include <vector>
+#include "Test.h"
+#include "core/JobSystem.h"
+#include "physics/PhysicsJobSystem.h"
+
+using namespace Rain;
+
+namespace
+{
+  constexpr uint32_t kWorkerCount = 3;
+  constexpr JPH::uint kMaxJobs = 256;
+  constexpr JPH::uint kMaxBarriers = 4;
+}  // namespace
+
+// Jolt schedules its simulation step through the adapter the same way: jobs added to a
+// barrier, dependencies released by earlier jobs, and WaitForJobs on the stepping thread.
+RN_TEST(PhysicsJobSystemRunsBarrierJobs)
+{
+  JPH::RegisterDefaultAllocator();
+  JobSystem::Init(kWorkerCount);
+  {
+    PhysicsJobSystem jobSystem(kMaxJobs, kMaxBarriers);
+    RN_CHECK(jobSystem.GetMaxConcurrency() == (int)kWorkerCount + 1);
+
+    // More jobs than free list slots over the test, so finished jobs must be returned
+    std::atomic<uint32_t> finished{0};
+    for (uint32_t round = 0; round < 4; round++)
+    {
+      JPH::JobSystem::Barrier* barrier = jobSystem.CreateBarrier();
+      std::vector<JPH::JobHandle> handles;
+      for (uint32_t i = 0; i < kMaxJobs / 2; i++)
+      {
+        handles.push_back(jobSystem.CreateJob("Count", JPH::Color::sWhite, [&finished]()
+                                              { finished.fetch_add(1); }));
+      }
+      barrier->AddJobs(handles.data(), (JPH::uint)handles.size());
+      jobSystem.WaitForJobs(barrier);
+      jobSystem.DestroyBarrier(barrier);
+
+      bool allDone = true;
+      for (const auto& handle : handles)
+      {
+        allDone &= handle.IsDone();
+      }
+      RN_CHECK(allDone);
+    }
+    RN_CHECK(finished.load() == 4 * kMaxJobs / 2);
+  }
+  JobSystem::Shutdown();
+}
+
+RN_TEST(PhysicsJobSystemHonoursDependencies)
+{
+  JPH::RegisterDefaultAllocator();
+  JobSystem::Init(kWorkerCount);
+  {
+    PhysicsJobSystem jobSystem(kMaxJobs, kMaxBarriers);
+
+    // Each stage is queued only once the previous one removes its dependency
+    std::atomic<uint32_t> stage{0};
+    std::atomic<uint32_t> outOfOrder{0};
+    JPH::JobHandle third = jobSystem.CreateJob("Third", JPH::Color::sWhite, [&]()
+                                               {
+                                                 outOfOrder += stage.load() != 2 ? 1 : 0;
+                                                 stage = 3; },
+                                               1);
+    JPH::JobHandle second = jobSystem.CreateJob("Second", JPH::Color::sWhite, [&]()
+                                                {
+                                                  outOfOrder += stage.load() != 1 ? 1 : 0;
+                                                  stage = 2;
+                                                  third.RemoveDependency(); },
+                                                1);
+    JPH::JobHandle first = jobSystem.CreateJob("First", JPH::Color::sWhite, [&]()
+                                               {
+                                                 stage = 1;
+                                                 second.RemoveDependency(); });
+
+    JPH::JobSystem::Barrier* barrier = jobSystem.CreateBarrier();
+    JPH::JobHandle handles[] = {first, second, third};
+    barrier->AddJobs(handles, 3);
+    jobSystem.WaitForJobs(barrier);
+    jobSystem.DestroyBarrier(barrier);
+
+    RN_CHECK(stage.load() == 3);
+    RN_CHECK(outOfOrder.load() == 0);
+  }
+  JobSystem::Shutdown();
+}
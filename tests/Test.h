@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+namespace Rain::Test
+{
+  struct TestCase
+  {
+    const char* Name;
+    void (*Function)();
+  };
+
+  inline std::vector<TestCase>& GetTests()
+  {
+    static std::vector<TestCase> tests;
+    return tests;
+  }
+
+  // Failed checks of the test that is running, reset by the runner before each test
+  inline int& GetFailures()
+  {
+    static int failures = 0;
+    return failures;
+  }
+
+  struct Registrar
+  {
+    Registrar(const char* name, void (*function)()) { GetTests().push_back({name, function}); }
+  };
+}  // namespace Rain::Test
+
+#define RN_TEST(name)                                                         \
+  static void name();                                                         \
+  static ::Rain::Test::Registrar s_##name##Registrar(#name, name);            \
+  static void name()
+
+// Records the failure and keeps going, so one run reports every broken check of a test
+#define RN_CHECK(condition)                                                   \
+  do                                                                          \
+  {                                                                           \
+    if (!(condition))                                                         \
+    {                                                                         \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      ::Rain::Test::GetFailures()++;                                          \
+    }                                                                         \
+  } while (0)
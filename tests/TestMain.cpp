@@ -0,0 +1,31 @@
+#include <cstring>
+#include "Test.h"
+#include "core/Log.h"
+
+// Runs every registered test, or only those whose name contains argv[1]
+int main(int argc, char** argv)
+{
+  Rain::Log::Init();
+
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  int failedTests = 0;
+  int ranTests = 0;
+  for (const auto& test : Rain::Test::GetTests())
+  {
+    if (filter && !std::strstr(test.Name, filter))
+    {
+      continue;
+    }
+
+    Rain::Test::GetFailures() = 0;
+    test.Function();
+    ranTests++;
+
+    const bool passed = Rain::Test::GetFailures() == 0;
+    failedTests += passed ? 0 : 1;
+    std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.Name);
+  }
+
+  std::printf("%d of %d tests passed\n", ranTests - failedTests, ranTests);
+  return failedTests == 0 && ranTests > 0 ? 0 : 1;
+}